@@ -144,6 +144,13 @@ struct tt_bh_pll_settings {
 	union tt_bh_pll_use_postdiv_reg use_postdiv;
 };
 
+/* Step size and settling delay of AICLK fbdiv steps, from fbdiv upwards */
+struct tt_bh_aiclk_step {
+	uint32_t fbdiv;
+	uint32_t step;
+	uint32_t delay_ns;
+};
+
 struct clock_control_tt_bh_config {
 	uint8_t inst;
 
@@ -153,12 +160,21 @@ struct clock_control_tt_bh_config {
 	size_t size;
 
 	struct tt_bh_pll_settings init_settings;
+
+	/* <fbdiv step delay_ns> triples sorted by fbdiv, the first one starting at fbdiv 0 */
+	const uint32_t *aiclk_steps;
+	size_t num_aiclk_steps;
 };
 
 struct clock_control_tt_bh_data {
 	struct tt_bh_pll_settings settings;
 
 	struct k_spinlock lock;
+
+	/* fbdiv AICLK is being stepped to */
+	uint32_t aiclk_target_fbdiv;
+	/* Steps AICLK increases when CONFIG_CLOCK_CONTROL_TT_BH_AICLK_ASYNC is enabled */
+	struct k_timer aiclk_timer;
 };
 
 static uint32_t clock_control_tt_bh_read_reg(const struct clock_control_tt_bh_config *config,
@@ -313,6 +329,77 @@ static uint32_t clock_control_tt_bh_get_freq(const struct clock_control_tt_bh_co
 	return (config->refclk_rate * pll_cntl_1.f.fbdiv) / (pll_cntl_1.f.refdiv * eff_postdiv);
 }
 
+static struct tt_bh_aiclk_step
+clock_control_tt_bh_aiclk_step_for(const struct clock_control_tt_bh_config *config, uint32_t fbdiv)
+{
+	const uint32_t *row = &config->aiclk_steps[0];
+
+	for (size_t i = 1; i < config->num_aiclk_steps && config->aiclk_steps[3 * i] <= fbdiv;
+	     i++) {
+		row = &config->aiclk_steps[3 * i];
+	}
+
+	/* A step of 0 would never reach the target */
+	return (struct tt_bh_aiclk_step){
+		.fbdiv = row[0], .step = MAX(row[1], 1), .delay_ns = row[2]};
+}
+
+/*
+ * Step AICLK fbdiv towards data->aiclk_target_fbdiv, waiting the settling delay of each step,
+ * until the target is reached or the next delay would exceed budget_ns. Returns the delay still
+ * owed before the next step, or 0 once the target is reached.
+ */
+static uint32_t clock_control_tt_bh_aiclk_ramp(const struct clock_control_tt_bh_config *config,
+					       struct clock_control_tt_bh_data *data,
+					       uint32_t budget_ns)
+{
+	union tt_bh_pll_cntl_1_reg pll_cntl_1;
+	uint32_t spent_ns = 0;
+
+	pll_cntl_1.val = clock_control_tt_bh_read_reg(config, PLL_CNTL_1_OFFSET);
+
+	while (pll_cntl_1.f.fbdiv != data->aiclk_target_fbdiv) {
+		struct tt_bh_aiclk_step step =
+			clock_control_tt_bh_aiclk_step_for(config, pll_cntl_1.f.fbdiv);
+
+		if (data->aiclk_target_fbdiv > pll_cntl_1.f.fbdiv) {
+			pll_cntl_1.f.fbdiv +=
+				MIN(step.step, data->aiclk_target_fbdiv - pll_cntl_1.f.fbdiv);
+		} else {
+			pll_cntl_1.f.fbdiv -=
+				MIN(step.step, pll_cntl_1.f.fbdiv - data->aiclk_target_fbdiv);
+		}
+
+		clock_control_tt_bh_write_reg(config, PLL_CNTL_1_OFFSET, pll_cntl_1.val);
+
+		if (budget_ns - spent_ns < step.delay_ns) {
+			return step.delay_ns;
+		}
+
+		k_busy_wait_ns(step.delay_ns);
+		spent_ns += step.delay_ns;
+	}
+
+	return 0;
+}
+
+static void clock_control_tt_bh_aiclk_timer_handler(struct k_timer *timer)
+{
+	const struct device *dev = k_timer_user_data_get(timer);
+	const struct clock_control_tt_bh_config *config =
+		(const struct clock_control_tt_bh_config *)dev->config;
+	struct clock_control_tt_bh_data *data = (struct clock_control_tt_bh_data *)dev->data;
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+	uint32_t delay_ns = clock_control_tt_bh_aiclk_ramp(
+		config, data, CONFIG_CLOCK_CONTROL_TT_BH_AICLK_ASYNC_SLICE_NS);
+
+	if (delay_ns != 0) {
+		k_timer_start(timer, K_NSEC(delay_ns), K_NO_WAIT);
+	}
+
+	k_spin_unlock(&data->lock, key);
+}
+
 static void clock_control_tt_bh_update(const struct clock_control_tt_bh_config *config,
 				       struct clock_control_tt_bh_data *data,
 				       const struct tt_bh_pll_settings *settings)
@@ -495,7 +582,6 @@ static int clock_control_tt_bh_set_rate(const struct device *dev, clock_control_
 
 		clock_control_tt_bh_update(config, data, &settings);
 	} else if (clock == CLOCK_CONTROL_TT_BH_CLOCK_AICLK) {
-		uint32_t target_fbdiv;
 		union tt_bh_pll_cntl_1_reg pll_cntl_1;
 		union tt_bh_pll_cntl_5_reg pll_cntl_5;
 		union tt_bh_pll_use_postdiv_reg use_postdiv;
@@ -503,23 +589,32 @@ static int clock_control_tt_bh_set_rate(const struct device *dev, clock_control_
 		pll_cntl_1.val = clock_control_tt_bh_read_reg(config, PLL_CNTL_1_OFFSET);
 		pll_cntl_5.val = clock_control_tt_bh_read_reg(config, PLL_CNTL_5_OFFSET);
 		use_postdiv.val = clock_control_tt_bh_read_reg(config, PLL_USE_POSTDIV_OFFSET);
-		target_fbdiv =
+		data->aiclk_target_fbdiv =
 			clock_control_tt_bh_calculate_fbdiv(config->refclk_rate, (uint32_t)rate,
 							    pll_cntl_1, pll_cntl_5, use_postdiv, 0);
 
-		while (pll_cntl_1.f.fbdiv != target_fbdiv) {
-			if (target_fbdiv > pll_cntl_1.f.fbdiv) {
-				pll_cntl_1.f.fbdiv += 1;
-			} else {
-				pll_cntl_1.f.fbdiv -= 1;
-			}
+		if (IS_ENABLED(CONFIG_CLOCK_CONTROL_TT_BH_AICLK_ASYNC) &&
+		    data->aiclk_target_fbdiv > pll_cntl_1.f.fbdiv) {
+			/* The caller has already raised the voltage for the new rate, so the
+			 * rest of the increase can complete after returning
+			 */
+			uint32_t delay_ns = clock_control_tt_bh_aiclk_ramp(
+				config, data, CONFIG_CLOCK_CONTROL_TT_BH_AICLK_ASYNC_SLICE_NS);
 
-			clock_control_tt_bh_write_reg(config, PLL_CNTL_1_OFFSET, pll_cntl_1.val);
-			k_busy_wait_ns(100);
+			if (delay_ns != 0) {
+				k_timer_start(&data->aiclk_timer, K_NSEC(delay_ns), K_NO_WAIT);
+			}
+		} else {
+			/* Decreases complete before returning, so that the caller can lower the
+			 * voltage afterwards
+			 */
+			k_timer_stop(&data->aiclk_timer);
+			clock_control_tt_bh_aiclk_ramp(config, data, UINT32_MAX);
 		}
 	} else if (clock == CLOCK_CONTROL_TT_BH_INIT_STATE) {
 		struct tt_bh_pll_settings settings = config->init_settings;
 
+		k_timer_stop(&data->aiclk_timer);
 		clock_control_tt_bh_update(config, data, &settings);
 		clock_control_enable_clk_counters(config);
 	} else {
@@ -580,6 +675,8 @@ static int clock_control_tt_bh_init(const struct device *dev)
 	}
 
 	data->settings = config->init_settings;
+	k_timer_init(&data->aiclk_timer, clock_control_tt_bh_aiclk_timer_handler, NULL);
+	k_timer_user_data_set(&data->aiclk_timer, (void *)dev);
 	union tt_bh_pll_cntl_0_reg pll_cntl_0;
 
 	/* Before turning off PLL, bypass PLL so glitch free mux has no chance to switch */
@@ -636,9 +733,22 @@ static const struct clock_control_driver_api clock_control_tt_bh_api = {
 	.set_rate = clock_control_tt_bh_set_rate,
 	.configure = clock_control_tt_bh_configure};
 
+/* Without characterisation data, step fbdiv by 1 with 100 ns to settle */
+#define CLOCK_CONTROL_TT_BH_DEFAULT_AICLK_STEPS {0, 1, 100}
+
 #define CLOCK_CONTROL_TT_BH_INIT(_inst)                                                            \
 	static struct clock_control_tt_bh_data clock_control_tt_bh_data_##_inst;                   \
                                                                                                    \
+	BUILD_ASSERT(DT_INST_PROP_LEN_OR(_inst, aiclk_steps, 0) % 3 == 0,                          \
+		     "aiclk_steps must be <fbdiv step delay-ns> triples");                         \
+	BUILD_ASSERT(COND_CODE_1(DT_INST_NODE_HAS_PROP(_inst, aiclk_steps),                        \
+				 (DT_INST_PROP_BY_IDX(_inst, aiclk_steps, 0)), (0)) == 0,          \
+		     "aiclk_steps must start at fbdiv 0");                                         \
+	static const uint32_t clock_control_tt_bh_aiclk_steps_##_inst[] =                          \
+		COND_CODE_1(DT_INST_NODE_HAS_PROP(_inst, aiclk_steps),                             \
+			    (DT_INST_PROP(_inst, aiclk_steps)),                                    \
+			    (CLOCK_CONTROL_TT_BH_DEFAULT_AICLK_STEPS));                            \
+                                                                                                   \
 	static const struct clock_control_tt_bh_config clock_control_tt_bh_config_##_inst = {      \
 		.inst = _inst,                                                                     \
 		.refclk_rate = DT_PROP(DT_INST_CLOCKS_CTLR(_inst), clock_frequency),               \
@@ -661,7 +771,10 @@ static const struct clock_control_driver_api clock_control_tt_bh_api = {
 					.f.pll_use_postdiv2 =                                      \
 						DT_INST_PROP_BY_IDX(_inst, use_post_divs, 2),      \
 					.f.pll_use_postdiv3 =                                      \
-						DT_INST_PROP_BY_IDX(_inst, use_post_divs, 3)}}};   \
+						DT_INST_PROP_BY_IDX(_inst, use_post_divs, 3)}},    \
+		.aiclk_steps = clock_control_tt_bh_aiclk_steps_##_inst,                            \
+		.num_aiclk_steps = ARRAY_SIZE(clock_control_tt_bh_aiclk_steps_##_inst) / 3,        \
+	};                                                                                         \
                                                                                                    \
 	DEVICE_DT_INST_DEFINE(                                                                     \
 		_inst, clock_control_tt_bh_init, NULL, &clock_control_tt_bh_data_##_inst,          \
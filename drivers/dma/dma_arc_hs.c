@@ -60,6 +60,8 @@
 /* Use the actual configured channels for this instance */
 #define ARC_DMA_CONFIGURED_CHANNELS DT_INST_PROP(0, dma_channels)
 #define ARC_DMA_ATOMIC_WORDS        ATOMIC_BITMAP_SIZE(ARC_DMA_MAX_CHANNELS)
+/* Descriptors are split evenly between the channels */
+#define ARC_DMA_CHANNEL_DESCRIPTORS(cfg) ((cfg)->descriptors / (cfg)->channels)
 
 LOG_MODULE_REGISTER(dma_arc, CONFIG_DMA_LOG_LEVEL);
 
@@ -187,9 +189,9 @@ static int dma_arc_hs_config(const struct device *dev, uint32_t channel, struct
 		return -EINVAL;
 	}
 
-	if (config->block_count > dev_config->descriptors) {
+	if (config->block_count > ARC_DMA_CHANNEL_DESCRIPTORS(dev_config)) {
 		LOG_ERR("block_count %u exceeds max descriptors %u", config->block_count,
-			dev_config->descriptors);
+			ARC_DMA_CHANNEL_DESCRIPTORS(dev_config));
 		return -EINVAL;
 	}
 
@@ -783,7 +785,8 @@ static int dma_arc_hs_get_attribute(const struct device *dev, uint32_t type, uin
 		*value = 4; /* 32-bit aligned */
 		break;
 	case DMA_ATTR_MAX_BLOCK_COUNT:
-		*value = dev_config->descriptors; /* Limited by descriptor count */
+		/* Limited by the descriptors of a channel */
+		*value = ARC_DMA_CHANNEL_DESCRIPTORS(dev_config);
 		break;
 	default:
 		return -ENOTSUP;
@@ -970,8 +973,11 @@ static int dma_arc_hs_init(const struct device *dev)
 
 	dma_arc_hs_config_hw();
 
+	/* Channels run concurrently, so each gets its own range of descriptors */
 	for (i = 0; i < config->channels; i++) {
-		dma_arc_hs_init_channel_hw(i, 0, config->descriptors - 1);
+		uint32_t base = i * ARC_DMA_CHANNEL_DESCRIPTORS(config);
+
+		dma_arc_hs_init_channel_hw(i, base, base + ARC_DMA_CHANNEL_DESCRIPTORS(config) - 1);
 	}
 
 	/* Initialize completion work queue */
@@ -21,12 +21,17 @@
 
 LOG_MODULE_REGISTER(dma_noc_tt_bh, CONFIG_DMA_LOG_LEVEL);
 
-#define NOC_DMA_TLB        0
+/* Each channel has its own TLB, so that transfers from different tiles can be outstanding at once.
+ * TLBs 0-5 and 13-14 are used by the tile setup code.
+ */
+#define NOC_DMA_TLB_BASE   8
+#define NOC_DMA_NUM_TLBS   4
+#define NOC_DMA_TLB(ch)    (NOC_DMA_TLB_BASE + (ch))
 #define NOC_DMA_NOC_ID     0
 #define NOC_DMA_TIMEOUT_MS 50
 #define NOC_MAX_BURST_SIZE 16384
 
-#define DMA_MAX_TRANSFER_BLOCKS 4
+#define DMA_MAX_TRANSFER_BLOCKS CONFIG_DMA_TT_BH_NOC_MAX_BLOCKS
 
 /* NOC CMD fields */
 #define NOC_CMD_CPY               (0 << 0)
@@ -57,12 +62,25 @@ LOG_MODULE_REGISTER(dma_noc_tt_bh, CONFIG_DMA_LOG_LEVEL);
 /* Define invalid channel constant - using a high value that's unlikely to be used */
 #define DMA_CHANNEL_INVALID 0xFFFFFFFF
 
+/* Results of advancing a channel */
+#define NOC_DMA_POLL_BUSY     0
+#define NOC_DMA_POLL_BLOCK    1
+#define NOC_DMA_POLL_COMPLETE 2
+
 struct tt_bh_dma_channel_resettable_data {
 	/* Hardware completion tracking for get_status() */
 	uint32_t last_noc_cmd;
 	uint32_t last_expected_acks;
+	/* Deadline for the next command to complete or be issued */
+	k_timepoint_t timeout;
 	uint16_t block_index;
 	uint16_t block_count;
+	/* Commands issued and completed, see steps_per_block() */
+	uint16_t issued_steps;
+	uint16_t done_steps;
+	/* Tile whose NIU issued the outstanding command, and counts its acks */
+	uint8_t niu_x;
+	uint8_t niu_y;
 	bool configured: 1;
 	bool active: 1;
 	bool suspended: 1;
@@ -71,9 +89,13 @@ struct tt_bh_dma_channel_resettable_data {
 
 struct tt_bh_dma_channel_data {
 	struct dma_block_config blocks[DMA_MAX_TRANSFER_BLOCKS];
+	/* Expected acks of each outstanding command, indexed by step % DMA_MAX_TRANSFER_BLOCKS */
+	uint32_t step_acks[DMA_MAX_TRANSFER_BLOCKS];
 	struct tt_bh_dma_noc_coords coords;
 	struct dma_config config;
 	struct tt_bh_dma_channel_resettable_data state;
+	/* Given when a transfer completes, fails or is stopped, see tt_bh_dma_noc_wait_channel() */
+	struct k_sem done;
 };
 
 /*
@@ -92,6 +114,13 @@ struct tt_bh_dma_noc_config {
  */
 struct tt_bh_dma_noc_data {
 	struct k_spinlock lock;
+	const struct device *dev;
+	/* Polls the NIU counters of active channels until they complete. Callbacks run from its
+	 * expiry function, in interrupt context like those of interrupt driven DMA controllers.
+	 */
+	struct k_timer poll_timer;
+	/* Whether poll_timer is running, protected by lock */
+	bool polling;
 };
 
 struct ret_addr_hi {
@@ -106,31 +135,20 @@ union ret_addr_hi_u {
 	uint32_t u;
 };
 
-static bool noc_wait_cmd_ready(void)
+/* True when the NIU has room for another command */
+static bool noc_cmd_ready(uint8_t tlb)
 {
 #ifdef CONFIG_BOARD_NATIVE_SIM
 	/* Fake completion */
 	return true;
 #else
-	uint32_t cmd_ctrl;
-	k_timepoint_t timeout = sys_timepoint_calc(K_MSEC(NOC_DMA_TIMEOUT_MS));
-
-	do {
-		cmd_ctrl = NOC2AXIRead32(NOC_DMA_NOC_ID, NOC_DMA_TLB, CMD_CTRL);
-	} while (cmd_ctrl != 0 && !sys_timepoint_expired(timeout));
-
-	return cmd_ctrl == 0;
+	return NOC2AXIRead32(NOC_DMA_NOC_ID, tlb, CMD_CTRL) == 0;
 #endif
 }
 
-static uint32_t get_expected_acks(uint32_t noc_cmd, uint64_t size)
+static uint32_t get_ack_reg_addr(uint32_t noc_cmd)
 {
-	uint32_t ack_reg_addr =
-		(noc_cmd & NOC_CMD_WR) ? NIU_MST_WR_ACK_RECEIVED : NIU_MST_RD_RESP_RECEIVED;
-	uint32_t packet_received = NOC2AXIRead32(NOC_DMA_NOC_ID, NOC_DMA_TLB, ack_reg_addr);
-	uint32_t expected_acks = packet_received + DIV_ROUND_UP(size, NOC_MAX_BURST_SIZE);
-
-	return expected_acks;
+	return (noc_cmd & NOC_CMD_WR) ? NIU_MST_WR_ACK_RECEIVED : NIU_MST_RD_RESP_RECEIVED;
 }
 
 /* wrap around aware comparison for half-range rule */
@@ -152,21 +170,49 @@ static inline bool is_behind(uint32_t current, uint32_t target)
 	return (int32_t)(current - target) < 0;
 }
 
-static bool check_noc_dma_done_immediate(uint32_t noc_cmd, uint32_t expected_acks)
+static bool check_noc_dma_done_immediate(uint8_t tlb, uint32_t noc_cmd, uint32_t expected_acks)
 {
 #ifdef CONFIG_BOARD_NATIVE_SIM
 	/* Fake NOC completion */
 	return true;
 #else
-	uint32_t ack_reg_addr =
-		(noc_cmd & NOC_CMD_WR) ? NIU_MST_WR_ACK_RECEIVED : NIU_MST_RD_RESP_RECEIVED;
-	uint32_t ack_received = NOC2AXIRead32(NOC_DMA_NOC_ID, NOC_DMA_TLB, ack_reg_addr);
+	uint32_t ack_received = NOC2AXIRead32(NOC_DMA_NOC_ID, tlb, get_ack_reg_addr(noc_cmd));
 
 	/* Immediate check - no waiting */
 	return !is_behind(ack_received, expected_acks);
 #endif
 }
 
+/*
+ * Acks are counted per NIU, and don't say which command they belong to. When another command of
+ * the same kind is outstanding from the same NIU, count on from its expected acks, so that this
+ * command is only considered done once both are.
+ */
+static uint32_t get_ack_base(const struct device *dev, uint32_t channel, uint32_t noc_cmd,
+			     uint32_t acks_received)
+{
+	const struct tt_bh_dma_noc_config *cfg = (const struct tt_bh_dma_noc_config *)dev->config;
+	const struct tt_bh_dma_channel_resettable_data *state = &cfg->channels[channel].state;
+	uint32_t base = acks_received;
+
+	for (uint32_t i = 0; i < cfg->num_channels; i++) {
+		const struct tt_bh_dma_channel_resettable_data *other = &cfg->channels[i].state;
+
+		/* The channel's own outstanding commands count too, as blocks are pipelined */
+		if (!other->active || !other->hw_completion_tracking) {
+			continue;
+		}
+
+		if (other->niu_x == state->niu_x && other->niu_y == state->niu_y &&
+		    get_ack_reg_addr(other->last_noc_cmd) == get_ack_reg_addr(noc_cmd) &&
+		    is_behind(base, other->last_expected_acks)) {
+			base = other->last_expected_acks;
+		}
+	}
+
+	return base;
+}
+
 static uint32_t noc_dma_format_coord(uint8_t x, uint8_t y)
 {
 	/* clang-format off */
@@ -203,11 +249,19 @@ static void handle_transfer_callbacks(const struct device *dev,
 	}
 }
 
-static int noc_dma_transfer(uint32_t cmd, uint32_t ret_coord, uint64_t ret_addr,
-			    uint32_t targ_coord, uint64_t targ_addr, uint32_t size, bool multicast,
-			    uint8_t transaction_id, bool include_self, uint32_t *noc_cmd_out,
-			    uint32_t *expected_acks_out)
+/*
+ * Issue one NOC command from the NIU the channel's TLB points at, which must have room for it.
+ * Called with the lock held.
+ */
+static int noc_dma_transfer(const struct device *dev, uint32_t channel, uint32_t cmd,
+			    uint32_t ret_coord, uint64_t ret_addr, uint32_t targ_coord,
+			    uint64_t targ_addr, uint32_t size, bool multicast,
+			    uint8_t transaction_id, bool include_self)
 {
+	const struct tt_bh_dma_noc_config *cfg = (const struct tt_bh_dma_noc_config *)dev->config;
+	struct tt_bh_dma_channel_resettable_data *state = &cfg->channels[channel].state;
+	uint8_t tlb = NOC_DMA_TLB(channel);
+
 	uint32_t ret_addr_lo = low32(ret_addr);
 	uint32_t ret_addr_mid = high32(ret_addr);
 	uint32_t ret_addr_hi = ret_coord;
@@ -231,33 +285,28 @@ static int noc_dma_transfer(uint32_t cmd, uint32_t ret_coord, uint64_t ret_addr,
 
 	/* Always enable response marking for completion tracking */
 	noc_ctrl |= NOC_CMD_RESP_MARKED;
-	uint32_t expected_acks = get_expected_acks(noc_ctrl, size);
 
-	/* Return tracking info to caller */
-	if (noc_cmd_out) {
-		*noc_cmd_out = noc_ctrl;
-	}
-	if (expected_acks_out) {
-		*expected_acks_out = expected_acks;
-	}
+	uint32_t acks_received = NOC2AXIRead32(NOC_DMA_NOC_ID, tlb, get_ack_reg_addr(noc_ctrl));
 
-	if (!noc_wait_cmd_ready()) {
-		return 1;
-	}
+	state->last_noc_cmd = noc_ctrl;
+	state->last_expected_acks = get_ack_base(dev, channel, noc_ctrl, acks_received) +
+				    DIV_ROUND_UP(size, NOC_MAX_BURST_SIZE);
+
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, TARGET_ADDR_LO, targ_addr_lo);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, TARGET_ADDR_MID, targ_addr_mid);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, TARGET_ADDR_HI, targ_addr_hi);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, RET_ADDR_LO, ret_addr_lo);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, RET_ADDR_MID, ret_addr_mid);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, RET_ADDR_HI, ret_addr_hi);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, PACKET_TAG, noc_packet_tag);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, AT_LEN, noc_at_len_be);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, AT_LEN_1, 0);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, AT_DATA, 0);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, BRCST_EXCLUDE, 0);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, CMD_BRCST, noc_ctrl);
+	NOC2AXIWrite32(NOC_DMA_NOC_ID, tlb, CMD_CTRL, 1);
 
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, TARGET_ADDR_LO, targ_addr_lo);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, TARGET_ADDR_MID, targ_addr_mid);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, TARGET_ADDR_HI, targ_addr_hi);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, RET_ADDR_LO, ret_addr_lo);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, RET_ADDR_MID, ret_addr_mid);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, RET_ADDR_HI, ret_addr_hi);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, PACKET_TAG, noc_packet_tag);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, AT_LEN, noc_at_len_be);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, AT_LEN_1, 0);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, AT_DATA, 0);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, BRCST_EXCLUDE, 0);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, CMD_BRCST, noc_ctrl);
-	NOC2AXIWrite32(NOC_DMA_NOC_ID, NOC_DMA_TLB, CMD_CTRL, 1);
+	state->hw_completion_tracking = true;
 
 	return 0;
 }
@@ -273,6 +322,8 @@ static struct tt_bh_dma_channel_data *get_channel_data(const struct device *dev,
 	return &cfg->channels[channel];
 }
 
+static bool noc_dma_poll_channel(const struct device *dev, uint32_t channel);
+
 /*
  * Config the source and dest NOC coordinates, the source and dest addresses and
  * the size of data transfer.
@@ -292,13 +343,19 @@ static int tt_bh_dma_noc_config(const struct device *dev, uint32_t channel,
 		LOG_ERR("Too many blocks: %u > %u", config->block_count, DMA_MAX_TRANSFER_BLOCKS);
 		return -EINVAL;
 	}
-	if (channel > dma_cfg->num_channels) {
+	if (channel >= dma_cfg->num_channels) {
 		LOG_ERR("Invalid channel %u", channel);
 		return -EINVAL;
 	}
 
 	struct tt_bh_dma_channel_data *chan_data = &dma_cfg->channels[channel];
 
+	/* Retire the previous transfer if it is done, so that its completion isn't lost */
+	if (noc_dma_poll_channel(dev, channel)) {
+		LOG_DBG("Channel %u busy", channel);
+		return -EBUSY;
+	}
+
 	k_spinlock_key_t key = k_spin_lock(&dma_data->lock);
 
 	/* Deep copy all blocks from the linked list */
@@ -345,261 +402,373 @@ static uint32_t noc_dma_format_multicast(uint8_t start_x, uint8_t start_y, uint8
 		.u;
 }
 
-static int noc_dma_write_multicast(uint8_t local_x, uint8_t local_y, uint64_t local_addr,
-				   uint8_t remote_start_x, uint8_t remote_start_y,
-				   uint8_t remote_end_x, uint8_t remote_end_y, uint64_t remote_addr,
-				   uint32_t size, bool include_self, uint32_t *noc_cmd_out,
-				   uint32_t *expected_acks_out)
+/*
+ * A MEMORY_TO_MEMORY block is read into the source tile and then written from there, which takes
+ * two commands. Other directions take one command per block.
+ */
+static uint32_t steps_per_block(const struct tt_bh_dma_channel_data *chan_data)
 {
-	uint32_t ret_coord = noc_dma_format_multicast(remote_start_x, remote_start_y, remote_end_x,
-						      remote_end_y);
-	uint64_t ret_addr = remote_addr;
-
-	uint32_t targ_coord = noc_dma_format_coord(local_x, local_y);
-	uint64_t targ_addr = local_addr;
-
-	NOC2AXITlbSetup(NOC_DMA_NOC_ID, NOC_DMA_TLB, local_x, local_y, TARGET_ADDR_LO);
-
-	return noc_dma_transfer(NOC_CMD_WR, ret_coord, ret_addr, targ_coord, targ_addr, size, true,
-				0, include_self, noc_cmd_out, expected_acks_out);
+	return chan_data->config.channel_direction == MEMORY_TO_MEMORY ? 2 : 1;
 }
 
-static int tt_bh_dma_noc_start(const struct device *dev, uint32_t channel)
+/* Issue the NOC command for one step of a channel. Called with the lock held. */
+static int noc_dma_issue(const struct device *dev, uint32_t channel, uint32_t step)
 {
 	struct tt_bh_dma_channel_data *chan_data = get_channel_data(dev, channel);
+	struct tt_bh_dma_noc_coords *coords = &chan_data->coords;
+	struct dma_block_config *current_block =
+		&chan_data->blocks[step / steps_per_block(chan_data)];
+	bool multicast = false;
+	uint32_t cmd;
+	uint32_t ret_coord;
+	uint64_t ret_addr;
+	uint32_t targ_coord;
+	uint64_t targ_addr;
 
-	if (!chan_data) {
-		LOG_ERR("Invalid channel %u", channel);
+	switch (chan_data->config.channel_direction) {
+	case MEMORY_TO_MEMORY:
+		if (step % 2 == 0) {
+			cmd = NOC_CMD_RD;
+			ret_coord = noc_dma_format_coord(coords->source_x, coords->source_y);
+			ret_addr = 0;
+			targ_coord = noc_dma_format_coord(coords->dest_x, coords->dest_y);
+			targ_addr = current_block->source_address;
+		} else {
+			cmd = NOC_CMD_WR;
+			ret_coord = noc_dma_format_coord(coords->dest_x, coords->dest_y);
+			ret_addr = current_block->dest_address;
+			targ_coord = noc_dma_format_coord(coords->source_x, coords->source_y);
+			targ_addr = 0;
+		}
+		break;
+	case MEMORY_TO_PERIPHERAL:
+		cmd = NOC_CMD_RD;
+		ret_coord = noc_dma_format_coord(coords->source_x, coords->source_y);
+		ret_addr = current_block->source_address;
+		targ_coord = noc_dma_format_coord(coords->dest_x, coords->dest_y);
+		targ_addr = current_block->dest_address;
+		break;
+	case PERIPHERAL_TO_MEMORY:
+		cmd = NOC_CMD_WR;
+		ret_coord = noc_dma_format_coord(coords->dest_x, coords->dest_y);
+		ret_addr = current_block->dest_address;
+		targ_coord = noc_dma_format_coord(coords->source_x, coords->source_y);
+		targ_addr = current_block->source_address;
+		break;
+	case TT_BH_DMA_NOC_CHANNEL_DIRECTION_BROADCAST:
+		/* Use pre translation coords as NOC translation has enabled. */
+		cmd = NOC_CMD_WR;
+		ret_coord = noc_dma_format_multicast(2, 2, 1, 11);
+		ret_addr = current_block->dest_address;
+		targ_coord = noc_dma_format_coord(coords->dest_x, coords->dest_y);
+		targ_addr = current_block->source_address;
+		multicast = true;
+		break;
+	default:
+		LOG_ERR("%s: Invalid channel direction %d", __func__,
+			chan_data->config.channel_direction);
 		return -EINVAL;
 	}
 
-	if (!chan_data->state.configured) {
-		LOG_ERR("Channel %u not configured", channel);
-		return -EINVAL;
-	}
+	int ret = noc_dma_transfer(dev, channel, cmd, ret_coord, ret_addr, targ_coord, targ_addr,
+				   current_block->block_size, multicast, 0, false);
 
-	if (chan_data->state.active) {
-		LOG_ERR("Channel %u already active", channel);
-		return -EBUSY;
+	if (ret == 0) {
+		chan_data->step_acks[step % DMA_MAX_TRANSFER_BLOCKS] =
+			chan_data->state.last_expected_acks;
 	}
 
-	chan_data->state.active = true;
-	chan_data->state.suspended = false;
-	chan_data->state.block_index = 0;
+	return ret;
+}
 
-	struct tt_bh_dma_noc_coords *coords = &chan_data->coords;
-	struct dma_block_config *current_block = &chan_data->blocks[chan_data->state.block_index];
+/*
+ * Issue commands back to back while the NIU has room for them. MEMORY_TO_MEMORY steps reuse the
+ * source tile's L1 as a bounce buffer, so they are issued one at a time. Called with the lock held.
+ */
+static int noc_dma_issue_pending(const struct device *dev, uint32_t channel)
+{
+	struct tt_bh_dma_channel_data *chan_data = get_channel_data(dev, channel);
+	struct tt_bh_dma_channel_resettable_data *state = &chan_data->state;
+	uint32_t num_steps = state->block_count * steps_per_block(chan_data);
+	uint32_t window = steps_per_block(chan_data) == 1 ? DMA_MAX_TRANSFER_BLOCKS : 1;
 
-	if (!current_block) {
-		LOG_ERR("No valid block configuration");
-		chan_data->state.active = false;
-		return -EINVAL;
+	while (state->issued_steps < num_steps &&
+	       state->issued_steps - state->done_steps < window &&
+	       noc_cmd_ready(NOC_DMA_TLB(channel))) {
+		int ret = noc_dma_issue(dev, channel, state->issued_steps);
+
+		if (ret != 0) {
+			return ret;
+		}
+		state->issued_steps++;
+		state->timeout = sys_timepoint_calc(K_MSEC(NOC_DMA_TIMEOUT_MS));
 	}
 
-	/* Handle different transfer types - all asynchronous */
-	switch (chan_data->config.channel_direction) {
-	case MEMORY_TO_MEMORY: {
-		chan_data->state.hw_completion_tracking = false;
-		for (; chan_data->state.block_index < chan_data->state.block_count;
-		     chan_data->state.block_index++) {
-			current_block = &chan_data->blocks[chan_data->state.block_index];
-			if (!current_block) {
-				LOG_ERR("No valid block configuration");
-				chan_data->state.active = false;
-				handle_transfer_callbacks(dev, chan_data, channel, -EINVAL, true);
-				return -EINVAL;
-			}
-
-			uint32_t ret_coord =
-				noc_dma_format_coord(coords->source_x, coords->source_y);
-			uint64_t ret_addr = 0;
-
-			uint32_t targ_coord = noc_dma_format_coord(coords->dest_x, coords->dest_y);
-			uint64_t targ_addr = current_block->source_address;
-
-			NOC2AXITlbSetup(NOC_DMA_NOC_ID, NOC_DMA_TLB, coords->source_x,
-					coords->source_y, TARGET_ADDR_LO);
-
-			int ret = noc_dma_transfer(NOC_CMD_RD, ret_coord, ret_addr, targ_coord,
-						   targ_addr, current_block->block_size, false, 0,
-						   false, &chan_data->state.last_noc_cmd,
-						   &chan_data->state.last_expected_acks);
-
-			if (ret != 0) {
-				handle_transfer_callbacks(dev, chan_data, channel, ret, true);
-				chan_data->state.active = false;
-				return ret;
-			}
-
-			/* Wait for read operation to complete */
-			k_timepoint_t timeout = sys_timepoint_calc(K_MSEC(NOC_DMA_TIMEOUT_MS));
-
-			while (!check_noc_dma_done_immediate(chan_data->state.last_noc_cmd,
-							     chan_data->state.last_expected_acks) &&
-			       !sys_timepoint_expired(timeout)) {
-				k_busy_wait(1);
-			}
-
-			if (sys_timepoint_expired(timeout)) {
-				LOG_ERR("NOC read operation timeout");
-				handle_transfer_callbacks(dev, chan_data, channel, -ETIMEDOUT,
-							  true);
-				chan_data->state.active = false;
-				return -ETIMEDOUT;
-			}
+	return 0;
+}
 
-			ret_coord = noc_dma_format_coord(coords->dest_x, coords->dest_y);
-			ret_addr = current_block->dest_address;
+/*
+ * Retire completed commands of a channel and issue more. Called with the lock held.
+ * Returns NOC_DMA_POLL_* or a negative error, after which the channel is inactive. The number of
+ * blocks that completed is returned in blocks_done.
+ */
+static int noc_dma_advance(const struct device *dev, uint32_t channel, uint32_t *blocks_done)
+{
+	struct tt_bh_dma_channel_data *chan_data = get_channel_data(dev, channel);
+	struct tt_bh_dma_channel_resettable_data *state = &chan_data->state;
+	uint32_t spb = steps_per_block(chan_data);
+	int ret;
 
-			targ_coord = noc_dma_format_coord(coords->source_x, coords->source_y);
-			targ_addr = 0;
+	*blocks_done = 0;
+
+	if (!state->active) {
+		return NOC_DMA_POLL_BUSY;
+	}
 
-			NOC2AXITlbSetup(NOC_DMA_NOC_ID, NOC_DMA_TLB, coords->source_x,
-					coords->source_y, TARGET_ADDR_LO);
-
-			ret = noc_dma_transfer(NOC_CMD_WR, ret_coord, ret_addr, targ_coord,
-					       targ_addr, current_block->block_size, false, 0,
-					       false, &chan_data->state.last_noc_cmd,
-					       &chan_data->state.last_expected_acks);
-
-			if (ret != 0) {
-				handle_transfer_callbacks(dev, chan_data, channel, ret, true);
-				chan_data->state.active = false;
-				return ret;
-			}
-
-			/* Wait for write operation to complete */
-			timeout = sys_timepoint_calc(K_MSEC(NOC_DMA_TIMEOUT_MS));
-			while (!check_noc_dma_done_immediate(chan_data->state.last_noc_cmd,
-							     chan_data->state.last_expected_acks) &&
-			       !sys_timepoint_expired(timeout)) {
-				k_busy_wait(1);
-			}
-
-			if (sys_timepoint_expired(timeout)) {
-				LOG_ERR("NOC write operation timeout");
-				handle_transfer_callbacks(dev, chan_data, channel, -ETIMEDOUT,
-							  true);
-				chan_data->state.active = false;
-				return -ETIMEDOUT;
-			}
-
-			/* Enable hardware completion tracking for non-MEMORY_TO_MEMORY transfers */
-			chan_data->state.hw_completion_tracking = true;
-
-			/* Invoke callback function at transfer or block completion */
-			handle_transfer_callbacks(dev, chan_data, channel, 0,
-						  chan_data->state.block_index + 1 ==
-							  chan_data->state.block_count);
+	while (state->done_steps < state->issued_steps) {
+		uint32_t expected_acks =
+			chan_data->step_acks[state->done_steps % DMA_MAX_TRANSFER_BLOCKS];
+
+		/*
+		 * All outstanding commands use the same counter: MEMORY_TO_MEMORY, which mixes
+		 * reads and writes, only has one outstanding at a time.
+		 */
+		if (!check_noc_dma_done_immediate(NOC_DMA_TLB(channel), state->last_noc_cmd,
+						  expected_acks)) {
+			break;
 		}
 
-		if (chan_data->config.linked_channel != DMA_CHANNEL_INVALID) {
-			uint32_t linked_chan = chan_data->config.linked_channel;
-			const struct tt_bh_dma_noc_config *cfg =
-				(const struct tt_bh_dma_noc_config *)dev->config;
-			if (linked_chan < cfg->num_channels &&
-			    cfg->channels[linked_chan].state.configured) {
-				if (chan_data->config.dest_chaining_en ||
-				    chan_data->config.source_chaining_en) {
-					LOG_DBG("Triggering linked channel %u from channel %u",
-						linked_chan, channel);
-					tt_bh_dma_noc_start(dev, linked_chan);
-				}
-			}
+		state->done_steps++;
+		state->timeout = sys_timepoint_calc(K_MSEC(NOC_DMA_TIMEOUT_MS));
+		if (state->done_steps % spb == 0) {
+			state->block_index++;
+			(*blocks_done)++;
 		}
+	}
 
-		chan_data->state.active = false;
-		return 0;
+	state->hw_completion_tracking = state->issued_steps != state->done_steps;
+
+	if (state->block_index == state->block_count) {
+		state->active = false;
+		return NOC_DMA_POLL_COMPLETE;
+	}
+
+	ret = noc_dma_issue_pending(dev, channel);
+	if (ret == 0 && sys_timepoint_expired(state->timeout)) {
+		LOG_ERR("NOC DMA channel %u timeout at block %u", channel, state->block_index);
+		ret = -ETIMEDOUT;
+	}
+
+	if (ret != 0) {
+		state->active = false;
+		state->hw_completion_tracking = false;
+		return ret;
 	}
-	case MEMORY_TO_PERIPHERAL: {
-		uint32_t ret_coord = noc_dma_format_coord(coords->source_x, coords->source_y);
-		uint64_t ret_addr = current_block->source_address;
 
-		uint32_t targ_coord = noc_dma_format_coord(coords->dest_x, coords->dest_y);
-		uint64_t targ_addr = current_block->dest_address;
+	return *blocks_done > 0 ? NOC_DMA_POLL_BLOCK : NOC_DMA_POLL_BUSY;
+}
 
-		NOC2AXITlbSetup(NOC_DMA_NOC_ID, NOC_DMA_TLB, coords->source_x, coords->source_y,
-				TARGET_ADDR_LO);
+static void noc_dma_notify(const struct device *dev, uint32_t channel, int result,
+			   uint32_t blocks_done)
+{
+	struct tt_bh_dma_channel_data *chan_data = get_channel_data(dev, channel);
 
-		int ret = noc_dma_transfer(NOC_CMD_RD, ret_coord, ret_addr, targ_coord, targ_addr,
-					   current_block->block_size, false, 0, false,
-					   &chan_data->state.last_noc_cmd,
-					   &chan_data->state.last_expected_acks);
+	/* Invoke callback function at block completion */
+	for (uint32_t i = 0; i < blocks_done; i++) {
+		bool is_final_block = result == NOC_DMA_POLL_COMPLETE && i + 1 == blocks_done;
 
-		/* Enable hardware completion tracking for non-MEMORY_TO_MEMORY transfers */
-		chan_data->state.hw_completion_tracking = true;
+		handle_transfer_callbacks(dev, chan_data, channel, 0, is_final_block);
+	}
 
-		/* For async mode, callbacks will be handled when transfer actually completes */
-		if (ret != 0) {
-			/* Immediate error */
-			handle_transfer_callbacks(dev, chan_data, channel, ret, true);
-			chan_data->state.active = false;
+	if (result < 0) {
+		handle_transfer_callbacks(dev, chan_data, channel, result, true);
+		k_sem_give(&chan_data->done);
+		return;
+	}
+
+	if (result == NOC_DMA_POLL_COMPLETE) {
+		k_sem_give(&chan_data->done);
+	}
+
+	if (result == NOC_DMA_POLL_COMPLETE &&
+	    chan_data->config.linked_channel != DMA_CHANNEL_INVALID &&
+	    (chan_data->config.dest_chaining_en || chan_data->config.source_chaining_en)) {
+		uint32_t linked_chan = chan_data->config.linked_channel;
+		struct tt_bh_dma_channel_data *linked_data = get_channel_data(dev, linked_chan);
+
+		if (linked_data && linked_data->state.configured) {
+			LOG_DBG("Triggering linked channel %u from channel %u", linked_chan,
+				channel);
+			dma_start(dev, linked_chan);
 		}
-		return ret;
 	}
-	case PERIPHERAL_TO_MEMORY: {
-		uint32_t ret_coord = noc_dma_format_coord(coords->dest_x, coords->dest_y);
-		uint64_t ret_addr = current_block->dest_address;
+}
 
-		uint32_t targ_coord = noc_dma_format_coord(coords->source_x, coords->source_y);
-		uint64_t targ_addr = current_block->source_address;
+/* Returns true while the channel still has a transfer in flight */
+static bool noc_dma_poll_channel(const struct device *dev, uint32_t channel)
+{
+	struct tt_bh_dma_noc_data *dma_data = (struct tt_bh_dma_noc_data *)dev->data;
+	struct tt_bh_dma_channel_data *chan_data = get_channel_data(dev, channel);
 
-		NOC2AXITlbSetup(NOC_DMA_NOC_ID, NOC_DMA_TLB, coords->source_x, coords->source_y,
-				TARGET_ADDR_LO);
+	uint32_t blocks_done;
+	k_spinlock_key_t key = k_spin_lock(&dma_data->lock);
+	int result = noc_dma_advance(dev, channel, &blocks_done);
+	bool active = chan_data->state.active;
 
-		int ret = noc_dma_transfer(NOC_CMD_WR, ret_coord, ret_addr, targ_coord, targ_addr,
-					   current_block->block_size, false, 0, false,
-					   &chan_data->state.last_noc_cmd,
-					   &chan_data->state.last_expected_acks);
+	k_spin_unlock(&dma_data->lock, key);
 
-		/* Enable hardware completion tracking for non-MEMORY_TO_MEMORY transfers */
-		chan_data->state.hw_completion_tracking = true;
+	/* Callbacks may start transfers, so they run without the lock */
+	noc_dma_notify(dev, channel, result, blocks_done);
 
-		/* For async mode, callbacks will be handled when transfer actually completes */
-		if (ret != 0) {
-			/* Immediate error */
-			handle_transfer_callbacks(dev, chan_data, channel, ret, true);
-			chan_data->state.active = false;
-		}
-		return ret;
+	return active;
+}
+
+static void noc_dma_poll_timer_handler(struct k_timer *timer)
+{
+	struct tt_bh_dma_noc_data *dma_data =
+		CONTAINER_OF(timer, struct tt_bh_dma_noc_data, poll_timer);
+	const struct device *dev = dma_data->dev;
+	const struct tt_bh_dma_noc_config *cfg = (const struct tt_bh_dma_noc_config *)dev->config;
+	bool busy = false;
+
+	for (uint32_t channel = 0; channel < cfg->num_channels; channel++) {
+		busy |= noc_dma_poll_channel(dev, channel);
 	}
-	case TT_BH_DMA_NOC_CHANNEL_DIRECTION_BROADCAST: {
-		/* Use pre translation coords as NOC translation has enabled. */
-		uint8_t remote_start_x = 2;
-		uint8_t remote_start_y = 2;
-		uint8_t remote_end_x = 1;
-		uint8_t remote_end_y = 11;
-		uint64_t local_addr = current_block->source_address;
-		uint64_t remote_addr = current_block->dest_address;
-
-		int ret = noc_dma_write_multicast(
-			coords->dest_x, coords->dest_y, local_addr, remote_start_x, remote_start_y,
-			remote_end_x, remote_end_y, remote_addr, current_block->block_size, false,
-			&chan_data->state.last_noc_cmd, &chan_data->state.last_expected_acks);
-
-		/* Enable hardware completion tracking for non-MEMORY_TO_MEMORY transfers */
-		chan_data->state.hw_completion_tracking = true;
-
-		/* For async mode, callbacks will be handled when transfer actually completes */
-		if (ret != 0) {
-			/* Immediate error */
-			handle_transfer_callbacks(dev, chan_data, channel, ret, true);
-			chan_data->state.active = false;
+
+	if (busy) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&dma_data->lock);
+
+	/* Keep polling if a transfer was started since the channels were checked */
+	for (uint32_t channel = 0; channel < cfg->num_channels; channel++) {
+		busy |= cfg->channels[channel].state.active;
+	}
+	if (!busy) {
+		dma_data->polling = false;
+		k_timer_stop(timer);
+	}
+
+	k_spin_unlock(&dma_data->lock, key);
+}
+
+/* Called with the lock held */
+static void noc_dma_start_polling(struct tt_bh_dma_noc_data *dma_data)
+{
+	if (!dma_data->polling) {
+		dma_data->polling = true;
+		k_timer_start(&dma_data->poll_timer, K_USEC(CONFIG_DMA_TT_BH_NOC_POLL_US),
+			      K_USEC(CONFIG_DMA_TT_BH_NOC_POLL_US));
+	}
+}
+
+int tt_bh_dma_noc_wait_channel(const struct device *dev, uint32_t channel, k_timeout_t timeout)
+{
+	struct tt_bh_dma_channel_data *chan_data = get_channel_data(dev, channel);
+	k_timepoint_t end = sys_timepoint_calc(timeout);
+	struct dma_status status;
+
+	if (!chan_data) {
+		LOG_ERR("Invalid channel %u", channel);
+		return -EINVAL;
+	}
+
+	while (true) {
+		/* Also picks up a completion that the poll timer has not seen yet */
+		dma_get_status(dev, channel, &status);
+		if (!status.busy) {
+			return 0;
+		}
+
+		/* The semaphore may still be given by an earlier transfer, so check again */
+		if (k_sem_take(&chan_data->done, sys_timepoint_timeout(end)) != 0) {
+			dma_get_status(dev, channel, &status);
+			return status.busy ? -ETIMEDOUT : 0;
 		}
-		return ret;
 	}
-	default:
-		LOG_ERR("%s: Invalid channel direction %d", __func__,
-			chan_data->config.channel_direction);
+}
+
+static int tt_bh_dma_noc_start(const struct device *dev, uint32_t channel)
+{
+	struct tt_bh_dma_noc_data *dma_data = (struct tt_bh_dma_noc_data *)dev->data;
+	struct tt_bh_dma_channel_data *chan_data = get_channel_data(dev, channel);
+
+	if (!chan_data) {
+		LOG_ERR("Invalid channel %u", channel);
+		return -EINVAL;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&dma_data->lock);
+
+	if (!chan_data->state.configured) {
+		k_spin_unlock(&dma_data->lock, key);
+		LOG_ERR("Channel %u not configured", channel);
 		return -EINVAL;
 	}
+
+	if (chan_data->state.active) {
+		k_spin_unlock(&dma_data->lock, key);
+		LOG_ERR("Channel %u already active", channel);
+		return -EBUSY;
+	}
+
+	k_sem_reset(&chan_data->done);
+	chan_data->state.active = true;
+	chan_data->state.suspended = false;
+	chan_data->state.block_index = 0;
+	chan_data->state.issued_steps = 0;
+	chan_data->state.done_steps = 0;
+	chan_data->state.timeout = sys_timepoint_calc(K_MSEC(NOC_DMA_TIMEOUT_MS));
+
+	/* All commands of a transfer come from one NIU, broadcasts from the tile being copied */
+	struct tt_bh_dma_noc_coords *coords = &chan_data->coords;
+
+	if (chan_data->config.channel_direction == TT_BH_DMA_NOC_CHANNEL_DIRECTION_BROADCAST) {
+		chan_data->state.niu_x = coords->dest_x;
+		chan_data->state.niu_y = coords->dest_y;
+	} else {
+		chan_data->state.niu_x = coords->source_x;
+		chan_data->state.niu_y = coords->source_y;
+	}
+	chan_data->state.hw_completion_tracking = false;
+	NOC2AXITlbSetup(NOC_DMA_NOC_ID, NOC_DMA_TLB(channel), chan_data->state.niu_x,
+			chan_data->state.niu_y, TARGET_ADDR_LO);
+
+	/* Issue what the NIU has room for now, the rest is issued as commands complete */
+	int ret = noc_dma_issue_pending(dev, channel);
+
+	if (ret != 0) {
+		chan_data->state.active = false;
+		chan_data->state.hw_completion_tracking = false;
+	} else {
+		noc_dma_start_polling(dma_data);
+	}
+
+	k_spin_unlock(&dma_data->lock, key);
+
+	if (ret != 0) {
+		/* Immediate error */
+		handle_transfer_callbacks(dev, chan_data, channel, ret, true);
+		k_sem_give(&chan_data->done);
+		return ret;
+	}
+
+	return 0;
 }
 
 static int tt_bh_dma_noc_init(const struct device *dev)
 {
 	struct tt_bh_dma_noc_data *data = (struct tt_bh_dma_noc_data *)dev->data;
+	const struct tt_bh_dma_noc_config *cfg = (const struct tt_bh_dma_noc_config *)dev->config;
 
 	data->lock = (struct k_spinlock){};
+	data->dev = dev;
+	k_timer_init(&data->poll_timer, noc_dma_poll_timer_handler, NULL);
+
+	for (uint32_t channel = 0; channel < cfg->num_channels; channel++) {
+		k_sem_init(&cfg->channels[channel].done, 0, 1);
+	}
 
 	return 0;
 }
@@ -619,6 +788,9 @@ static int tt_bh_dma_noc_get_status(const struct device *dev, uint32_t channel,
 		return -EINVAL;
 	}
 
+	/* Callers that poll for completion don't have to wait for the poll timer */
+	noc_dma_poll_channel(dev, channel);
+
 	/* Set transfer direction from configuration */
 	if (chan_data->state.configured) {
 		status->dir = (enum dma_channel_direction)chan_data->config.channel_direction;
@@ -629,16 +801,6 @@ static int tt_bh_dma_noc_get_status(const struct device *dev, uint32_t channel,
 	/* Determine if channel is busy (active and not suspended) */
 	status->busy = chan_data->state.active && !chan_data->state.suspended;
 
-	/* For NOC transfers, check hardware completion status immediately (non-blocking) */
-	if (chan_data->state.active && chan_data->state.hw_completion_tracking) {
-		bool hw_done = check_noc_dma_done_immediate(chan_data->state.last_noc_cmd,
-							    chan_data->state.last_expected_acks);
-		if (hw_done) {
-			/* Hardware is done, but software hasn't caught up yet */
-			status->busy = false;
-		}
-	}
-
 	/* Calculate pending length and total copied based on block progress */
 	if (chan_data->state.configured) {
 		uint32_t remaining_bytes = 0;
@@ -667,6 +829,7 @@ static int tt_bh_dma_noc_get_status(const struct device *dev, uint32_t channel,
 
 static int tt_bh_dma_noc_stop(const struct device *dev, uint32_t channel)
 {
+	struct tt_bh_dma_noc_data *dma_data = (struct tt_bh_dma_noc_data *)dev->data;
 	struct tt_bh_dma_channel_data *chan_data = get_channel_data(dev, channel);
 
 	if (!chan_data) {
@@ -674,14 +837,17 @@ static int tt_bh_dma_noc_stop(const struct device *dev, uint32_t channel)
 		return -EINVAL;
 	}
 
-	if (!chan_data->state.active) {
-		return 0;
-	}
+	k_spinlock_key_t key = k_spin_lock(&dma_data->lock);
 
+	/* A command already issued still completes, it is just no longer tracked */
 	chan_data->state.active = false;
 	chan_data->state.suspended = false;
 	chan_data->state.hw_completion_tracking = false;
 
+	k_spin_unlock(&dma_data->lock, key);
+
+	k_sem_give(&chan_data->done);
+
 	return 0;
 }
 
@@ -742,6 +908,9 @@ static const struct dma_driver_api tt_bh_dma_noc_api = {
 };
 
 #define TT_BH_DMA_NOC_INIT(inst)                                                                   \
+	BUILD_ASSERT(DT_INST_PROP(inst, dma_channels) <= NOC_DMA_NUM_TLBS,                         \
+		     "Each NOC DMA channel needs its own TLB");                                    \
+                                                                                                   \
 	static struct tt_bh_dma_channel_data                                                       \
 		tt_bh_dma_noc_channels_##inst[DT_INST_PROP(inst, dma_channels)];                   \
                                                                                                    \
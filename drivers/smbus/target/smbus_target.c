@@ -10,7 +10,6 @@
 #include <zephyr/kernel.h>
 #include <errno.h>
 #include <zephyr/drivers/i2c.h>
-#include <zephyr/sys/crc.h>
 #include <tenstorrent/smbus_target.h>
 
 #define LOG_LEVEL CONFIG_I2C_LOG_LEVEL
@@ -38,6 +37,10 @@ struct smbus_target_data {
 	uint8_t blocksize_w;
 	uint8_t rcv_index;
 	uint8_t send_index;
+	/* PEC of all bytes of the current transaction so far, updated as each byte is
+	 * transferred
+	 */
+	uint8_t pec;
 	uint8_t received_data[CONFIG_SMBUS_MAX_MSG_SIZE];
 	uint8_t send_data[CONFIG_SMBUS_MAX_MSG_SIZE];
 };
@@ -51,9 +54,35 @@ static const SmbusCmdDef *get_cmd_def(struct smbus_target_data *smbus_data, uint
 	return smbus_data->cmd_defs[cmd];
 }
 
+/* CRC-8 with polynomial x^8 + x^2 + x + 1 (0x07), as used for the SMBus PEC */
+static const uint8_t pec_crc_8_table[256] = {
+	0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31,
+	0x24, 0x23, 0x2a, 0x2d, 0x70, 0x77, 0x7e, 0x79, 0x6c, 0x6b, 0x62, 0x65,
+	0x48, 0x4f, 0x46, 0x41, 0x54, 0x53, 0x5a, 0x5d, 0xe0, 0xe7, 0xee, 0xe9,
+	0xfc, 0xfb, 0xf2, 0xf5, 0xd8, 0xdf, 0xd6, 0xd1, 0xc4, 0xc3, 0xca, 0xcd,
+	0x90, 0x97, 0x9e, 0x99, 0x8c, 0x8b, 0x82, 0x85, 0xa8, 0xaf, 0xa6, 0xa1,
+	0xb4, 0xb3, 0xba, 0xbd, 0xc7, 0xc0, 0xc9, 0xce, 0xdb, 0xdc, 0xd5, 0xd2,
+	0xff, 0xf8, 0xf1, 0xf6, 0xe3, 0xe4, 0xed, 0xea, 0xb7, 0xb0, 0xb9, 0xbe,
+	0xab, 0xac, 0xa5, 0xa2, 0x8f, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9d, 0x9a,
+	0x27, 0x20, 0x29, 0x2e, 0x3b, 0x3c, 0x35, 0x32, 0x1f, 0x18, 0x11, 0x16,
+	0x03, 0x04, 0x0d, 0x0a, 0x57, 0x50, 0x59, 0x5e, 0x4b, 0x4c, 0x45, 0x42,
+	0x6f, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7d, 0x7a, 0x89, 0x8e, 0x87, 0x80,
+	0x95, 0x92, 0x9b, 0x9c, 0xb1, 0xb6, 0xbf, 0xb8, 0xad, 0xaa, 0xa3, 0xa4,
+	0xf9, 0xfe, 0xf7, 0xf0, 0xe5, 0xe2, 0xeb, 0xec, 0xc1, 0xc6, 0xcf, 0xc8,
+	0xdd, 0xda, 0xd3, 0xd4, 0x69, 0x6e, 0x67, 0x60, 0x75, 0x72, 0x7b, 0x7c,
+	0x51, 0x56, 0x5f, 0x58, 0x4d, 0x4a, 0x43, 0x44, 0x19, 0x1e, 0x17, 0x10,
+	0x05, 0x02, 0x0b, 0x0c, 0x21, 0x26, 0x2f, 0x28, 0x3d, 0x3a, 0x33, 0x34,
+	0x4e, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5c, 0x5b, 0x76, 0x71, 0x78, 0x7f,
+	0x6a, 0x6d, 0x64, 0x63, 0x3e, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2c, 0x2b,
+	0x06, 0x01, 0x08, 0x0f, 0x1a, 0x1d, 0x14, 0x13, 0xae, 0xa9, 0xa0, 0xa7,
+	0xb2, 0xb5, 0xbc, 0xbb, 0x96, 0x91, 0x98, 0x9f, 0x8a, 0x8d, 0x84, 0x83,
+	0xde, 0xd9, 0xd0, 0xd7, 0xc2, 0xc5, 0xcc, 0xcb, 0xe6, 0xe1, 0xe8, 0xef,
+	0xfa, 0xfd, 0xf4, 0xf3,
+};
+
 static inline uint8_t pec_crc_8(uint8_t crc, uint8_t data)
 {
-	return crc8(&data, 1, 0x7, crc, false);
+	return pec_crc_8_table[crc ^ data];
 }
 
 static int32_t smbus_target_register(const struct device *dev)
@@ -89,8 +118,12 @@ static int smbus_write_handler(struct i2c_target_config *config, uint8_t val)
 			return -1;
 		}
 		smbus_data->state = kSmbusStateCmd;
+		smbus_data->pec = pec_crc_8(0, smbus_data->config.address << 1 |
+						       I2C_MSG_WRITE); /* start address byte */
+		smbus_data->pec = pec_crc_8(smbus_data->pec, smbus_data->command);
 	} else if (smbus_data->state == kSmbusStateCmd) {
 		/*Log something like WriteReg(I2C0_TARGET_DEBUG_STATE_REG_ADDR, 0xc0de1040); */
+		smbus_data->pec = pec_crc_8(smbus_data->pec, val);
 		switch (curr_cmd->trans_type) {
 		case kSmbusTransBlockWrite:
 		case kSmbusTransBlockWriteBlockRead:
@@ -130,6 +163,7 @@ static int smbus_write_handler(struct i2c_target_config *config, uint8_t val)
 		}
 	} else if (smbus_data->state == kSmbusStateRcvData) {
 		/*Log something like WriteReg(I2C0_TARGET_DEBUG_STATE_REG_ADDR, 0xc0de1050); */
+		smbus_data->pec = pec_crc_8(smbus_data->pec, val);
 		smbus_data->received_data[smbus_data->rcv_index++] = val;
 		if (smbus_data->rcv_index == smbus_data->blocksize_w) {
 			if (1U == curr_cmd->pec &&
@@ -150,20 +184,7 @@ static int smbus_write_handler(struct i2c_target_config *config, uint8_t val)
 		/*Log something like WriteReg(I2C0_TARGET_DEBUG_STATE_REG_ADDR, 0xc0de1060);*/
 		uint8_t rcv_pec = val;
 
-		/* Calculate the PEC */
-		uint8_t pec = 0;
-
-		pec = pec_crc_8(pec, smbus_data->config.address << 1 |
-					     I2C_MSG_WRITE); /* start address byte */
-		pec = pec_crc_8(pec, smbus_data->command);
-		if (curr_cmd->trans_type == kSmbusTransBlockWrite) {
-			pec = pec_crc_8(pec, smbus_data->blocksize_w);
-		}
-		for (int i = 0; i < smbus_data->blocksize_w; i++) {
-			pec = pec_crc_8(pec, smbus_data->received_data[i]);
-		}
-
-		if (pec != rcv_pec) {
+		if (smbus_data->pec != rcv_pec) {
 			smbus_data->blocksize_w = kSmbusStateWaitIdle;
 			return -1;
 		}
@@ -207,6 +228,10 @@ static int32_t smbus_read_handler(struct i2c_target_config *config, uint8_t *val
 			*val = 0xFF;
 			return -1;
 		}
+		/* restart address byte */
+		smbus_data->pec = pec_crc_8(smbus_data->pec,
+					    smbus_data->config.address << 1 | I2C_MSG_READ);
+
 		/* Call the send handler to get the data */
 		if (curr_cmd->send_handler(smbus_data->send_data, &smbus_data->blocksize_r)) {
 			/*Log something like WriteReg(I2C0_TARGET_DEBUG_STATE_REG_ADDR,
@@ -254,38 +279,12 @@ static int32_t smbus_read_handler(struct i2c_target_config *config, uint8_t *val
 		}
 	} else if (smbus_data->state == kSmbusStateSendPec) {
 		/* Log something like WriteReg(I2C0_TARGET_DEBUG_STATE_REG_ADDR, 0xc0de0060);*/
-		/* Calculate and send PEC. This is a read-type operation, so it starts with a
-		 * sequence of writes, then some reads.
+		/* The PEC covers every byte of the transaction, which has been accumulated as the
+		 * bytes were transferred.
 		 */
-
-		uint8_t pec = 0;
-
-		pec = pec_crc_8(pec, smbus_data->config.address << 1 |
-					     I2C_MSG_WRITE); /* start address byte */
-		pec = pec_crc_8(pec, smbus_data->command);
-
-		if (curr_cmd->trans_type == kSmbusTransBlockWriteBlockRead) {
-			pec = pec_crc_8(pec, smbus_data->blocksize_w);
-		}
-		/* any received data */
-		for (int i = 0; i < smbus_data->rcv_index; i++) {
-			pec = pec_crc_8(pec, smbus_data->received_data[i]);
-		}
-
-		pec = pec_crc_8(pec, smbus_data->config.address << 1 |
-					     I2C_MSG_READ); /* restart address byte */
-
-		/* sent data */
-		if (curr_cmd->trans_type == kSmbusTransBlockRead ||
-		    curr_cmd->trans_type == kSmbusTransBlockWriteBlockRead) {
-			pec = pec_crc_8(pec, smbus_data->blocksize_r);
-		}
-		for (int i = 0; i < smbus_data->blocksize_r; i++) {
-			pec = pec_crc_8(pec, smbus_data->send_data[i]);
-		}
-
-		*val = pec;
+		*val = smbus_data->pec;
 		smbus_data->state = kSmbusStateWaitIdle;
+		return 0;
 	} else {
 		/*Log something like WriteReg(I2C0_TARGET_DEBUG_STATE_REG_ADDR,
 		 *	 0xc1de0000 | ReadReg(I2C0_TARGET_DEBUG_STATE_REG_ADDR));
@@ -294,6 +293,8 @@ static int32_t smbus_read_handler(struct i2c_target_config *config, uint8_t *val
 		*val = 0xFF;
 		return -1;
 	}
+
+	smbus_data->pec = pec_crc_8(smbus_data->pec, *val);
 	return 0;
 }
 
@@ -12,7 +12,11 @@
 #include <zephyr/sys/iterable_sections.h>
 
 #define NUM_MSG_QUEUES         4
+#ifdef CONFIG_TT_BH_ARC_MSG_QUEUE_SIZE
+#define MSG_QUEUE_SIZE         CONFIG_TT_BH_ARC_MSG_QUEUE_SIZE
+#else
 #define MSG_QUEUE_SIZE         4
+#endif
 #define MSG_QUEUE_POINTER_WRAP (2 * MSG_QUEUE_SIZE)
 #define REQUEST_MSG_LEN        8
 #define RESPONSE_MSG_LEN       8
@@ -24,6 +28,10 @@
 #define MESSAGE_QUEUE_STATUS_MESSAGE_RECOGNIZED 0xff
 #define MESSAGE_QUEUE_STATUS_SCRATCH_ONLY       0xfe
 
+#define MSG_BATCH_MAX_REQUESTS 64
+
+#define TELEM_STREAM_MAX_TAGS 16
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -80,6 +88,26 @@ struct aiclk_set_speed_rqst {
 	uint8_t pad[3];
 };
 
+/** @brief Host request to announce the intensity of upcoming work
+ * @details Requests of this type are processed by @ref aiclk_workload_hint_handler. Like
+ * @ref TT_SMC_MSG_AICLK_GO_BUSY, a nonzero intensity makes AICLK busy and 0 makes it idle.
+ * Before going busy, the power and current throttlers lower AICLK to the frequency at which the
+ * workload is predicted to reach their limits, using a power per MHz model learned from earlier
+ * announced workloads. This avoids the current spike of running at fmax until the throttlers
+ * react. The limits are lowered by the next DVFS update, and the response carries the predicted
+ * AICLK limit in MHz in data[1]. GO_BUSY and GO_LONG_IDLE end the announced workload.
+ */
+struct aiclk_workload_hint_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_AICLK_WORKLOAD_HINT */
+	uint8_t command_code;
+
+	/** @brief Expected power per MHz as a percentage of the heaviest workload, 0 to go idle */
+	uint8_t intensity;
+
+	/** @brief Two bytes of padding */
+	uint8_t pad[2];
+};
+
 /** @brief Host request to adjust the power settings
  * @details Requests of this type are processed by @ref power_setting_msg_handler
  */
@@ -277,6 +305,178 @@ struct send_pcie_msi_rqst {
 	uint32_t vector_id;
 };
 
+/** @brief Host request to read message latency statistics
+ * @details Requests of this type are processed by @ref get_msg_stats_handler. Only available when
+ * the firmware is built with CONFIG_TT_BH_ARC_MSG_STATS.
+ */
+struct msg_stats_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_GET_MSG_STATS */
+	uint8_t command_code;
+
+	/** @brief The message code to read service time statistics for */
+	uint8_t msg_code;
+
+	/** @brief Index of the first histogram bucket to return */
+	uint8_t first_bucket;
+
+	/** @brief Bit 0: read queue wait time instead of @ref msg_code service time <br>
+	 *  Bit 1: reset all statistics after reading
+	 */
+	uint8_t flags;
+};
+
+/** @brief Host request to run a batch of requests
+ * @details Each sub-request is dispatched through the regular message handlers and its response
+ * is written to the matching entry of the response array. Sub-requests may not be batches
+ * themselves, and TT_SMC_MSG_SET_LAST_SERIAL, TT_SMC_MSG_TEST and the SPI flash messages, which
+ * complete on their own thread, are not supported in a batch.
+ * The response carries the number of sub-requests that were run in data[1]. Both arrays must be in
+ * CSM, otherwise the batch fails with status 1 and no sub-request is run.
+ */
+struct batch_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_BATCH */
+	uint8_t command_code;
+
+	/** @brief One byte of padding */
+	uint8_t pad;
+
+	/** @brief Number of sub-requests, at most @ref MSG_BATCH_MAX_REQUESTS */
+	uint16_t count;
+
+	/** @brief 4-byte aligned ARC address (e.g. in CSM) of an array of @ref count requests */
+	uint32_t requests_addr;
+
+	/** @brief 4-byte aligned ARC address of an array of @ref count responses */
+	uint32_t responses_addr;
+};
+
+/** @brief Host request to start or stop streaming telemetry into a ring buffer
+ * @details Requests of this type are processed by @ref telem_stream_handler. Each record holds a
+ * timestamp followed by the value of each requested tag. Starting a stream restarts the ring.
+ * Only available when the firmware is built with CONFIG_TT_BH_ARC_TELEM_STREAM.
+ */
+struct telem_stream_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_TELEM_STREAM */
+	uint8_t command_code;
+
+	/** @brief Number of valid entries in @ref tags, 0 to stop streaming */
+	uint8_t num_tags;
+
+	/** @brief Sampling period in milliseconds */
+	uint16_t period_ms;
+
+	/** @brief Telemetry tags to sample */
+	uint8_t tags[TELEM_STREAM_MAX_TAGS];
+};
+
+/** @brief Host request to export the DVFS control loop trace
+ * @details Requests of this type are processed by @ref dvfs_trace_handler. The response carries
+ * the address of the trace ring buffer header in data[1], which is also published in
+ * DVFS_TRACE_REG_ADDR, and the number of records written in data[2]. The trace is decoded by
+ * scripts/dvfs_trace.py. Only available when the firmware is built with
+ * CONFIG_TT_BH_ARC_DVFS_TRACE.
+ */
+struct dvfs_trace_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_DVFS_TRACE */
+	uint8_t command_code;
+
+	/** @brief Bit 0: restart the trace after reading its state, from the next DVFS update */
+	uint8_t flags;
+};
+
+/** @brief Host request to change how often a group of telemetry tags is refreshed
+ * @details Requests of this type are processed by @ref set_telem_period_handler. The telemetry
+ * update timer runs at the shortest group period, which is reported in
+ * TAG_UPDATE_TELEM_SPEED.
+ */
+struct telem_period_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_SET_TELEM_PERIOD */
+	uint8_t command_code;
+
+	/** @brief The group to change: 0 power and temperature, 1 clocks, 2 fan, 3 GDDR,
+	 * 0xff all groups
+	 */
+	uint8_t group;
+
+	/** @brief Two bytes of padding */
+	uint8_t pad[2];
+
+	/** @brief The refresh period in milliseconds, from 10 to 60000 */
+	uint32_t period_ms;
+};
+
+/** @brief Host request to run a linked list of PCIe DMA transfers
+ * @details Requests of this type are processed by @ref pcie_dma_ll_transfer_handler. The list is
+ * prepared by the host in memory the PCIe controller can reach, in the controller's HDMA linked
+ * list format. Each 24-byte data element holds a control word, the transfer size, and the 64-bit
+ * source and destination addresses. Elements are processed while their cycle bit (bit 0 of the
+ * control word) is set, and a link element (bit 2) continues the list at another address. The
+ * completion MSI is sent when the list ends. If all channels are busy, the transfer is queued
+ * and started when a channel frees up.
+ */
+struct pcie_dma_ll_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_PCIE_DMA_LL_TRANSFER */
+	uint8_t command_code;
+
+	/** @brief Data written to the completion MSI address */
+	uint8_t completion_data;
+
+	/** @brief 1 for a host to chip transfer, 0 for chip to host */
+	uint8_t host_to_chip;
+
+	/** @brief One byte of padding */
+	uint8_t pad;
+
+	/** @brief Low 32 bits of the address of the first list element */
+	uint32_t list_addr_low;
+
+	/** @brief High 32 bits of the address of the first list element */
+	uint32_t list_addr_high;
+
+	/** @brief Low 32 bits of the completion MSI address, the abort MSI goes 4 bytes above */
+	uint32_t msi_completion_addr_low;
+
+	/** @brief High 32 bits of the completion MSI address */
+	uint32_t msi_completion_addr_high;
+};
+
+/** @brief One range of a @ref flash_update_rqst manifest */
+struct flash_update_range {
+	/** @brief SPI flash address to write */
+	uint32_t spi_addr;
+
+	/** @brief Number of bytes to write */
+	uint32_t num_bytes;
+
+	/** @brief Address of the data, within the SPI programming buffer */
+	uint32_t data_addr;
+};
+
+/** @brief Host request to write several ranges of SPI flash in one operation
+ * @details Requests of this type are processed by @ref flash_update_handler. The manifest and
+ * the data of every range are placed by the host in the SPI programming buffer. Sectors that
+ * already hold the data are skipped, sectors where the data only clears bits are programmed
+ * without an erase, and consecutive sectors that need an erase are erased together. Progress is
+ * published in FLASH_UPDATE_PROGRESS_REG_ADDR while the update runs. Flash must be unlocked.
+ * The manifest is read when the request arrives and may hold at most
+ * CONFIG_TT_BH_ARC_FLASH_UPDATE_MAX_RANGES ranges, the data is read when the update runs.
+ */
+struct flash_update_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_FLASH_UPDATE */
+	uint8_t command_code;
+
+	/** @brief One byte of padding */
+	uint8_t pad;
+
+	/** @brief Number of ranges in the manifest, 0 to only read the counters since boot */
+	uint16_t num_ranges;
+
+	/** @brief Address of the array of @ref flash_update_range, within the SPI programming
+	 * buffer
+	 */
+	uint32_t manifest_addr;
+};
+
 /** @brief A tenstorrent host request*/
 union request {
 	/** @brief The interpretation of the request as an array of uint32_t entries*/
@@ -293,6 +493,9 @@ union request {
 	/** @brief An AICLK set speed request*/
 	struct aiclk_set_speed_rqst aiclk_set_speed;
 
+	/** @brief An AICLK workload hint request */
+	struct aiclk_workload_hint_rqst aiclk_workload_hint;
+
 	/** @brief A power setting request*/
 	struct power_setting_rqst power_setting;
 
@@ -322,6 +525,27 @@ union request {
 
 	/** @brief A Send PCIE MSI request */
 	struct send_pcie_msi_rqst send_pci_msi;
+
+	/** @brief A message latency statistics request */
+	struct msg_stats_rqst msg_stats;
+
+	/** @brief A batch request */
+	struct batch_rqst batch;
+
+	/** @brief A telemetry streaming request */
+	struct telem_stream_rqst telem_stream;
+
+	/** @brief A telemetry refresh period request */
+	struct telem_period_rqst telem_period;
+
+	/** @brief A linked list PCIe DMA transfer request */
+	struct pcie_dma_ll_rqst pcie_dma_ll;
+
+	/** @brief A SPI flash update request */
+	struct flash_update_rqst flash_update;
+
+	/** @brief A DVFS trace export request */
+	struct dvfs_trace_rqst dvfs_trace;
 };
 
 /** @} */
@@ -337,7 +561,15 @@ struct msgqueue_handler {
 	msgqueue_request_handler_t handler;
 };
 
+/* Reserved response slot of a message whose handler called msgqueue_defer_response(). */
+struct msgqueue_deferred_response {
+	uint32_t msgqueue_id;
+	uint32_t slot;
+};
+
 #define REGISTER_MESSAGE(msg, func)                                                                \
+	BUILD_ASSERT((msg) < CONFIG_TT_BH_ARC_NUM_MSG_CODES,                                       \
+		     #msg " is not below CONFIG_TT_BH_ARC_NUM_MSG_CODES");                         \
 	const STRUCT_SECTION_ITERABLE(msgqueue_handler, registration_for_##msg) = {                \
 		.msg_type = msg,                                                                   \
 		.handler = func,                                                                   \
@@ -351,6 +583,31 @@ int msgqueue_request_pop(uint32_t msgqueue_id, union request *request);
 int msgqueue_response_push(uint32_t msgqueue_id, const struct response *response);
 int msgqueue_response_pop(uint32_t msgqueue_id, struct response *response);
 void init_msgqueue(void);
+void msgqueue_notify(void);
+int msgqueue_set_queue_priority(uint32_t msgqueue_id, uint8_t priority);
+
+/**
+ * @brief Defer the response to the message currently being handled
+ *
+ * May only be called from a message handler. The handler's response and return value are then
+ * discarded, and its response slot stays reserved until msgqueue_complete_response() is called,
+ * which may be from any thread. Later messages keep being dispatched meanwhile; their responses
+ * are published once every earlier response in the same queue has completed.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if not called from a message handler, or called twice for the same message
+ */
+int msgqueue_defer_response(struct msgqueue_deferred_response *deferred);
+
+/**
+ * @brief Complete a response deferred with msgqueue_defer_response()
+ *
+ * @param deferred The reserved response slot
+ * @param response The response, with @p exit_code merged into data[0] as for a handler
+ * @param exit_code The handler exit code
+ */
+void msgqueue_complete_response(const struct msgqueue_deferred_response *deferred,
+				struct response *response, uint8_t exit_code);
 
 #ifdef __cplusplus
 }
@@ -128,6 +128,22 @@ enum tt_smc_msg {
 	TT_SMC_MSG_FLASH_LOCK = 0xC3,
 	/** @brief Confirm SPI flash succeeded */
 	TT_SMC_MSG_CONFIRM_FLASHED_SPI = 0xC4,
+	/** @brief @ref msg_stats_rqst "Read message latency statistics request" */
+	TT_SMC_MSG_GET_MSG_STATS = 0xC5,
+	/** @brief @ref batch_rqst "Run a batch of requests" */
+	TT_SMC_MSG_BATCH = 0xC6,
+	/** @brief @ref telem_stream_rqst "Start or stop telemetry streaming" */
+	TT_SMC_MSG_TELEM_STREAM = 0xC7,
+	/** @brief @ref telem_period_rqst "Set telemetry refresh period" */
+	TT_SMC_MSG_SET_TELEM_PERIOD = 0xC8,
+	/** @brief @ref pcie_dma_ll_rqst "Linked list PCIe DMA transfer request" */
+	TT_SMC_MSG_PCIE_DMA_LL_TRANSFER = 0xC9,
+	/** @brief @ref flash_update_rqst "SPI flash update from a manifest of ranges" */
+	TT_SMC_MSG_FLASH_UPDATE = 0xCA,
+	/** @brief @ref dvfs_trace_rqst "Export the DVFS control loop trace" */
+	TT_SMC_MSG_DVFS_TRACE = 0xCB,
+	/** @brief @ref aiclk_workload_hint_rqst "Go busy with a workload of a given intensity" */
+	TT_SMC_MSG_AICLK_WORKLOAD_HINT = 0xCC,
 };
 
 /** @} */
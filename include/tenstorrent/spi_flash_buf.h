@@ -10,12 +10,17 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include <tenstorrent/tt_boot_fs.h>
 #include <zephyr/device.h>
 
+/* Each chunk read into buf is passed to cb, and added to cksum unless it is NULL */
 int spi_transfer_by_parts(const struct device *dev, size_t spi_address, size_t image_size,
 			  uint8_t *buf, size_t buf_size, uint8_t *tlb_dst,
-			  int (*cb)(uint8_t *src, uint8_t *dst, size_t len));
+			  int (*cb)(uint8_t *src, uint8_t *dst, size_t len),
+			  struct tt_boot_fs_cksum_ctx *cksum);
+/* Copies an image to a tile by ARC DMA, and adds it to cksum unless it is NULL */
 int spi_arc_dma_transfer_to_tile(const struct device *dev, size_t spi_address, size_t image_size,
-				 uint8_t *buf, size_t buf_size, uint8_t *tlb_dst);
+				 uint8_t *buf, size_t buf_size, uint8_t *tlb_dst,
+				 struct tt_boot_fs_cksum_ctx *cksum);
 
 #endif
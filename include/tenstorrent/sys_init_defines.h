@@ -11,6 +11,9 @@
 
 /* SYS_INIT APPLICATION defines */
 #define register_interrupt_handlers_PRIO      0
+#define msgqueue_work_q_init_PRIO             0
+#define pcie_dma_init_PRIO                    0
+#define dma_work_q_init_PRIO                  0
 #define arc_dma_init_PRIO                     1
 #define InitSpiFS_PRIO                        2
 #define bh_arc_init_start_PRIO                3
@@ -74,6 +74,18 @@ enum {
 	TT_BOOT_FS_ERR = -1
 };
 
+/**
+ * @brief State of a checksum computed over several chunks, see tt_boot_fs_cksum_update()
+ */
+struct tt_boot_fs_cksum_ctx {
+	uint32_t cksum;
+	/* Bytes of a word split across chunks, little endian */
+	uint32_t tail;
+	uint8_t tail_len;
+	/* Number of bytes added so far */
+	size_t size;
+};
+
 typedef enum {
 	TT_BOOT_FS_CHK_OK,
 	TT_BOOT_FS_CHK_FAIL,
@@ -90,8 +102,50 @@ int tt_boot_fs_add_file(const tt_boot_fs *tt_boot_fs, tt_boot_fs_fd fd_data,
 			const uint8_t *image_data_src, bool isFailoverEntry,
 			bool isSecurityBinaryEntry);
 
+/**
+ * @brief Add data to a checksum
+ *
+ * The checksum is the sum of the little endian words of the data, as computed by cksum() in
+ * scripts/tt_boot_fs.py. A trailing partial word is counted as if it were zero padded, except
+ * that data shorter than one word adds nothing.
+ *
+ * @param cksum checksum to add to
+ * @param data data to add, of any alignment
+ * @param size size of the data in bytes
+ * @return the checksum, or 0 if @p data is NULL or @p size is 0
+ */
 uint32_t tt_boot_fs_cksum(uint32_t cksum, const uint8_t *data, size_t size);
 
+/**
+ * @brief Start a checksum computed over several chunks
+ *
+ * @param ctx checksum state
+ */
+void tt_boot_fs_cksum_init(struct tt_boot_fs_cksum_ctx *ctx);
+
+/**
+ * @brief Add a chunk of data to a checksum
+ *
+ * Chunks may have any size and alignment. The result of tt_boot_fs_cksum_final() is the same as
+ * tt_boot_fs_cksum() over all chunks concatenated.
+ *
+ * @param ctx checksum state
+ * @param data chunk of data
+ * @param size size of the chunk in bytes
+ */
+void tt_boot_fs_cksum_update(struct tt_boot_fs_cksum_ctx *ctx, const uint8_t *data, size_t size);
+
+/**
+ * @brief Get the checksum of all chunks added so far
+ *
+ * A trailing partial word is counted as if it were zero padded, unless fewer than 4 bytes were
+ * added in total.
+ *
+ * @param ctx checksum state
+ * @return the checksum
+ */
+uint32_t tt_boot_fs_cksum_final(const struct tt_boot_fs_cksum_ctx *ctx);
+
 int tt_boot_fs_get_file(const tt_boot_fs *tt_boot_fs, const uint8_t *tag, uint8_t *buf,
 			size_t buf_size, size_t *file_size);
 
@@ -127,6 +181,9 @@ int tt_boot_fs_ls(const struct device *dev, tt_boot_fs_fd *fds, size_t nfds, siz
  * - the size of the file, and
  * - the checksum of the file, and more.
  *
+ * The directory of @p flash_dev is read and validated once, and kept in RAM indexed by tag until
+ * a different device is searched or tt_boot_fs_invalidate() is called.
+ *
  * @param flash_dev flash device containing the boot filesystem
  * @param tag name of the image to search for
  * @param[out] fd optional pointer to memory where the file descriptor will be written, if found
@@ -139,6 +196,16 @@ int tt_boot_fs_ls(const struct device *dev, tt_boot_fs_fd *fds, size_t nfds, siz
 int tt_boot_fs_find_fd_by_tag(const struct device *flash_dev, const uint8_t *tag,
 			      tt_boot_fs_fd *fd);
 
+/**
+ * @brief Drop the in-RAM directory of a flash device
+ *
+ * Must be called after the boot filesystem on @p flash_dev is written through the flash API, so
+ * that the next tt_boot_fs_find_fd_by_tag() reads the directory again.
+ *
+ * @param flash_dev flash device containing the boot filesystem
+ */
+void tt_boot_fs_invalidate(const struct device *flash_dev);
+
 #ifdef __cplusplus
 }
 #endif
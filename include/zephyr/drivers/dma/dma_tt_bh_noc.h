@@ -5,6 +5,7 @@
  */
 
 #include <zephyr/drivers/dma.h>
+#include <zephyr/kernel.h>
 
 enum tt_bh_dma_noc_channel_direction {
 	TT_BH_DMA_NOC_CHANNEL_DIRECTION_BROADCAST = DMA_CHANNEL_DIRECTION_PRIV_START
@@ -25,3 +26,31 @@ tt_bh_dma_noc_coords_init(uint8_t source_x, uint8_t source_y, uint8_t dest_x, ui
 		.dest_y = dest_y,
 	};
 }
+
+/* Transfers run asynchronously, and dma_config() returns -EBUSY while the channel has one in
+ * flight. Wait until the channel has none, sleeping until the driver sees the transfer complete,
+ * fail or stop. Each transfer also times out in the driver if the NOC does not complete it.
+ *
+ * Returns 0, -EINVAL for an invalid channel, or -ETIMEDOUT if the channel is still busy at the
+ * timeout.
+ */
+int tt_bh_dma_noc_wait_channel(const struct device *dev, uint32_t channel, k_timeout_t timeout);
+
+/* Wait until channels 0 to num_channels - 1 have no transfer in flight, see
+ * tt_bh_dma_noc_wait_channel(). The timeout is for all channels together.
+ */
+static inline int tt_bh_dma_noc_wait_idle(const struct device *dev, uint32_t num_channels,
+					  k_timeout_t timeout)
+{
+	k_timepoint_t end = sys_timepoint_calc(timeout);
+
+	for (uint32_t channel = 0; channel < num_channels; channel++) {
+		int ret = tt_bh_dma_noc_wait_channel(dev, channel, sys_timepoint_timeout(end));
+
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
@@ -6,6 +6,7 @@
 
 #include "aiclk_ppm.h"
 #include "dvfs.h"
+#include "throttler.h"
 #include "voltage.h"
 #include "vf_curve.h"
 
@@ -49,6 +50,8 @@ typedef struct {
 	uint32_t sweep_high;  /* in MHz */
 	float arbiter_max[kAiclkArbMaxCount];
 	float arbiter_min[kAiclkArbMinCount];
+	int8_t arb_min_winner; /* arbiter that set targ_freq, -1 if none */
+	int8_t arb_max_winner;
 } AiclkPPM;
 
 static AiclkPPM aiclk_ppm = {
@@ -76,14 +79,19 @@ void CalculateTargAiclk(void)
 	/* Finally make sure that the target frequency is at least Fmin */
 	uint32_t targ_freq = aiclk_ppm.fmin;
 
+	aiclk_ppm.arb_min_winner = -1;
+	aiclk_ppm.arb_max_winner = -1;
+
 	for (AiclkArbMin i = 0; i < kAiclkArbMinCount; i++) {
 		if (aiclk_ppm.arbiter_min[i] > targ_freq) {
 			targ_freq = aiclk_ppm.arbiter_min[i];
+			aiclk_ppm.arb_min_winner = i;
 		}
 	}
 	for (AiclkArbMax i = 0; i < kAiclkArbMaxCount; i++) {
 		if (aiclk_ppm.arbiter_max[i] < targ_freq) {
 			targ_freq = aiclk_ppm.arbiter_max[i];
+			aiclk_ppm.arb_max_winner = i;
 		}
 	}
 
@@ -128,29 +136,21 @@ float GetThrottlerArbMax(AiclkArbMax arb_max)
 	return aiclk_ppm.arbiter_max[arb_max];
 }
 
-/* TODO: Write a Zephyr unit test for this function */
+void GetAiclkDecision(AiclkDecision *decision)
+{
+	decision->targ_freq = aiclk_ppm.targ_freq;
+	decision->curr_freq = aiclk_ppm.curr_freq;
+	decision->arb_min = aiclk_ppm.arb_min_winner;
+	decision->arb_max = aiclk_ppm.arb_max_winner;
+	decision->forced = aiclk_ppm.forced_freq != 0;
+	decision->sweep = aiclk_ppm.sweep_en == 1;
+}
+
 uint32_t GetMaxAiclkForVoltage(uint32_t voltage)
 {
-	/* Assume monotonically increasing relationship between frequency and voltage */
-	/* and conduct binary search. */
 	/* Note this function doesn't work if you would need lower than fmin to achieve the voltage
 	 */
-
-	/* starting high_freq at fmax + 1 solves the case where the Max AICLK is fmax */
-	uint32_t high_freq = aiclk_ppm.fmax + 1;
-	uint32_t low_freq = aiclk_ppm.fmin;
-
-	while (low_freq < high_freq) {
-		uint32_t mid_freq = (low_freq + high_freq) / 2;
-
-		if (VFCurve(mid_freq) > voltage) {
-			high_freq = mid_freq;
-		} else {
-			low_freq = mid_freq + 1;
-		}
-	}
-
-	return low_freq - 1;
+	return VFCurveMaxFreq(voltage, aiclk_ppm.fmin, aiclk_ppm.fmax);
 }
 
 void InitArbMaxVoltage(void)
@@ -239,6 +239,8 @@ void aiclk_set_busy(bool is_busy)
  */
 static uint8_t aiclk_busy_handler(const union request *request, struct response *response)
 {
+	/* The work that follows was not announced, so the workload model must not learn from it */
+	ThrottlerWorkloadHint(0);
 	aiclk_set_busy(request->aiclk_set_speed.command_code == TT_SMC_MSG_AICLK_GO_BUSY);
 	return 0;
 }
@@ -267,6 +269,29 @@ static uint8_t get_aiclk_handler(const union request *request, struct response *
 	return 0;
 }
 
+/** @brief Handles the request to announce the intensity of upcoming work
+ * @param[in] request The request, of type @ref aiclk_workload_hint_rqst
+ * @param[out] response data[1]: the AICLK limit in MHz set by the throttlers ahead of the work
+ * @return 0 for success, 1 for an intensity above 100
+ */
+static uint8_t aiclk_workload_hint_handler(const union request *request,
+					   struct response *response)
+{
+	uint8_t intensity = request->aiclk_workload_hint.intensity;
+
+	if (intensity > 100) {
+		return 1;
+	}
+
+	/* The throttler limits are lowered in the DVFS update that raises AICLK, before its target
+	 * is calculated, so that AICLK never overshoots them
+	 */
+	response->data[1] = ThrottlerWorkloadHint(intensity / 100.0F);
+	aiclk_set_busy(intensity != 0);
+
+	return 0;
+}
+
 static uint8_t SweepAiclkHandler(const union request *request, struct response *response)
 {
 	if (request->command_code == TT_SMC_MSG_AISWEEP_START) {
@@ -284,6 +309,7 @@ static uint8_t SweepAiclkHandler(const union request *request, struct response *
 
 REGISTER_MESSAGE(TT_SMC_MSG_AICLK_GO_BUSY, aiclk_busy_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_AICLK_GO_LONG_IDLE, aiclk_busy_handler);
+REGISTER_MESSAGE(TT_SMC_MSG_AICLK_WORKLOAD_HINT, aiclk_workload_hint_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_FORCE_AICLK, ForceAiclkHandler);
 REGISTER_MESSAGE(TT_SMC_MSG_GET_AICLK, get_aiclk_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_AISWEEP_START, SweepAiclkHandler);
@@ -27,6 +27,16 @@ typedef enum {
 	kAiclkArbMinCount,
 } AiclkArbMin;
 
+/* Outcome of the last CalculateTargAiclk() and AICLK change */
+typedef struct {
+	uint32_t targ_freq; /* in MHz */
+	uint32_t curr_freq; /* in MHz */
+	int8_t arb_min;     /* AiclkArbMin that raised the target above fmin, -1 if none */
+	int8_t arb_max;     /* AiclkArbMax that limited the target, -1 if none */
+	bool forced;        /* target was overridden by ForceAiclk() */
+	bool sweep;         /* target was overridden by the frequency sweep */
+} AiclkDecision;
+
 void aiclk_set_busy(bool is_busy);
 void SetAiclkArbMax(AiclkArbMax arb_max, float freq);
 void SetAiclkArbMin(AiclkArbMin arb_min, float freq);
@@ -35,6 +45,7 @@ void DecreaseAiclk(void);
 void IncreaseAiclk(void);
 void InitArbMaxVoltage(void);
 float GetThrottlerArbMax(AiclkArbMax arb_max);
+void GetAiclkDecision(AiclkDecision *decision);
 uint8_t ForceAiclk(uint32_t freq);
 uint32_t GetAiclkTarg(void);
 uint32_t GetMaxAiclkForVoltage(uint32_t voltage);
@@ -18,6 +18,7 @@
 #define ARC_AUX_TIMER_0_LIMIT   (0x23)
 
 #define ARC_CSM_START_ADDR  (0x10000000)
+#define ARC_CSM_SIZE        (0x80000)
 #define ARC_ICCM_START_ADDR (0x00000000)
 
 #define ARC_AUX_INT_VECTOR_BASE (0x25)
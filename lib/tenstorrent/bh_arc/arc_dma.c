@@ -6,10 +6,57 @@
 
 #include "arc_dma.h"
 #include "arc.h"
+#include "dma_queue.h"
 #include "timer.h"
 
+#include <string.h>
+
 #include <tenstorrent/sys_init_defines.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/dma.h>
 #include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#define ARC_DMA_NUM_CHANNELS DT_PROP_OR(DT_NODELABEL(dma0), dma_channels, 1)
+#define ARC_DMA_TIMEOUT      K_MSEC(100)
+
+#if DT_NODE_HAS_STATUS_OKAY(DT_NODELABEL(dma0))
+BUILD_ASSERT(CONFIG_TT_BH_ARC_DMA_MAX_COPIES <=
+		     DT_PROP(DT_NODELABEL(dma0), dma_descriptors) / ARC_DMA_NUM_CHANNELS,
+	     "each copy of a request takes a descriptor of its channel");
+#endif
+BUILD_ASSERT(ARC_DMA_NUM_CHANNELS <= 32);
+
+static const struct device *const arc_dma = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(dma0));
+
+struct arc_dma_request {
+	struct arc_dma_copy copies[CONFIG_TT_BH_ARC_DMA_MAX_COPIES];
+	uint32_t num_copies;
+	arc_dma_callback_t callback;
+	void *user_data;
+};
+
+struct arc_dma_channel {
+	struct arc_dma_request request;
+	struct dma_block_config blocks[CONFIG_TT_BH_ARC_DMA_MAX_COPIES];
+	k_timepoint_t timeout;
+	/* Nonzero when the request failed to start, it is then completed by the next poll */
+	int status;
+	bool busy;
+};
+
+static struct arc_dma_channel channels[ARC_DMA_NUM_CHANNELS];
+
+/* Requests waiting for a free channel */
+K_MSGQ_DEFINE(arc_dma_pending, sizeof(struct arc_dma_request), CONFIG_TT_BH_ARC_DMA_QUEUE_DEPTH,
+	      4);
+
+/* The DMA done interrupt is not used, so busy channels are polled. The driver's completion
+ * callback polls them early.
+ */
+static struct dma_queue arc_dma_queue;
 
 void ArcDmaConfig(void)
 {
@@ -20,8 +67,13 @@ void ArcDmaConfig(void)
 	ArcWriteAux(DMA_S_CTRL_AUX, reg); /* Apply settings above */
 }
 
+/* The aux register helpers drive the channels directly, so they must not be used while the ARC DMA
+ * driver owns them.
+ */
 void ArcDmaInitCh(uint32_t dma_ch, uint32_t base, uint32_t last)
 {
+	__ASSERT(!device_is_ready(arc_dma), "ARC DMA channels are owned by %s", arc_dma->name);
+
 	ArcWriteAux(DMA_S_BASEC_AUX(dma_ch), base);
 	ArcWriteAux(DMA_S_LASTC_AUX(dma_ch), last);
 	ArcWriteAux(DMA_S_STATC_AUX(dma_ch), 0x1); /* Enable dma_ch */
@@ -29,6 +81,8 @@ void ArcDmaInitCh(uint32_t dma_ch, uint32_t base, uint32_t last)
 
 void ArcDmaStart(uint32_t dma_ch, const void *p_src, void *p_dst, uint32_t len, uint32_t attr)
 {
+	__ASSERT(!device_is_ready(arc_dma), "ARC DMA channels are owned by %s", arc_dma->name);
+
 	ArcWriteAux(DMA_C_CHAN_AUX, dma_ch);
 	ArcDmaNext(p_src, p_dst, len, attr);
 }
@@ -68,7 +122,8 @@ uint32_t ArcDmaGetDone(uint32_t handle)
 	return state;
 }
 
-bool ArcDmaTransfer(const void *src, void *dst, uint32_t size)
+/* Copy on channel 0 through the aux registers directly, for builds without the DMA driver */
+static bool arc_dma_transfer_polled(const void *src, void *dst, uint32_t size)
 {
 	const int32_t attr =
 		ARC_DMA_SET_DONE_ATTR | ARC_DMA_NP_ATTR; /* Set done with rising interrupt */
@@ -89,9 +144,222 @@ bool ArcDmaTransfer(const void *src, void *dst, uint32_t size)
 	return false;
 }
 
+static int alloc_channel(struct dma_queue *queue)
+{
+	for (uint32_t ch = 0; ch < ARC_DMA_NUM_CHANNELS; ch++) {
+		if (!channels[ch].busy) {
+			channels[ch].busy = true;
+			return ch;
+		}
+	}
+
+	return -EBUSY;
+}
+
+/* Called by the driver when it sees a channel complete, possibly with its locks held */
+static void arc_dma_driver_callback(const struct device *dev, void *user_data, uint32_t channel,
+				    int status)
+{
+	dma_queue_kick(&arc_dma_queue);
+}
+
+/* Queue the copies of a request as consecutive descriptors of the channel, which runs them in
+ * order. Failures are reported through the request's callback.
+ */
+static void start_request(struct dma_queue *queue, uint32_t ch, const void *req)
+{
+	const struct arc_dma_request *request = req;
+	struct arc_dma_channel *chan = &channels[ch];
+
+	chan->request = *request;
+	for (uint32_t i = 0; i < request->num_copies; i++) {
+		chan->blocks[i] = (struct dma_block_config){
+			.source_address = (uintptr_t)request->copies[i].src,
+			.dest_address = (uintptr_t)request->copies[i].dst,
+			.block_size = request->copies[i].len,
+			.next_block = i + 1 < request->num_copies ? &chan->blocks[i + 1] : NULL,
+		};
+	}
+
+	struct dma_config config = {
+		.channel_direction = MEMORY_TO_MEMORY,
+		.block_count = request->num_copies,
+		.head_block = &chan->blocks[0],
+		.dma_callback = arc_dma_driver_callback,
+	};
+
+	chan->status = dma_config(arc_dma, ch, &config);
+	if (chan->status == 0) {
+		chan->status = dma_start(arc_dma, ch);
+	}
+	chan->timeout = sys_timepoint_calc(ARC_DMA_TIMEOUT);
+}
+
+/* Complete finished requests, start waiting ones on the freed channels and run the callbacks.
+ * Returns true while requests are in flight.
+ */
+static bool arc_dma_poll(struct dma_queue *queue)
+{
+	struct {
+		arc_dma_callback_t callback;
+		void *user_data;
+		int status;
+	} done[ARC_DMA_NUM_CHANNELS];
+	uint32_t num_done = 0;
+	struct arc_dma_request request;
+	bool busy = false;
+
+	k_mutex_lock(&queue->lock, K_FOREVER);
+
+	for (uint32_t ch = 0; ch < ARC_DMA_NUM_CHANNELS; ch++) {
+		struct arc_dma_channel *chan = &channels[ch];
+		int status = chan->status;
+
+		if (!chan->busy) {
+			continue;
+		}
+
+		if (status == 0) {
+			struct dma_status dma_status;
+
+			status = dma_get_status(arc_dma, ch, &dma_status);
+			if (status == 0 && dma_status.busy) {
+				if (!sys_timepoint_expired(chan->timeout)) {
+					continue;
+				}
+				dma_stop(arc_dma, ch);
+				status = -ETIMEDOUT;
+			}
+		}
+
+		done[num_done].callback = chan->request.callback;
+		done[num_done].user_data = chan->request.user_data;
+		done[num_done].status = status;
+		num_done++;
+		chan->busy = false;
+	}
+
+	dma_queue_start_pending(queue, &request);
+
+	for (uint32_t ch = 0; ch < ARC_DMA_NUM_CHANNELS; ch++) {
+		busy |= channels[ch].busy;
+	}
+
+	k_mutex_unlock(&queue->lock);
+
+	/* Callbacks may submit more requests, so they run without the lock */
+	for (uint32_t i = 0; i < num_done; i++) {
+		if (done[i].callback != NULL) {
+			done[i].callback(done[i].user_data, done[i].status);
+		}
+	}
+
+	return busy;
+}
+
+/*
+ * Queue a request of up to CONFIG_TT_BH_ARC_DMA_MAX_COPIES copies, which run in order on one
+ * channel. Requests run concurrently on the channels of the ARC DMA, and wait in a queue of
+ * CONFIG_TT_BH_ARC_DMA_QUEUE_DEPTH requests while all channels are busy.
+ *
+ * The callback runs from the DMA work queue, or from a thread waiting in ArcDmaWait(). Without
+ * the ARC DMA driver the copies run before this returns.
+ *
+ * Returns 0 if the request was started or queued, -EINVAL for an invalid number of copies, or
+ * -EBUSY if the queue is full.
+ */
+int ArcDmaSubmit(const struct arc_dma_copy *copies, uint32_t num_copies,
+		 arc_dma_callback_t callback, void *user_data)
+{
+	struct arc_dma_request request = {
+		.num_copies = num_copies,
+		.callback = callback,
+		.user_data = user_data,
+	};
+
+	if (num_copies == 0 || num_copies > CONFIG_TT_BH_ARC_DMA_MAX_COPIES) {
+		return -EINVAL;
+	}
+
+	if (!device_is_ready(arc_dma)) {
+		int status = 0;
+
+		for (uint32_t i = 0; i < num_copies && status == 0; i++) {
+			if (!arc_dma_transfer_polled(copies[i].src, copies[i].dst, copies[i].len)) {
+				status = -EIO;
+			}
+		}
+
+		if (callback != NULL) {
+			callback(user_data, status);
+		}
+		return 0;
+	}
+
+	memcpy(request.copies, copies, num_copies * sizeof(*copies));
+
+	return dma_queue_submit(&arc_dma_queue, &request);
+}
+
+void ArcDmaWaiterInit(struct arc_dma_waiter *waiter)
+{
+	k_sem_init(&waiter->done, 0, 1);
+	waiter->status = 0;
+}
+
+/* Callback for ArcDmaSubmit() that completes the arc_dma_waiter passed as user_data */
+void ArcDmaWaiterCallback(void *user_data, int status)
+{
+	struct arc_dma_waiter *waiter = user_data;
+
+	waiter->status = status;
+	k_sem_give(&waiter->done);
+}
+
+/*
+ * Wait for a request submitted with ArcDmaWaiterCallback(). The thread sleeps until the poll
+ * completes the request, and only polls the channels itself if nothing completes it within the
+ * 100 ms request timeout. The waiter is in use until then, since the request still refers to it.
+ *
+ * Returns the status of the request.
+ */
+int ArcDmaWait(struct arc_dma_waiter *waiter)
+{
+	while (k_sem_take(&waiter->done, ARC_DMA_TIMEOUT) != 0) {
+		arc_dma_poll(&arc_dma_queue);
+	}
+
+	return waiter->status;
+}
+
+bool ArcDmaTransfer(const void *src, void *dst, uint32_t size)
+{
+	struct arc_dma_copy copy = {
+		.src = src,
+		.dst = dst,
+		.len = size,
+	};
+	struct arc_dma_waiter waiter;
+
+	if (!device_is_ready(arc_dma)) {
+		return arc_dma_transfer_polled(src, dst, size);
+	}
+
+	ArcDmaWaiterInit(&waiter);
+	if (ArcDmaSubmit(&copy, 1, ArcDmaWaiterCallback, &waiter) < 0) {
+		return false;
+	}
+
+	return ArcDmaWait(&waiter) == 0;
+}
+
 static int arc_dma_init(void)
 {
-	if (!IS_ENABLED(CONFIG_ARC)) {
+	dma_queue_init(&arc_dma_queue, &arc_dma_pending, alloc_channel, start_request,
+		       arc_dma_poll);
+
+	/* The ARC DMA driver owns the channels when it is enabled */
+	if (!IS_ENABLED(CONFIG_ARC) || device_is_ready(arc_dma)) {
 		return 0;
 	}
 
@@ -9,6 +9,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include <zephyr/kernel.h>
+
 #define DMA_AUX_BASE     (0xd00)
 #define DMA_C_CTRL_AUX   (0xd00 + 0x0)
 #define DMA_C_CHAN_AUX   (0xd00 + 0x1)
@@ -41,4 +43,26 @@ uint32_t ArcDmaPollBusy(void);
 void ArcDmaClearDone(uint32_t handle);
 uint32_t ArcDmaGetDone(uint32_t handle);
 bool ArcDmaTransfer(const void *src, void *dst, uint32_t size);
+
+/* One copy of a queued ARC DMA request */
+struct arc_dma_copy {
+	const void *src;
+	void *dst;
+	uint32_t len;
+};
+
+/* Called in thread context when a request completes, with 0 or a negative error code */
+typedef void (*arc_dma_callback_t)(void *user_data, int status);
+
+/* Completion of a request that a thread waits for with ArcDmaWait() */
+struct arc_dma_waiter {
+	struct k_sem done;
+	int status;
+};
+
+int ArcDmaSubmit(const struct arc_dma_copy *copies, uint32_t num_copies,
+		 arc_dma_callback_t callback, void *user_data);
+void ArcDmaWaiterInit(struct arc_dma_waiter *waiter);
+void ArcDmaWaiterCallback(void *user_data, int status);
+int ArcDmaWait(struct arc_dma_waiter *waiter);
 #endif
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "dma_queue.h"
+
+#include <tenstorrent/sys_init_defines.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#define DMA_WORK_Q_STACK_SIZE 1024
+
+/* Polls every DMA queue, so that the queues share one thread and never delay the system work
+ * queue.
+ */
+static K_THREAD_STACK_DEFINE(dma_work_q_stack, DMA_WORK_Q_STACK_SIZE);
+static struct k_work_q dma_work_q;
+
+static void dma_queue_poll_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct dma_queue *queue = CONTAINER_OF(dwork, struct dma_queue, poll_work);
+
+	if (queue->poll(queue)) {
+		k_work_schedule_for_queue(&dma_work_q, &queue->poll_work, K_TICKS(1));
+	}
+}
+
+void dma_queue_init(struct dma_queue *queue, struct k_msgq *pending,
+		    int (*alloc_channel)(struct dma_queue *queue),
+		    void (*start)(struct dma_queue *queue, uint32_t ch, const void *request),
+		    bool (*poll)(struct dma_queue *queue))
+{
+	queue->pending = pending;
+	queue->alloc_channel = alloc_channel;
+	queue->start = start;
+	queue->poll = poll;
+	k_mutex_init(&queue->lock);
+	k_work_init_delayable(&queue->poll_work, dma_queue_poll_handler);
+}
+
+/*
+ * Start a request on a free channel, or queue it until the poll finds one. Requests are started
+ * in the order they are submitted.
+ *
+ * Returns 0 if the request was started or queued, or -EBUSY if the pending queue is full.
+ */
+int dma_queue_submit(struct dma_queue *queue, const void *request)
+{
+	int rc = 0;
+
+	k_mutex_lock(&queue->lock, K_FOREVER);
+
+	/* Keep requests in order behind ones that are already waiting */
+	int ch = k_msgq_num_used_get(queue->pending) == 0 ? queue->alloc_channel(queue) : -EBUSY;
+
+	if (ch >= 0) {
+		queue->start(queue, ch, request);
+	} else if (k_msgq_put(queue->pending, request, K_NO_WAIT) != 0) {
+		rc = -EBUSY;
+	}
+
+	k_mutex_unlock(&queue->lock);
+
+	if (rc == 0) {
+		k_work_schedule_for_queue(&dma_work_q, &queue->poll_work, K_TICKS(1));
+	}
+
+	return rc;
+}
+
+/*
+ * Start waiting requests on the free channels, in order. Called with the queue locked, usually
+ * from the poll callback. request is scratch space for one pending request.
+ *
+ * Returns true while requests are still waiting.
+ */
+bool dma_queue_start_pending(struct dma_queue *queue, void *request)
+{
+	while (k_msgq_peek(queue->pending, request) == 0) {
+		int ch = queue->alloc_channel(queue);
+
+		if (ch < 0) {
+			return true;
+		}
+
+		k_msgq_get(queue->pending, request, K_NO_WAIT);
+		queue->start(queue, ch, request);
+	}
+
+	return false;
+}
+
+/* Poll the queue as soon as possible, e.g. from a completion callback */
+void dma_queue_kick(struct dma_queue *queue)
+{
+	k_work_reschedule_for_queue(&dma_work_q, &queue->poll_work, K_NO_WAIT);
+}
+
+static int dma_work_q_init(void)
+{
+	const struct k_work_queue_config cfg = {.name = "dma"};
+
+	k_work_queue_start(&dma_work_q, dma_work_q_stack, K_THREAD_STACK_SIZEOF(dma_work_q_stack),
+			   CONFIG_SYSTEM_WORKQUEUE_PRIORITY, &cfg);
+	return 0;
+}
+SYS_INIT_APP(dma_work_q_init);
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef DMA_QUEUE_H
+#define DMA_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+
+/* Requests for a set of DMA channels that wait in order while every channel is busy.
+ *
+ * Channel completion is polled from the shared DMA work queue. Delayable work can't wait less
+ * than a system tick, so the poll runs once per tick (1 ms on the SMC) while requests are in
+ * flight, unless the owner reschedules it earlier with dma_queue_kick().
+ */
+struct dma_queue {
+	/* Requests waiting for a free channel */
+	struct k_msgq *pending;
+	/* Serializes submission with the poll. Owners also take it around their channel state. */
+	struct k_mutex lock;
+	struct k_work_delayable poll_work;
+	/* Returns a free channel and marks it busy, or -EBUSY */
+	int (*alloc_channel)(struct dma_queue *queue);
+	/* Starts a request on a channel returned by alloc_channel */
+	void (*start)(struct dma_queue *queue, uint32_t ch, const void *request);
+	/* Called by the poll. Returns true while the queue needs to be polled again. */
+	bool (*poll)(struct dma_queue *queue);
+};
+
+void dma_queue_init(struct dma_queue *queue, struct k_msgq *pending,
+		    int (*alloc_channel)(struct dma_queue *queue),
+		    void (*start)(struct dma_queue *queue, uint32_t ch, const void *request),
+		    bool (*poll)(struct dma_queue *queue));
+int dma_queue_submit(struct dma_queue *queue, const void *request);
+bool dma_queue_start_pending(struct dma_queue *queue, void *request);
+void dma_queue_kick(struct dma_queue *queue);
+
+#endif
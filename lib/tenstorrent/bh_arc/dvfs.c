@@ -9,11 +9,14 @@
 #include "throttler.h"
 #include "aiclk_ppm.h"
 #include "voltage.h"
+#include "dvfs_trace.h"
 
 bool dvfs_enabled;
 
 void DVFSChange(void)
 {
+	uint64_t trace_begin = dvfs_trace_begin();
+
 	CalculateThrottlers();
 	CalculateTargAiclk();
 
@@ -27,6 +30,8 @@ void DVFSChange(void)
 	DecreaseAiclk();
 	VoltageChange();
 	IncreaseAiclk();
+
+	dvfs_trace_end(trace_begin);
 }
 
 static void dvfs_work_handler(struct k_work *work)
@@ -47,6 +52,7 @@ void InitDVFS(void)
 	InitVoltagePPM();
 	InitArbMaxVoltage();
 	InitThrottlers();
+	dvfs_trace_init();
 	dvfs_enabled = true;
 }
 
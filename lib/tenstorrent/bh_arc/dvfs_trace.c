@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "aiclk_ppm.h"
+#include "dvfs_trace.h"
+#include "reg.h"
+#include "status_reg.h"
+#include "throttler.h"
+#include "timer.h"
+#include "voltage.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+/* "DVFT" */
+#define DVFS_TRACE_MAGIC   0x54465644
+#define DVFS_TRACE_VERSION 1
+
+#define DVFS_TRACE_RESET_FLAG BIT(0)
+
+#define DVFS_TRACE_FLAG_FORCED_FREQ    BIT(0)
+#define DVFS_TRACE_FLAG_SWEEP          BIT(1)
+#define DVFS_TRACE_FLAG_FORCED_VOLTAGE BIT(2)
+
+/* Throttler values are stored in 1/16 units, errors and outputs in 1/16384 units */
+#define DVFS_TRACE_VALUE_SCALE 16.0F
+#define DVFS_TRACE_ERROR_SCALE 16384.0F
+
+struct dvfs_trace_throttler {
+	uint16_t value;
+	int16_t error;
+	int16_t output;
+};
+
+/* One DVFS update. Frequencies are in MHz, voltages in mV. */
+struct dvfs_trace_record {
+	/* Low word of the refclk timestamp (see TimerTimestamp) at the start of the update */
+	uint32_t timestamp;
+	/* Duration of the update in refclk cycles */
+	uint32_t duration;
+	uint16_t targ_freq;
+	uint16_t curr_freq;
+	uint16_t targ_voltage;
+	uint16_t curr_voltage;
+	/* Winning AiclkArbMin and AiclkArbMax, -1 if none */
+	int8_t arb_min;
+	int8_t arb_max;
+	/* DVFS_TRACE_FLAG_* */
+	uint8_t flags;
+	uint8_t reserved;
+	/* Filtered value, error and output of each throttler, by ThrottlerId */
+	struct dvfs_trace_throttler throttlers[kThrottlerCount];
+};
+
+/**
+ * @brief Header of the DVFS trace ring buffer.
+ *
+ * The address of the header is published in @ref DVFS_TRACE_REG_ADDR. Record n is at
+ * records[n % capacity], and is complete once @ref head is past it. The host sets @ref frozen to
+ * stop recording while it reads the ring, so that the oldest records are not overwritten.
+ */
+struct dvfs_trace_header {
+	/** @brief DVFS_TRACE_MAGIC, "DVFT" */
+	uint32_t magic;
+	/** @brief Layout version of this header and the records */
+	uint32_t version;
+	/** @brief Size of each record in bytes */
+	uint32_t record_size;
+	/** @brief Number of records in the ring */
+	uint32_t capacity;
+	/** @brief Number of throttlers in each record */
+	uint32_t num_throttlers;
+	/** @brief Number of records written since the trace was reset, written by firmware */
+	volatile uint32_t head;
+	/** @brief Nonzero to stop recording, written by host */
+	volatile uint32_t frozen;
+};
+
+static struct {
+	struct dvfs_trace_header header;
+	struct dvfs_trace_record records[CONFIG_TT_BH_ARC_DVFS_TRACE_ENTRIES];
+} dvfs_trace;
+
+/* Set by the message handler, and consumed by dvfs_trace_end() so that only it writes head */
+static atomic_t reset_requested;
+
+static int16_t to_fixed(float value, float scale)
+{
+	return CLAMP(value * scale, INT16_MIN, INT16_MAX);
+}
+
+void dvfs_trace_init(void)
+{
+	struct dvfs_trace_header *header = &dvfs_trace.header;
+
+	header->magic = DVFS_TRACE_MAGIC;
+	header->version = DVFS_TRACE_VERSION;
+	header->record_size = sizeof(struct dvfs_trace_record);
+	header->capacity = ARRAY_SIZE(dvfs_trace.records);
+	header->num_throttlers = kThrottlerCount;
+	header->head = 0;
+	header->frozen = 0;
+	atomic_clear(&reset_requested);
+
+	WriteReg(DVFS_TRACE_REG_ADDR, (uint32_t)header);
+}
+
+uint64_t dvfs_trace_begin(void)
+{
+	return TimerTimestamp();
+}
+
+/* Called at the end of each DVFS update */
+void dvfs_trace_end(uint64_t begin)
+{
+	struct dvfs_trace_header *header = &dvfs_trace.header;
+	uint32_t head = header->head;
+
+	if (atomic_clear(&reset_requested)) {
+		head = 0;
+		header->head = 0;
+	}
+
+	if (header->frozen) {
+		return;
+	}
+
+	struct dvfs_trace_record *record = &dvfs_trace.records[head % header->capacity];
+	AiclkDecision decision;
+
+	GetAiclkDecision(&decision);
+
+	record->timestamp = (uint32_t)begin;
+	record->duration = MIN(TimerTimestamp() - begin, UINT32_MAX);
+	record->targ_freq = decision.targ_freq;
+	record->curr_freq = decision.curr_freq;
+	record->targ_voltage = voltage_arbiter.targ_voltage;
+	record->curr_voltage = voltage_arbiter.curr_voltage;
+	record->arb_min = decision.arb_min;
+	record->arb_max = decision.arb_max;
+	record->flags = (decision.forced ? DVFS_TRACE_FLAG_FORCED_FREQ : 0) |
+			(decision.sweep ? DVFS_TRACE_FLAG_SWEEP : 0) |
+			(voltage_arbiter.forced_voltage != 0 ? DVFS_TRACE_FLAG_FORCED_VOLTAGE : 0);
+	record->reserved = 0;
+
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		float value, error, output;
+
+		GetThrottlerState(i, &value, &error, &output);
+		record->throttlers[i].value = CLAMP(value * DVFS_TRACE_VALUE_SCALE, 0, UINT16_MAX);
+		record->throttlers[i].error = to_fixed(error, DVFS_TRACE_ERROR_SCALE);
+		record->throttlers[i].output = to_fixed(output, DVFS_TRACE_ERROR_SCALE);
+	}
+
+	atomic_thread_fence(memory_order_seq_cst);
+	header->head = head + 1;
+}
+
+/** @brief Handles the request to export the DVFS trace
+ * @param[in] request The request, of type @ref dvfs_trace_rqst
+ * @param[out] response data[1]: address of the trace header, data[2]: number of records written
+ *	so far. A reset takes effect at the next DVFS update.
+ * @return 0 for success
+ */
+static uint8_t dvfs_trace_handler(const union request *request, struct response *response)
+{
+	const struct dvfs_trace_rqst *rqst = &request->dvfs_trace;
+
+	response->data[1] = (uint32_t)&dvfs_trace.header;
+	response->data[2] = dvfs_trace.header.head;
+
+	if (rqst->flags & DVFS_TRACE_RESET_FLAG) {
+		atomic_set(&reset_requested, 1);
+	}
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_DVFS_TRACE, dvfs_trace_handler);
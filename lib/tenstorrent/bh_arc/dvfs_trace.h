@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef DVFS_TRACE_H
+#define DVFS_TRACE_H
+
+#include <stdint.h>
+
+#ifdef CONFIG_TT_BH_ARC_DVFS_TRACE
+void dvfs_trace_init(void);
+uint64_t dvfs_trace_begin(void);
+void dvfs_trace_end(uint64_t begin);
+#else
+static inline void dvfs_trace_init(void)
+{
+}
+
+static inline uint64_t dvfs_trace_begin(void)
+{
+	return 0;
+}
+
+static inline void dvfs_trace_end(uint64_t begin)
+{
+}
+#endif
+
+#endif
@@ -6,6 +6,7 @@
 
 #include "functional_efuse.h"
 #include "eth.h"
+#include "fw_image_cache.h"
 #include "harvesting.h"
 #include "init.h"
 #include "noc.h"
@@ -49,6 +50,9 @@ static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtab
 static const struct device *flash = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(spi_flash));
 static const struct device *dma_noc = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(dma1));
 
+#define NOC_DMA_NUM_CHANNELS DT_PROP(DT_NODELABEL(dma1), dma_channels)
+#define NOC_DMA_WAIT_TIMEOUT K_MSEC(100)
+
 typedef struct {
 	uint32_t sd_mode_sel_0: 1;
 	uint32_t sd_mode_sel_1: 1;
@@ -213,7 +217,7 @@ int LoadEthFw(uint32_t eth_inst, uint32_t ring, uint8_t *buf, size_t buf_size, s
 	volatile uint32_t *eth_tlb = GetTlbWindowAddr(ring, ETH_SETUP_TLB, fw_load_addr);
 
 	if (spi_arc_dma_transfer_to_tile(flash, spi_address, image_size, buf, buf_size,
-					 (uint8_t *)eth_tlb)) {
+					 (uint8_t *)eth_tlb, NULL)) {
 		return -1;
 	}
 
@@ -238,9 +242,9 @@ int LoadEthFwCfg(uint32_t eth_inst, uint32_t ring, uint8_t *buf, uint32_t eth_en
 {
 	int rc;
 
-	rc = flash_read(flash, spi_address, buf, image_size);
+	rc = fw_image_cache_read(spi_address, buf, image_size);
 	if (rc < 0) {
-		LOG_ERR("%s() failed: %d", "flash_read", rc);
+		LOG_ERR("%s() failed: %d", "fw_image_cache_read", rc);
 		return rc;
 	}
 
@@ -321,9 +325,9 @@ static void SerdesEthInit(void)
 
 	uint8_t buf[SCRATCHPAD_SIZE] __aligned(4);
 
-	rc = tt_boot_fs_find_fd_by_tag(flash, ETH_SD_REG_TAG, &tag_fd);
+	rc = fw_image_cache_load(ETH_SD_REG_TAG, &tag_fd);
 	if (rc < 0) {
-		LOG_ERR("%s(%s) failed: %d", "tt_boot_fs_find_fd_by_tag", ETH_SD_REG_TAG, rc);
+		LOG_ERR("%s(%s) failed: %d", "fw_image_cache_load", ETH_SD_REG_TAG, rc);
 	}
 	image_size = tag_fd.flags.f.image_size;
 	spi_address = tag_fd.spi_addr;
@@ -331,14 +335,17 @@ static void SerdesEthInit(void)
 	/* Load fw regs */
 	for (uint8_t serdes_inst = 0; serdes_inst < 6; serdes_inst++) {
 		if (load_serdes & (1 << serdes_inst)) {
-			LoadSerdesEthRegs(serdes_inst, ring, buf, SCRATCHPAD_SIZE, spi_address,
-					  image_size);
+			rc = LoadSerdesEthRegs(serdes_inst, ring, buf, SCRATCHPAD_SIZE,
+					       spi_address, image_size, tag_fd.data_crc);
+			if (rc < 0) {
+				LOG_ERR("%s(%d) failed: %d", "LoadSerdesEthRegs", serdes_inst, rc);
+			}
 		}
 	}
 
-	rc = tt_boot_fs_find_fd_by_tag(flash, ETH_SD_FW_TAG, &tag_fd);
+	rc = fw_image_cache_load(ETH_SD_FW_TAG, &tag_fd);
 	if (rc < 0) {
-		LOG_ERR("%s(%s) failed: %d", "tt_boot_fs_find_fd_by_tag", ETH_SD_FW_TAG, rc);
+		LOG_ERR("%s(%s) failed: %d", "fw_image_cache_load", ETH_SD_FW_TAG, rc);
 		return;
 	}
 	image_size = tag_fd.flags.f.image_size;
@@ -382,6 +389,9 @@ static void wipe_l1(void)
 		.user_data = &coords,
 	};
 
+	/* Spread the wipes over the DMA channels so that they run in parallel */
+	uint32_t channel = 0;
+
 	for (uint8_t eth_inst = 0; eth_inst < MAX_ETH_INSTANCES; eth_inst++) {
 		if (tile_enable.eth_enabled & BIT(eth_inst)) {
 			uint8_t x, y;
@@ -391,10 +401,25 @@ static void wipe_l1(void)
 			coords.dest_x = x;
 			coords.dest_y = y;
 
-			dma_config(dma_noc, 1, &config);
-			dma_start(dma_noc, 1);
+			int rc = tt_bh_dma_noc_wait_channel(dma_noc, channel,
+							    NOC_DMA_WAIT_TIMEOUT);
+
+			if (rc == 0) {
+				rc = dma_config(dma_noc, channel, &config);
+			}
+			if (rc == 0) {
+				rc = dma_start(dma_noc, channel);
+			}
+			if (rc != 0) {
+				LOG_ERR("%s(%d) failed: %d", "wipe_l1", eth_inst, rc);
+			}
+			channel = (channel + 1) % NOC_DMA_NUM_CHANNELS;
 		}
 	}
+
+	if (tt_bh_dma_noc_wait_idle(dma_noc, NOC_DMA_NUM_CHANNELS, NOC_DMA_WAIT_TIMEOUT) != 0) {
+		LOG_ERR("%s() failed: %d", "tt_bh_dma_noc_wait_idle", -ETIMEDOUT);
+	}
 }
 
 static void EthInit(void)
@@ -414,9 +439,9 @@ static void EthInit(void)
 
 	uint8_t buf[SCRATCHPAD_SIZE] __aligned(4);
 
-	rc = tt_boot_fs_find_fd_by_tag(flash, ETH_FW_TAG, &tag_fd);
+	rc = fw_image_cache_load(ETH_FW_TAG, &tag_fd);
 	if (rc < 0) {
-		LOG_ERR("%s(%s) failed: %d", "tt_boot_fs_find_fd_by_tag", ETH_FW_TAG, rc);
+		LOG_ERR("%s(%s) failed: %d", "fw_image_cache_load", ETH_FW_TAG, rc);
 		return;
 	}
 	image_size = tag_fd.flags.f.image_size;
@@ -429,9 +454,9 @@ static void EthInit(void)
 		}
 	}
 
-	rc = tt_boot_fs_find_fd_by_tag(flash, ETH_FW_CFG_TAG, &tag_fd);
+	rc = fw_image_cache_load(ETH_FW_CFG_TAG, &tag_fd);
 	if (rc < 0) {
-		LOG_ERR("%s(%s) failed: %d", "tt_boot_fs_find_fd_by_tag", ETH_FW_CFG_TAG, rc);
+		LOG_ERR("%s(%s) failed: %d", "fw_image_cache_load", ETH_FW_CFG_TAG, rc);
 		return;
 	}
 	image_size = tag_fd.flags.f.image_size;
@@ -460,8 +485,11 @@ static int eth_init(void)
 		return 0;
 	}
 
+	/* Each loader has the whole image cache to itself */
 	SerdesEthInit();
+	fw_image_cache_release();
 	EthInit();
+	fw_image_cache_release();
 
 	return 0;
 }
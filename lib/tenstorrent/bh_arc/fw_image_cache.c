@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "fw_image_cache.h"
+
+#include <string.h>
+
+#include <tenstorrent/tt_boot_fs.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_REGISTER(fw_image_cache, CONFIG_TT_APP_LOG_LEVEL);
+
+struct resident_image {
+	uint32_t spi_addr;
+	uint32_t size;
+	const uint8_t *data;
+};
+
+static const struct device *const flash = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(spi_flash));
+
+/* The pool is only used while the tile FW is loaded at boot. When the application runs under
+ * MCUBoot, it is placed in the CSM that MCUBoot ran from, which nothing uses once the application
+ * has started. Without MCUBoot all of CSM belongs to the application, so it is a static array.
+ */
+#if DT_NODE_EXISTS(DT_NODELABEL(csm_bootloader))
+BUILD_ASSERT(CONFIG_TT_BH_ARC_FW_IMAGE_CACHE_SIZE <= DT_REG_SIZE(DT_NODELABEL(csm_bootloader)),
+	     "FW image cache does not fit in the MCUBoot CSM region");
+static uint8_t *const pool = (uint8_t *)DT_REG_ADDR(DT_NODELABEL(csm_bootloader));
+#else
+static uint8_t pool[CONFIG_TT_BH_ARC_FW_IMAGE_CACHE_SIZE] __aligned(4) __noinit;
+#endif
+static size_t pool_used;
+static struct resident_image images[CONFIG_TT_BOOT_FS_IMAGE_COUNT_MAX];
+static size_t num_images;
+/* Pointers into pool handed out by fw_image_cache_get() and not yet released */
+static size_t num_users;
+
+static K_MUTEX_DEFINE(cache_lock);
+static K_CONDVAR_DEFINE(cache_idle);
+
+static const struct resident_image *find_resident(size_t spi_address, size_t size)
+{
+	for (size_t i = 0; i < num_images; i++) {
+		if (spi_address >= images[i].spi_addr &&
+		    spi_address + size <= images[i].spi_addr + images[i].size) {
+			return &images[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Find a file descriptor by tag in the boot filesystem on the SPI flash
+ *
+ * @retval 0 on success, otherwise the error from tt_boot_fs_find_fd_by_tag()
+ */
+int fw_image_cache_find(const char *tag, tt_boot_fs_fd *fd)
+{
+	return tt_boot_fs_find_fd_by_tag(flash, tag, fd);
+}
+
+static void make_resident(const tt_boot_fs_fd *fd)
+{
+	size_t image_size = fd->flags.f.image_size;
+	/* Images larger than the free space keep their start resident, the rest is read from
+	 * flash
+	 */
+	size_t size = MIN(image_size,
+			  ROUND_DOWN(CONFIG_TT_BH_ARC_FW_IMAGE_CACHE_SIZE - pool_used,
+				     sizeof(uint32_t)));
+
+	if (find_resident(fd->spi_addr, size) != NULL) {
+		return;
+	}
+
+	if (size == 0 || num_images == ARRAY_SIZE(images)) {
+		LOG_DBG("%.8s not cached, %zu bytes", fd->image_tag, image_size);
+		return;
+	}
+
+	if (size < image_size) {
+		LOG_DBG("%.8s partly cached, %zu of %zu bytes", fd->image_tag, size, image_size);
+	}
+
+	/* Not fatal if this fails, reads of the image then go to flash */
+	if (flash_read(flash, fd->spi_addr, &pool[pool_used], size) < 0) {
+		return;
+	}
+
+	images[num_images++] = (struct resident_image){
+		.spi_addr = fd->spi_addr,
+		.size = size,
+		.data = &pool[pool_used],
+	};
+	pool_used += ROUND_UP(size, sizeof(uint32_t));
+}
+
+/**
+ * @brief Find a file descriptor by tag, and keep the image resident in RAM
+ *
+ * Images that do not fit in the remaining cache space are still found. As much of the start of
+ * the image as fits is kept resident, and reads of the rest go to flash.
+ *
+ * @retval 0 on success, otherwise the error from fw_image_cache_find()
+ */
+int fw_image_cache_load(const char *tag, tt_boot_fs_fd *fd)
+{
+	int ret = fw_image_cache_find(tag, fd);
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+	make_resident(fd);
+	k_mutex_unlock(&cache_lock);
+
+	return 0;
+}
+
+/**
+ * @brief Get the resident copy of a flash range
+ *
+ * The resident images are kept until every pointer returned by this function has been released
+ * with fw_image_cache_put().
+ *
+ * @return Pointer to the data at @p spi_address, or NULL if the range is not resident
+ */
+const uint8_t *fw_image_cache_get(size_t spi_address, size_t size)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	const struct resident_image *image = find_resident(spi_address, size);
+	const uint8_t *data = image ? image->data + (spi_address - image->spi_addr) : NULL;
+
+	if (data != NULL) {
+		num_users++;
+	}
+
+	k_mutex_unlock(&cache_lock);
+
+	return data;
+}
+
+/**
+ * @brief Release a pointer returned by fw_image_cache_get()
+ */
+void fw_image_cache_put(void)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	__ASSERT(num_users > 0, "unbalanced %s()", __func__);
+	if (--num_users == 0) {
+		k_condvar_broadcast(&cache_idle);
+	}
+
+	k_mutex_unlock(&cache_lock);
+}
+
+/**
+ * @brief Copy a flash range from its resident copy
+ *
+ * @retval true if the range was resident and has been copied to @p buf
+ */
+bool fw_image_cache_copy(size_t spi_address, uint8_t *buf, size_t size)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	const struct resident_image *image = find_resident(spi_address, size);
+
+	if (image != NULL) {
+		memcpy(buf, image->data + (spi_address - image->spi_addr), size);
+	}
+
+	k_mutex_unlock(&cache_lock);
+
+	return image != NULL;
+}
+
+/**
+ * @brief Read a flash range, from the resident copy if there is one
+ *
+ * @return 0 on success, or the error from flash_read()
+ */
+int fw_image_cache_read(size_t spi_address, uint8_t *buf, size_t size)
+{
+	if (fw_image_cache_copy(spi_address, buf, size)) {
+		return 0;
+	}
+
+	return flash_read(flash, spi_address, buf, size);
+}
+
+/**
+ * @brief Drop all resident images, once the loaders that use them are done
+ *
+ * The pool is then free for the images of the next loader, and is left unused after the last
+ * one. Waits until no pointer returned by fw_image_cache_get() is in use.
+ */
+void fw_image_cache_release(void)
+{
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	while (num_users > 0) {
+		k_condvar_wait(&cache_idle, &cache_lock, K_FOREVER);
+	}
+
+	num_images = 0;
+	pool_used = 0;
+
+	k_mutex_unlock(&cache_lock);
+}
+
+/**
+ * @brief Drop the directory and all resident images, e.g. after the flash has been written
+ *
+ * Waits until no pointer returned by fw_image_cache_get() is in use.
+ */
+void fw_image_cache_invalidate(void)
+{
+	tt_boot_fs_invalidate(flash);
+	fw_image_cache_release();
+}
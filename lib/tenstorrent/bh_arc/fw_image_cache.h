@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FW_IMAGE_CACHE_H
+#define FW_IMAGE_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <tenstorrent/tt_boot_fs.h>
+
+/* Boot time cache of the SPI flash boot filesystem, used by the tile FW loaders.
+ *
+ * File descriptors are looked up through the tt_boot_fs directory index. Images that are loaded
+ * into many tiles can be made resident in RAM with fw_image_cache_load(), after which reads of
+ * that image through fw_image_cache_read() and spi_flash_buf.h are served from RAM instead of
+ * flash. Loaders release the resident images with fw_image_cache_release() when they are done.
+ */
+
+int fw_image_cache_find(const char *tag, tt_boot_fs_fd *fd);
+int fw_image_cache_load(const char *tag, tt_boot_fs_fd *fd);
+const uint8_t *fw_image_cache_get(size_t spi_address, size_t size);
+void fw_image_cache_put(void);
+bool fw_image_cache_copy(size_t spi_address, uint8_t *buf, size_t size);
+int fw_image_cache_read(size_t spi_address, uint8_t *buf, size_t size);
+void fw_image_cache_release(void);
+void fw_image_cache_invalidate(void);
+
+#endif
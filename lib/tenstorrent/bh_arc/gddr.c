@@ -5,6 +5,7 @@
  */
 
 #include "arc_dma.h"
+#include "fw_image_cache.h"
 #include "gddr.h"
 #include "harvesting.h"
 #include "init.h"
@@ -32,6 +33,9 @@ static const struct device *const pll_dev_3 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL
 static const struct device *flash = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(spi_flash));
 static const struct device *dma_noc = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(dma1));
 
+#define NOC_DMA_NUM_CHANNELS DT_PROP(DT_NODELABEL(dma1), dma_channels)
+#define NOC_DMA_WAIT_TIMEOUT K_MSEC(100)
+
 /* This is the noc2axi instance we want to run the MRISC FW on */
 #define MRISC_FW_NOC2AXI_PORT 0
 #define MRISC_SETUP_TLB       13
@@ -42,6 +46,8 @@ static const struct device *dma_noc = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(dma1));
 #define ARC_NOC0_Y            0
 #define MRISC_L1_SIZE         (128 * 1024)
 
+#define MRISC_FW_COPY_TIMEOUT_MS 10
+
 #define MRISC_FW_TAG     "memfw"
 #define MRISC_FW_CFG_TAG "memfwcfg"
 
@@ -159,24 +165,95 @@ static void SetAxiEnable(uint8_t gddr_inst, uint8_t noc2axi_port, bool axi_enabl
 	}
 }
 
+/* The FW is checksummed as it streams through buf, so L1 is never read back */
 static int LoadMriscFw(uint8_t gddr_inst, uint8_t *buf, size_t buf_size, size_t spi_address,
-		       size_t image_size)
+		       size_t image_size, uint32_t *cksum)
 {
 	volatile uint32_t *mrisc_l1 = SetupMriscL1Tlb(gddr_inst);
+	struct tt_boot_fs_cksum_ctx ctx;
+
+	tt_boot_fs_cksum_init(&ctx);
+
 	int rc = spi_arc_dma_transfer_to_tile(flash, spi_address, image_size, buf, buf_size,
-					      (uint8_t *)mrisc_l1);
+					      (uint8_t *)mrisc_l1, &ctx);
+
+	*cksum = tt_boot_fs_cksum_final(&ctx);
 
 	return rc;
 }
-static int LoadMriscFwCfg(uint8_t gddr_inst, uint8_t *buf, size_t buf_size, size_t spi_address,
-			  size_t image_size)
+
+/* The config image is small enough to be read once into buf and copied from there */
+static int LoadMriscFwCfg(uint8_t gddr_inst, const uint8_t *fw_cfg_image, size_t image_size)
+{
+	volatile uint8_t *mrisc_l1 = SetupMriscL1Tlb(gddr_inst);
+
+	if (!ArcDmaTransfer(fw_cfg_image, (uint8_t *)mrisc_l1 + MRISC_FW_CFG_OFFSET, image_size)) {
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/* Copy MRISC FW that is already in the L1 of one GDDR instance to another over the NOC, instead
+ * of reading it from SPI flash again.
+ */
+static int CopyMriscFw(uint8_t src_inst, uint8_t dst_inst, size_t image_size)
+{
+	uint8_t src_x, src_y, dst_x, dst_y;
+
+	GetGddrNocCoords(src_inst, MRISC_FW_NOC2AXI_PORT, 0, &src_x, &src_y);
+	GetGddrNocCoords(dst_inst, MRISC_FW_NOC2AXI_PORT, 0, &dst_x, &dst_y);
+
+	struct tt_bh_dma_noc_coords coords = tt_bh_dma_noc_coords_init(src_x, src_y, dst_x, dst_y);
+
+	struct dma_block_config block = {
+		.source_address = MRISC_L1_ADDR,
+		.dest_address = MRISC_L1_ADDR,
+		.block_size = image_size,
+	};
+
+	struct dma_config config = {
+		.channel_direction = PERIPHERAL_TO_MEMORY,
+		.source_data_size = 1,
+		.dest_data_size = 1,
+		.source_burst_length = 1,
+		.dest_burst_length = 1,
+		.block_count = 1,
+		.head_block = &block,
+		.user_data = &coords,
+	};
+
+	int rc = dma_config(dma_noc, 1, &config);
+
+	if (rc == 0) {
+		rc = dma_start(dma_noc, 1);
+	}
+
+	if (rc != 0) {
+		return -EIO;
+	}
+
+	return tt_bh_dma_noc_wait_channel(dma_noc, 1, K_MSEC(MRISC_FW_COPY_TIMEOUT_MS));
+}
+
+#ifdef CONFIG_TT_BH_ARC_MRISC_FW_VERIFY_COPY
+/* Checksum of the MRISC FW in L1, read back through the uncached TLB window */
+static uint32_t MriscFwCksum(uint8_t gddr_inst, size_t image_size)
 {
 	volatile uint32_t *mrisc_l1 = SetupMriscL1Tlb(gddr_inst);
-	int rc = spi_arc_dma_transfer_to_tile(flash, spi_address, image_size, buf, buf_size,
-					      (uint8_t *)mrisc_l1 + MRISC_FW_CFG_OFFSET);
+	struct tt_boot_fs_cksum_ctx ctx;
 
-	return rc;
+	tt_boot_fs_cksum_init(&ctx);
+	for (size_t i = 0; i < DIV_ROUND_UP(image_size, sizeof(uint32_t)); i++) {
+		uint32_t word = mrisc_l1[i];
+
+		tt_boot_fs_cksum_update(&ctx, (uint8_t *)&word,
+					MIN(sizeof(word), image_size - i * sizeof(word)));
+	}
+
+	return tt_boot_fs_cksum_final(&ctx);
 }
+#endif
 
 static uint32_t GetDramMask(void)
 {
@@ -305,6 +382,9 @@ static void wipe_l1(void)
 		.user_data = &coords,
 	};
 
+	/* Spread the wipes over the DMA channels so that they run in parallel */
+	uint32_t channel = 0;
+
 	for (uint32_t gddr_inst = 0; gddr_inst < NUM_GDDR; gddr_inst++) {
 		if (IS_BIT_SET(dram_mask, gddr_inst)) {
 			for (uint32_t noc2axi_port = 0; noc2axi_port < NUM_MRISC_NOC2AXI_PORT;
@@ -317,11 +397,26 @@ static void wipe_l1(void)
 				coords.dest_y = y;
 
 				/* AXI enable must not be set, using MRISC address 0 */
-				dma_config(dma_noc, 1, &config);
-				dma_start(dma_noc, 1);
+				int rc = tt_bh_dma_noc_wait_channel(dma_noc, channel,
+								    NOC_DMA_WAIT_TIMEOUT);
+
+				if (rc == 0) {
+					rc = dma_config(dma_noc, channel, &config);
+				}
+				if (rc == 0) {
+					rc = dma_start(dma_noc, channel);
+				}
+				if (rc != 0) {
+					LOG_ERR("%s(%d) failed: %d", "wipe_l1", gddr_inst, rc);
+				}
+				channel = (channel + 1) % NOC_DMA_NUM_CHANNELS;
 			}
 		}
 	}
+
+	if (tt_bh_dma_noc_wait_idle(dma_noc, NOC_DMA_NUM_CHANNELS, NOC_DMA_WAIT_TIMEOUT) != 0) {
+		LOG_ERR("%s() failed: %d", "tt_bh_dma_noc_wait_idle", -ETIMEDOUT);
+	}
 }
 
 static int InitMrisc(void)
@@ -351,26 +446,56 @@ static int InitMrisc(void)
 
 	uint8_t buf[SCRATCHPAD_SIZE] __aligned(4);
 
-	rc = tt_boot_fs_find_fd_by_tag(flash, MRISC_FW_TAG, &tag_fd);
+	rc = fw_image_cache_find(MRISC_FW_TAG, &tag_fd);
 	if (rc < 0) {
-		LOG_ERR("%s (%s) failed: %d", "tt_boot_fs_find_fd_by_tag", MRISC_FW_TAG, rc);
+		LOG_ERR("%s (%s) failed: %d", "fw_image_cache_find", MRISC_FW_TAG, rc);
 		return rc;
 	}
 	image_size = tag_fd.flags.f.image_size;
 	spi_address = tag_fd.spi_addr;
 
+	/* Read the FW from flash into the first instance only, and copy it from there. Only an
+	 * instance whose FW matched the image checksum on the way in is copied from, and the NOC
+	 * DMA copies are trusted unless CONFIG_TT_BH_ARC_MRISC_FW_VERIFY_COPY is set. Instances
+	 * whose copy fails are loaded from flash instead.
+	 */
+	uint8_t loaded_inst = NUM_GDDR;
+	uint32_t cksum;
+
 	for (uint8_t gddr_inst = 0; gddr_inst < NUM_GDDR; gddr_inst++) {
-		if (IS_BIT_SET(dram_mask, gddr_inst)) {
-			if (LoadMriscFw(gddr_inst, buf, SCRATCHPAD_SIZE, spi_address, image_size)) {
-				LOG_ERR("%s(%d) failed: %d", "LoadMriscFw", gddr_inst, -EIO);
-				return -EIO;
+		if (!IS_BIT_SET(dram_mask, gddr_inst)) {
+			continue;
+		}
+
+		if (loaded_inst < NUM_GDDR && device_is_ready(dma_noc)) {
+			rc = CopyMriscFw(loaded_inst, gddr_inst, image_size);
+#ifdef CONFIG_TT_BH_ARC_MRISC_FW_VERIFY_COPY
+			if (rc == 0 && MriscFwCksum(gddr_inst, image_size) != tag_fd.data_crc) {
+				rc = -EIO;
 			}
+#endif
+			if (rc == 0) {
+				continue;
+			}
+			LOG_WRN("%s(%d) failed: %d", "CopyMriscFw", gddr_inst, rc);
+		}
+
+		if (LoadMriscFw(gddr_inst, buf, SCRATCHPAD_SIZE, spi_address, image_size,
+				&cksum)) {
+			LOG_ERR("%s(%d) failed: %d", "LoadMriscFw", gddr_inst, -EIO);
+			return -EIO;
+		}
+		if (cksum == tag_fd.data_crc) {
+			loaded_inst = gddr_inst;
+		} else {
+			LOG_WRN("GDDR %d MRISC FW checksum 0x%08x, expected 0x%08x", gddr_inst,
+				cksum, tag_fd.data_crc);
 		}
 	}
 
-	rc = tt_boot_fs_find_fd_by_tag(flash, MRISC_FW_CFG_TAG, &tag_fd);
+	rc = fw_image_cache_find(MRISC_FW_CFG_TAG, &tag_fd);
 	if (rc < 0) {
-		LOG_ERR("%s (%s) failed: %d", "tt_boot_fs_find_fd_by_tag", MRISC_FW_CFG_TAG, rc);
+		LOG_ERR("%s (%s) failed: %d", "fw_image_cache_find", MRISC_FW_CFG_TAG, rc);
 		return rc;
 	}
 	image_size = tag_fd.flags.f.image_size;
@@ -403,8 +528,7 @@ static int InitMrisc(void)
 
 	for (uint8_t gddr_inst = 0; gddr_inst < NUM_GDDR; gddr_inst++) {
 		if (IS_BIT_SET(dram_mask, gddr_inst)) {
-			if (LoadMriscFwCfg(gddr_inst, buf, SCRATCHPAD_SIZE, spi_address,
-					   image_size)) {
+			if (LoadMriscFwCfg(gddr_inst, buf, image_size)) {
 				LOG_ERR("%s(%d) failed: %d", "LoadMriscFwCfg", gddr_inst, -EIO);
 				return -EIO;
 			}
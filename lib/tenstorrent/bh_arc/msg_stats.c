@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "msg_stats.h"
+#include "timer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/util.h>
+
+#define MSG_STATS_QUEUE_WAIT_FLAG BIT(0)
+#define MSG_STATS_RESET_FLAG      BIT(1)
+
+/* Message codes are given a statistics slot the first time they are dispatched. 0 means no slot,
+ * otherwise the slot index is stored plus one.
+ */
+static uint8_t code_slot[CONFIG_TT_BH_ARC_NUM_MSG_CODES];
+static struct msg_stats code_stats[CONFIG_TT_BH_ARC_MSG_STATS_SLOTS];
+static uint32_t num_slots_used;
+
+/* Time from doorbell / MSI until each message is dispatched */
+static struct msg_stats queue_wait_stats;
+
+/* Timestamp of the first doorbell since the last batch started, shared with the ISRs */
+static uint32_t doorbell_time;
+static bool doorbell_pending;
+
+/* Doorbell timestamp latched for the batch of messages currently being processed */
+static uint32_t batch_doorbell_time;
+static bool batch_has_doorbell;
+
+static struct k_spinlock stats_lock;
+
+BUILD_ASSERT(CONFIG_TT_BH_ARC_NUM_MSG_CODES <= 256, "message codes must fit in a uint8_t");
+BUILD_ASSERT(CONFIG_TT_BH_ARC_MSG_STATS_SLOTS < 256, "slot index must fit in a uint8_t");
+
+static void add_sample(struct msg_stats *stats, uint32_t cycles)
+{
+	uint32_t bucket = MIN(find_msb_set(cycles), MSG_STATS_NUM_BUCKETS - 1);
+
+	stats->count++;
+	stats->total += cycles;
+	stats->max = MAX(stats->max, cycles);
+	stats->hist[bucket]++;
+}
+
+static struct msg_stats *stats_for_code(uint8_t msg_code)
+{
+	if (msg_code >= CONFIG_TT_BH_ARC_NUM_MSG_CODES) {
+		return NULL;
+	}
+
+	if (code_slot[msg_code] == 0) {
+		if (num_slots_used >= CONFIG_TT_BH_ARC_MSG_STATS_SLOTS) {
+			return NULL;
+		}
+		code_slot[msg_code] = ++num_slots_used;
+	}
+
+	return &code_stats[code_slot[msg_code] - 1];
+}
+
+/* Called from the message queue interrupt handlers */
+void msg_stats_doorbell(void)
+{
+	if (!doorbell_pending) {
+		doorbell_time = TimerTimestamp();
+		doorbell_pending = true;
+	}
+}
+
+/* Called before the message queues are scanned. Latches the pending doorbell so that doorbells
+ * arriving during processing are attributed to the next batch.
+ */
+void msg_stats_batch_start(void)
+{
+	unsigned int key = irq_lock();
+
+	batch_has_doorbell = doorbell_pending;
+	batch_doorbell_time = doorbell_time;
+	doorbell_pending = false;
+
+	irq_unlock(key);
+}
+
+uint64_t msg_stats_begin(void)
+{
+	return TimerTimestamp();
+}
+
+void msg_stats_end(uint8_t msg_code, uint64_t begin)
+{
+	uint64_t end = TimerTimestamp();
+	uint32_t service_time = MIN(end - begin, UINT32_MAX);
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+	struct msg_stats *stats = stats_for_code(msg_code);
+
+	if (stats != NULL) {
+		add_sample(stats, service_time);
+	}
+
+	if (batch_has_doorbell) {
+		/* 32-bit difference handles the wrap of the low timestamp word */
+		add_sample(&queue_wait_stats, (uint32_t)begin - batch_doorbell_time);
+	}
+
+	k_spin_unlock(&stats_lock, key);
+}
+
+int msg_stats_get(uint8_t msg_code, struct msg_stats *stats)
+{
+	if (msg_code >= CONFIG_TT_BH_ARC_NUM_MSG_CODES) {
+		return -EINVAL;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	if (code_slot[msg_code] == 0) {
+		memset(stats, 0, sizeof(*stats));
+	} else {
+		*stats = code_stats[code_slot[msg_code] - 1];
+	}
+
+	k_spin_unlock(&stats_lock, key);
+
+	return 0;
+}
+
+int msg_stats_get_queue_wait(struct msg_stats *stats)
+{
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	*stats = queue_wait_stats;
+
+	k_spin_unlock(&stats_lock, key);
+
+	return 0;
+}
+
+void msg_stats_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	memset(code_stats, 0, sizeof(code_stats));
+	memset(&queue_wait_stats, 0, sizeof(queue_wait_stats));
+
+	k_spin_unlock(&stats_lock, key);
+}
+
+/** @brief Handles the request to read message latency statistics
+ * @param[in] request The request, of type @ref msg_stats_rqst
+ * @param[out] response data[1]: sample count, data[2]: max time, data[3]: mean time,
+ *	data[4..7]: histogram buckets starting at @ref msg_stats_rqst::first_bucket.
+ *	Times are in refclk cycles.
+ * @return 0 for success, 1 for an invalid message code or bucket
+ */
+static uint8_t get_msg_stats_handler(const union request *request, struct response *response)
+{
+	const struct msg_stats_rqst *rqst = &request->msg_stats;
+	struct msg_stats stats;
+	int ret;
+
+	if (rqst->first_bucket >= MSG_STATS_NUM_BUCKETS) {
+		return 1;
+	}
+
+	if (rqst->flags & MSG_STATS_QUEUE_WAIT_FLAG) {
+		ret = msg_stats_get_queue_wait(&stats);
+	} else {
+		ret = msg_stats_get(rqst->msg_code, &stats);
+	}
+
+	if (ret < 0) {
+		return 1;
+	}
+
+	response->data[1] = stats.count;
+	response->data[2] = stats.max;
+	response->data[3] = stats.count == 0 ? 0 : stats.total / stats.count;
+	for (uint32_t i = 0; i < 4 && rqst->first_bucket + i < MSG_STATS_NUM_BUCKETS; i++) {
+		response->data[4 + i] = stats.hist[rqst->first_bucket + i];
+	}
+
+	if (rqst->flags & MSG_STATS_RESET_FLAG) {
+		msg_stats_reset();
+	}
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_GET_MSG_STATS, get_msg_stats_handler);
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef MSG_STATS_H
+#define MSG_STATS_H
+
+#include <stdint.h>
+#include <errno.h>
+
+/* Bucket 0 counts samples of 0 cycles, bucket n counts samples in [2^(n-1), 2^n) refclk cycles.
+ * The last bucket also collects everything longer than that.
+ */
+#define MSG_STATS_NUM_BUCKETS 32
+
+/* Latency statistics, all times are in refclk cycles (see timer.h) */
+struct msg_stats {
+	uint32_t count;
+	uint32_t max;
+	uint64_t total;
+	uint32_t hist[MSG_STATS_NUM_BUCKETS];
+};
+
+#ifdef CONFIG_TT_BH_ARC_MSG_STATS
+void msg_stats_doorbell(void);
+void msg_stats_batch_start(void);
+uint64_t msg_stats_begin(void);
+void msg_stats_end(uint8_t msg_code, uint64_t begin);
+int msg_stats_get(uint8_t msg_code, struct msg_stats *stats);
+int msg_stats_get_queue_wait(struct msg_stats *stats);
+void msg_stats_reset(void);
+#else
+static inline void msg_stats_doorbell(void)
+{
+}
+
+static inline void msg_stats_batch_start(void)
+{
+}
+
+static inline uint64_t msg_stats_begin(void)
+{
+	return 0;
+}
+
+static inline void msg_stats_end(uint8_t msg_code, uint64_t begin)
+{
+}
+
+static inline int msg_stats_get(uint8_t msg_code, struct msg_stats *stats)
+{
+	return -ENOTSUP;
+}
+
+static inline int msg_stats_get_queue_wait(struct msg_stats *stats)
+{
+	return -ENOTSUP;
+}
+
+static inline void msg_stats_reset(void)
+{
+}
+#endif
+
+#endif
@@ -15,6 +15,8 @@
 #include <tenstorrent/smc_msg.h>
 #include <tenstorrent/post_code.h>
 #include <tenstorrent/sys_init_defines.h>
+#include "arc.h"
+#include "msg_stats.h"
 #include "status_reg.h"
 #include "reg.h"
 #include "irqnum.h"
@@ -91,9 +93,47 @@ struct message_queue {
 /* All the message queues in the system. */
 static struct message_queue message_queues[NUM_MSG_QUEUES];
 
+/* Requests popped from a queue by drain_requests() that have not been run yet. */
+struct drained_batch {
+	union request requests[MSG_QUEUE_SIZE];
+	uint32_t next;
+	uint32_t count;
+};
+
+static struct drained_batch drained_batches[NUM_MSG_QUEUES];
+
+/* Response slots handed out to dispatched messages. Responses are written in any order, but
+ * response_queue_wptr is only advanced over a contiguous run of written slots, so the host still
+ * sees them in request order.
+ */
+struct response_slots {
+	/* Next slot to hand out, double-wrapped like the header pointers. */
+	uint32_t reserve_ptr;
+	/* Ring indices holding a written response that has not been published yet. */
+	uint64_t written;
+};
+
+BUILD_ASSERT(MSG_QUEUE_SIZE <= 64);
+static struct response_slots response_slots[NUM_MSG_QUEUES];
+
+/* Protects response_slots::written and response publication against deferred completions. */
+static struct k_spinlock response_lock;
+
+/* The message currently being run by process_message_queues(), for msgqueue_defer_response(). */
+static int dispatch_queue_id = -1;
+static uint32_t dispatch_slot;
+static bool dispatch_deferred;
+
+/* Lower values are serviced first. Queues of equal priority are serviced in index order.
+ * Initialized from CONFIG_TT_BH_ARC_MSG_QUEUE_PRIORITIES.
+ */
+static uint8_t queue_priority[NUM_MSG_QUEUES];
+
 /* All message handlers */
 static void *message_handlers[CONFIG_TT_BH_ARC_NUM_MSG_CODES];
 
+/* The host discovers the queue depth and count from the second word of this block. */
+BUILD_ASSERT(MSG_QUEUE_SIZE <= 0xff && NUM_MSG_QUEUES <= 0xff);
 __attribute__((used)) static const uintptr_t message_queue_info[] = {
 	(uintptr_t)&message_queues, MSG_QUEUE_SIZE | (NUM_MSG_QUEUES << 8), 0, 0};
 
@@ -201,38 +241,52 @@ int msgqueue_response_pop(uint32_t msgqueue_id, struct response *response)
 	return 0;
 }
 
-static bool start_next_message(struct message_queue *queue, uint32_t *request_rptr_out,
-			       uint32_t *response_wptr_out)
+/* Number of entries between rptr and wptr. Pointers are double-wrapped, so this ranges from 0
+ * (empty) to MSG_QUEUE_SIZE (full).
+ */
+static uint32_t queue_occupancy(uint32_t wptr, uint32_t rptr)
 {
-	/* Queue pointers are double-wrapped so equal means empty, differ by size means full. */
+	return (wptr + MSG_QUEUE_POINTER_WRAP - rptr) % MSG_QUEUE_POINTER_WRAP;
+}
 
+/* Pop every pending request that has a response slot available into requests[]. */
+/* The request slots are handed back to the host before any of the messages run, so the host can
+ * queue up the next batch while this one is being processed.
+ */
+static uint32_t drain_requests(struct message_queue *queue, const struct response_slots *slots,
+			       union request *requests)
+{
 	uint32_t request_wptr = queue->header.request_queue_wptr;
 	uint32_t request_rptr = queue->header.request_queue_rptr;
+	uint32_t response_wptr = queue->header.response_queue_wptr;
+	uint32_t response_rptr = queue->header.response_queue_rptr;
 
-	if (request_wptr == request_rptr) {
-		return false;
+	if (request_wptr >= MSG_QUEUE_POINTER_WRAP || request_rptr >= MSG_QUEUE_POINTER_WRAP ||
+	    response_wptr >= MSG_QUEUE_POINTER_WRAP || response_rptr >= MSG_QUEUE_POINTER_WRAP) {
+		return 0;
 	}
 
 	/* Don't accept a request unless there's a response queue slot. */
 	/* We must not block and we don't want to hold onto the response. */
-	uint32_t response_wptr = queue->header.response_queue_wptr;
-	uint32_t response_rptr = queue->header.response_queue_rptr;
-
-	if ((response_wptr - response_rptr) % MSG_QUEUE_POINTER_WRAP == MSG_QUEUE_SIZE) {
-		return false;
-	}
+	/* Slots reserved for deferred responses count as used. */
+	uint32_t pending = queue_occupancy(request_wptr, request_rptr);
+	uint32_t free_slots = MSG_QUEUE_SIZE - queue_occupancy(slots->reserve_ptr, response_rptr);
+	uint32_t count = MIN(pending, free_slots);
 
-	if (request_wptr >= MSG_QUEUE_POINTER_WRAP || request_rptr >= MSG_QUEUE_POINTER_WRAP ||
-	    response_wptr >= MSG_QUEUE_POINTER_WRAP || request_rptr >= MSG_QUEUE_POINTER_WRAP) {
-		return false;
+	if (count == 0) {
+		return 0;
 	}
 
 	atomic_thread_fence(memory_order_acquire);
 
-	*request_rptr_out = request_rptr;
-	*response_wptr_out = response_wptr;
+	for (uint32_t i = 0; i < count; i++) {
+		requests[i] = *request_entry(queue, request_rptr + i);
+	}
+
+	atomic_thread_fence(memory_order_seq_cst);
+	queue->header.request_queue_rptr = (request_rptr + count) % MSG_QUEUE_POINTER_WRAP;
 
-	return true;
+	return count;
 }
 
 static bool command_writes_serial(const union request *request)
@@ -282,10 +336,64 @@ static void report_scratch_only_message(struct response *response)
 	response->data[0] = MESSAGE_QUEUE_STATUS_SCRATCH_ONLY;
 }
 
+/* Make sure that the host only points batches at CSM. There is no CSM on native_sim, so any
+ * non-NULL address is accepted there.
+ */
+static bool check_csm_region(uint32_t addr, uint32_t num_bytes)
+{
+	if (!IS_ENABLED(CONFIG_ARC)) {
+		return addr == 0;
+	}
+
+	return addr < ARC_CSM_START_ADDR || addr - ARC_CSM_START_ADDR > ARC_CSM_SIZE ||
+	       num_bytes > ARC_CSM_SIZE - (addr - ARC_CSM_START_ADDR);
+}
+
+static void handle_batch(const union request *request, struct response *response)
+{
+	const struct batch_rqst *batch = &request->batch;
+	const union request *sub_requests = (const union request *)(uintptr_t)batch->requests_addr;
+	struct response *sub_responses = (struct response *)(uintptr_t)batch->responses_addr;
+	int queue_id = dispatch_queue_id;
+
+	if (batch->count > MSG_BATCH_MAX_REQUESTS ||
+	    (batch->requests_addr | batch->responses_addr) % sizeof(uint32_t) != 0 ||
+	    check_csm_region(batch->requests_addr, batch->count * sizeof(*sub_requests)) ||
+	    check_csm_region(batch->responses_addr, batch->count * sizeof(*sub_responses))) {
+		response->data[0] = 1;
+		return;
+	}
+
+	/* Sub-requests share the batch's response slot, so they can't defer their responses. */
+	dispatch_queue_id = -1;
+
+	for (uint32_t i = 0; i < batch->count; i++) {
+		union request sub_request = sub_requests[i];
+		struct response sub_response = (struct response){0};
+
+		if (sub_request.command_code == TT_SMC_MSG_BATCH ||
+		    sub_request.command_code == TT_SMC_MSG_SET_LAST_SERIAL ||
+		    sub_request.command_code == TT_SMC_MSG_TEST) {
+			sub_response.data[0] = MSG_ERROR_REPLY;
+		} else {
+			process_l2_message_queue(&sub_request, &sub_response);
+		}
+
+		sub_responses[i] = sub_response;
+	}
+
+	dispatch_queue_id = queue_id;
+
+	atomic_thread_fence(memory_order_seq_cst);
+	response->data[1] = batch->count;
+}
+
 /* Run a single message. */
 static void process_queued_message(struct message_queue *queue, const union request *request,
 				   struct response *response)
 {
+	uint64_t begin = msg_stats_begin();
+
 	switch (request->command_code) {
 	case TT_SMC_MSG_SET_LAST_SERIAL:
 		handle_set_last_serial(queue, request);
@@ -296,29 +404,40 @@ static void process_queued_message(struct message_queue *queue, const union requ
 	case TT_SMC_MSG_REPORT_SCRATCH_ONLY:
 		report_scratch_only_message(response);
 		break;
+	case TT_SMC_MSG_BATCH:
+		handle_batch(request, response);
+		break;
 	default:
 		process_l2_message_queue(request, response);
 		break;
 	}
+
+	msg_stats_end(request->command_code, begin);
 }
 
-/* Run all the outstanding messages in a single queue. */
-static void process_message_queue(struct message_queue *queue)
+/* Refill any fully processed batches, then pick the highest priority queue that has a message
+ * ready to run. A queue is only drained again once all of its previous batch has been dispatched,
+ * since drain_requests() sizes the batch by the response slots not yet reserved.
+ */
+static int next_ready_queue(void)
 {
+	int ready = -1;
 
-	uint32_t request_rptr;
-	uint32_t response_wptr;
-
-	while (start_next_message(queue, &request_rptr, &response_wptr)) {
-		union request request = (union request){0};
-		struct response response = (struct response){0};
+	for (unsigned int i = 0; i < NUM_MSG_QUEUES; i++) {
+		struct drained_batch *batch = &drained_batches[i];
 
-		msgqueue_request_pop(queue - message_queues, &request);
-		process_queued_message(queue, &request, &response);
-		msgqueue_response_push(queue - message_queues, &response);
+		if (batch->next == batch->count) {
+			batch->count = drain_requests(&message_queues[i], &response_slots[i],
+						      batch->requests);
+			batch->next = 0;
+		}
 
-		advance_serial(queue, &request);
+		if (batch->count != 0 && (ready < 0 || queue_priority[i] < queue_priority[ready])) {
+			ready = i;
+		}
 	}
+
+	return ready;
 }
 
 void clear_msg_irq(void)
@@ -331,17 +450,93 @@ void clear_msg_irq(void)
 #endif
 }
 
-/* Run all messages in all queues. */
+/* Write a response into its reserved slot and publish every response that is now in order. */
+static void complete_response(uint32_t msgqueue_id, uint32_t slot, const struct response *response)
+{
+	struct message_queue *queue = &message_queues[msgqueue_id];
+	struct response_slots *slots = &response_slots[msgqueue_id];
+	k_spinlock_key_t key = k_spin_lock(&response_lock);
+	uint32_t wptr = queue->header.response_queue_wptr;
+
+	*response_entry(queue, slot) = *response;
+	slots->written |= BIT64(slot % MSG_QUEUE_SIZE);
+
+	while (slots->written & BIT64(wptr % MSG_QUEUE_SIZE)) {
+		slots->written &= ~BIT64(wptr % MSG_QUEUE_SIZE);
+		wptr = (wptr + 1) % MSG_QUEUE_POINTER_WRAP;
+	}
+
+	atomic_thread_fence(memory_order_acquire);
+	queue->header.response_queue_wptr = wptr;
+
+	k_spin_unlock(&response_lock, key);
+}
+
+/* Run all messages in all queues. Queues are re-scanned after every message, so a message arriving
+ * on a higher priority queue is run before the rest of a lower priority queue's batch.
+ */
 void process_message_queues(void)
 {
+	int i;
+
 	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_ARC_MSG_HANDLE_START);
-	for (unsigned int i = 0; i < NUM_MSG_QUEUES; i++) {
+	msg_stats_batch_start();
+	while ((i = next_ready_queue()) >= 0) {
+		struct message_queue *queue = &message_queues[i];
+		struct drained_batch *batch = &drained_batches[i];
+		struct response_slots *slots = &response_slots[i];
+		const union request *request = &batch->requests[batch->next++];
+		struct response response = (struct response){0};
+
+		dispatch_queue_id = i;
+		dispatch_slot = slots->reserve_ptr;
+		dispatch_deferred = false;
+		slots->reserve_ptr = (slots->reserve_ptr + 1) % MSG_QUEUE_POINTER_WRAP;
+
 		SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_ARG_MSG_QUEUE_START + i);
-		process_message_queue(&message_queues[i]);
+		process_queued_message(queue, request, &response);
+		dispatch_queue_id = -1;
+
+		if (!dispatch_deferred) {
+			complete_response(i, dispatch_slot, &response);
+		}
+
+		advance_serial(queue, request);
 	}
 	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_ARC_MSG_HANDLE_DONE);
 }
 
+int msgqueue_defer_response(struct msgqueue_deferred_response *deferred)
+{
+	if (dispatch_queue_id < 0 || dispatch_deferred) {
+		return -EINVAL;
+	}
+
+	deferred->msgqueue_id = dispatch_queue_id;
+	deferred->slot = dispatch_slot;
+	dispatch_deferred = true;
+
+	return 0;
+}
+
+void msgqueue_complete_response(const struct msgqueue_deferred_response *deferred,
+				struct response *response, uint8_t exit_code)
+{
+	response->data[0] |= exit_code;
+	complete_response(deferred->msgqueue_id, deferred->slot, response);
+}
+
+int msgqueue_set_queue_priority(uint32_t msgqueue_id, uint8_t priority)
+{
+	if (msgqueue_id >= NUM_MSG_QUEUES) {
+		return -EINVAL;
+	}
+
+	queue_priority[msgqueue_id] = priority;
+
+	return 0;
+}
+
 void msgqueue_register_handler(uint32_t msg_code, msgqueue_request_handler_t handler)
 {
 	if (msg_code >= CONFIG_TT_BH_ARC_NUM_MSG_CODES) {
@@ -353,9 +548,15 @@ void msgqueue_register_handler(uint32_t msg_code, msgqueue_request_handler_t han
 
 static void prepare_msg_queue(void)
 {
-	/* clear message queue headers */
+	BUILD_ASSERT(NUM_MSG_QUEUES <= 4, "TT_BH_ARC_MSG_QUEUE_PRIORITIES has a nibble per queue");
+
+	/* clear message queue headers and any requests drained before the reset */
 	for (unsigned int i = 0; i < NUM_MSG_QUEUES; i++) {
 		memset(&message_queues[i].header, 0, sizeof(message_queues[i].header));
+		memset(&response_slots[i], 0, sizeof(response_slots[i]));
+		drained_batches[i].next = 0;
+		drained_batches[i].count = 0;
+		queue_priority[i] = (CONFIG_TT_BH_ARC_MSG_QUEUE_PRIORITIES >> (4 * i)) & 0xf;
 	}
 
 	/* populate address of message queue info */
@@ -374,7 +575,6 @@ static int register_interrupt_handlers(void)
 SYS_INIT_APP(register_interrupt_handlers);
 #endif
 
-#ifdef CONFIG_BOARD_TT_BLACKHOLE
 static void msgqueue_work_handler(struct k_work *work)
 {
 	process_message_queues();
@@ -382,11 +582,42 @@ static void msgqueue_work_handler(struct k_work *work)
 
 static K_WORK_DEFINE(msgqueue_work, msgqueue_work_handler);
 
+#ifdef CONFIG_TT_BH_ARC_MSG_QUEUE_THREAD
+static K_THREAD_STACK_DEFINE(msgqueue_work_q_stack, CONFIG_TT_BH_ARC_MSG_QUEUE_THREAD_STACK_SIZE);
+static struct k_work_q msgqueue_work_q;
+
+/* Started once at boot rather than in init_msgqueue(), so that resetting the queues never
+ * restarts a running work queue.
+ */
+static int msgqueue_work_q_init(void)
+{
+	const struct k_work_queue_config cfg = {.name = "msgqueue"};
+
+	k_work_queue_start(&msgqueue_work_q, msgqueue_work_q_stack,
+			   K_THREAD_STACK_SIZEOF(msgqueue_work_q_stack),
+			   CONFIG_TT_BH_ARC_MSG_QUEUE_THREAD_PRIORITY, &cfg);
+	return 0;
+}
+
+SYS_INIT_APP(msgqueue_work_q_init);
+#endif
+
+void msgqueue_notify(void)
+{
+	msg_stats_doorbell();
+#ifdef CONFIG_TT_BH_ARC_MSG_QUEUE_THREAD
+	k_work_submit_to_queue(&msgqueue_work_q, &msgqueue_work);
+#else
+	k_work_submit(&msgqueue_work);
+#endif
+}
+
+#ifdef CONFIG_BOARD_TT_BLACKHOLE
 static void msgqueue_interrupt_handler(void *arg)
 {
 	(void)(arg);
 	clear_msg_irq();
-	k_work_submit(&msgqueue_work);
+	msgqueue_notify();
 }
 
 static bool msi_catcher_nonempty(void)
@@ -423,7 +654,7 @@ static void msgqueue_msi_interrupt_handler(void *arg)
 	}
 
 	if (msi_for_msgqueue) {
-		k_work_submit(&msgqueue_work);
+		msgqueue_notify();
 	}
 }
 
@@ -432,7 +663,7 @@ static void msgqueue_msi_overflow_handler(void *arg)
 	(void)(arg);
 
 	msi_catcher_flush();
-	k_work_submit(&msgqueue_work);
+	msgqueue_notify();
 }
 #endif
 
@@ -6,10 +6,13 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <zephyr/init.h>
 #include <zephyr/kernel.h>
 #include <tenstorrent/smc_msg.h>
 #include <tenstorrent/msgqueue.h>
+#include <tenstorrent/sys_init_defines.h>
 
+#include "dma_queue.h"
 #include "util.h"
 #include "pcie.h"
 
@@ -37,31 +40,12 @@
 	0x0038001C
 #define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_DOORBELL_OFF_WRCH_0_REG_ADDR         \
 	0x00380004
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_STATUS_OFF_RDCH_0_REG_ADDR 0x00380180
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_INT_SETUP_OFF_RDCH_0_REG_ADDR        \
-	0x00380188
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_MSI_STOP_LOW_OFF_RDCH_0_REG_ADDR     \
-	0x00380190
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_MSI_STOP_HIGH_OFF_RDCH_0_REG_ADDR    \
-	0x00380194
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_MSI_ABORT_LOW_OFF_RDCH_0_REG_ADDR    \
-	0x003801A0
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_MSI_ABORT_HIGH_OFF_RDCH_0_REG_ADDR   \
-	0x003801A4
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_MSI_MSGD_OFF_RDCH_0_REG_ADDR         \
-	0x003801A8
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_EN_OFF_RDCH_0_REG_ADDR      0x00380100
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_DAR_LOW_OFF_RDCH_0_REG_ADDR 0x00380128
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_DAR_HIGH_OFF_RDCH_0_REG_ADDR         \
-	0x0038012C
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_SAR_LOW_OFF_RDCH_0_REG_ADDR 0x00380120
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_SAR_HIGH_OFF_RDCH_0_REG_ADDR         \
-	0x00380124
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_DOORBELL_OFF_RDCH_0_REG_ADDR         \
-	0x00380104
-#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_XFERSIZE_OFF_RDCH_0_REG_ADDR         \
-	0x0038011C
-
+#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_LLP_LOW_OFF_WRCH_0_REG_ADDR 0x00380010
+#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_LLP_HIGH_OFF_WRCH_0_REG_ADDR         \
+	0x00380014
+#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_CYCLE_OFF_WRCH_0_REG_ADDR   0x00380018
+#define PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_CONTROL1_OFF_WRCH_0_REG_ADDR         \
+	0x00380034
 #define HDMA_REG_ADDR(reg) (PCIE_DBI_USP_A_BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_##reg##_REG_ADDR)
 
 typedef struct {
@@ -82,23 +66,18 @@ typedef union {
 
 #define BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_INT_SETUP_OFF_WRCH_0_REG_DEFAULT (0x00000007)
 
-typedef struct {
-	uint32_t stop_mask: 1;
-	uint32_t watermark_mask: 1;
-	uint32_t abort_mask: 1;
-	uint32_t rsie: 1;
-	uint32_t lsie: 1;
-	uint32_t raie: 1;
-	uint32_t laie: 1;
-	uint32_t reserved_7_31: 25;
-} BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_INT_SETUP_OFF_RDCH_0_reg_t;
-
-typedef union {
-	uint32_t val;
-	BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_INT_SETUP_OFF_RDCH_0_reg_t f;
-} BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_INT_SETUP_OFF_RDCH_0_reg_u;
+/* Write channel n is at WRCH_0 + n * HDMA_CHANNEL_STRIDE, and read channel n has the same layout
+ * HDMA_READ_CHANNEL_OFFSET after it.
+ */
+#define HDMA_CHANNEL_STRIDE      0x200
+#define HDMA_READ_CHANNEL_OFFSET 0x100
+#define HDMA_CH_REG_ADDR(read, ch, reg)                                                            \
+	(HDMA_REG_ADDR(reg##_OFF_WRCH_0) + (ch) * HDMA_CHANNEL_STRIDE +                            \
+	 ((read) ? HDMA_READ_CHANNEL_OFFSET : 0))
 
-#define BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_INT_SETUP_OFF_RDCH_0_REG_DEFAULT (0x00000007)
+#define HDMA_CONTROL1_LLEN       BIT(0)
+#define HDMA_CYCLE_CONSUMER_BIT  BIT(0)
+#define HDMA_CYCLE_CONSUMER_STAT BIT(1)
 
 typedef enum {
 	DMARunning = 1,
@@ -106,82 +85,159 @@ typedef enum {
 	DMAStopped = 3
 } DMAStatus;
 
-/* write transfer from the prespective of the chip. i.e., from chip to host */
-bool PcieDmaWriteTransfer(uint64_t chip_addr, uint64_t host_addr, uint32_t transfer_size_bytes,
-			  uint64_t msi_completion_addr, uint8_t completion_data)
+
+/* One HDMA transfer, either a single block or a linked list of elements. The read direction is
+ * from the perspective of the chip, i.e. host to chip.
+ */
+struct pcie_dma_xfer {
+	uint64_t sar;
+	uint64_t dar;
+	uint64_t list_addr;
+	uint64_t msi_completion_addr;
+	uint32_t transfer_size_bytes;
+	uint8_t completion_data;
+	bool linked_list;
+};
+
+/* Transfers waiting for a free channel, per direction. The HDMA completion interrupts go to the
+ * host, so the firmware polls for free channels while transfers are waiting.
+ */
+K_MSGQ_DEFINE(pcie_dma_write_pending, sizeof(struct pcie_dma_xfer),
+	      CONFIG_TT_BH_ARC_PCIE_DMA_QUEUE_DEPTH, 8);
+K_MSGQ_DEFINE(pcie_dma_read_pending, sizeof(struct pcie_dma_xfer),
+	      CONFIG_TT_BH_ARC_PCIE_DMA_QUEUE_DEPTH, 8);
+
+/* Indexed by direction */
+static struct dma_queue pcie_dma_queues[2];
+
+static bool is_read_queue(const struct dma_queue *queue)
+{
+	return queue == &pcie_dma_queues[1];
+}
+
+static int alloc_channel(struct dma_queue *queue)
 {
-	/* reject dma request if there is a pending transaction */
-	uint32_t status = ReadDbiReg(HDMA_REG_ADDR(STATUS_OFF_WRCH_0));
+	bool read = is_read_queue(queue);
 
-	if (status == DMARunning) {
-		return false;
+	for (uint32_t ch = 0; ch < CONFIG_TT_BH_ARC_PCIE_DMA_CHANNELS; ch++) {
+		/* Channels are released once they stop or abort. The host may also be using a
+		 * channel through DBI directly.
+		 */
+		if (ReadDbiReg(HDMA_CH_REG_ADDR(read, ch, STATUS)) == DMARunning) {
+			continue;
+		}
+
+		return ch;
 	}
 
+	return -EBUSY;
+}
+
+static void start_transfer(struct dma_queue *queue, uint32_t ch, const void *request)
+{
+	const struct pcie_dma_xfer *xfer = request;
+	bool read = is_read_queue(queue);
+
 	/* Setup completion interrupt */
 	BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_INT_SETUP_OFF_WRCH_0_reg_u int_setup;
 
 	int_setup.val = 0;
 	int_setup.f.rsie = 1;
 	int_setup.f.raie = 1;
-	WriteDbiReg(HDMA_REG_ADDR(INT_SETUP_OFF_WRCH_0), int_setup.val);
-	WriteDbiReg(HDMA_REG_ADDR(MSI_STOP_LOW_OFF_WRCH_0), low32(msi_completion_addr));
-	WriteDbiReg(HDMA_REG_ADDR(MSI_STOP_HIGH_OFF_WRCH_0), high32(msi_completion_addr));
-	WriteDbiReg(HDMA_REG_ADDR(MSI_ABORT_LOW_OFF_WRCH_0),
-		    low32(msi_completion_addr + sizeof(uint32_t)));
-	WriteDbiReg(HDMA_REG_ADDR(MSI_ABORT_HIGH_OFF_WRCH_0),
-		    high32(msi_completion_addr + sizeof(uint32_t)));
-	WriteDbiReg(HDMA_REG_ADDR(MSI_MSGD_OFF_WRCH_0), completion_data);
-
-	/* Enable write channel 0 */
-	WriteDbiReg(HDMA_REG_ADDR(EN_OFF_WRCH_0), 0x1);
-
-	WriteDbiReg(HDMA_REG_ADDR(SAR_LOW_OFF_WRCH_0), low32(chip_addr));
-	WriteDbiReg(HDMA_REG_ADDR(SAR_HIGH_OFF_WRCH_0), high32(chip_addr));
-	WriteDbiReg(HDMA_REG_ADDR(DAR_LOW_OFF_WRCH_0), low32(host_addr));
-	WriteDbiReg(HDMA_REG_ADDR(DAR_HIGH_OFF_WRCH_0), high32(host_addr));
-	WriteDbiReg(HDMA_REG_ADDR(XFERSIZE_OFF_WRCH_0), transfer_size_bytes);
-	WriteDbiReg(HDMA_REG_ADDR(DOORBELL_OFF_WRCH_0), 0x1);
-
-	return true;
+	WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, INT_SETUP), int_setup.val);
+	WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, MSI_STOP_LOW), low32(xfer->msi_completion_addr));
+	WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, MSI_STOP_HIGH), high32(xfer->msi_completion_addr));
+	WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, MSI_ABORT_LOW),
+		    low32(xfer->msi_completion_addr + sizeof(uint32_t)));
+	WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, MSI_ABORT_HIGH),
+		    high32(xfer->msi_completion_addr + sizeof(uint32_t)));
+	WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, MSI_MSGD), xfer->completion_data);
+
+	WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, EN), 0x1);
+
+	if (xfer->linked_list) {
+		/* Elements are consumed while their cycle bit matches the consumer cycle bit, so
+		 * the list ends at the first element with the cycle bit clear.
+		 */
+		WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, CONTROL1), HDMA_CONTROL1_LLEN);
+		WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, CYCLE),
+			    HDMA_CYCLE_CONSUMER_STAT | HDMA_CYCLE_CONSUMER_BIT);
+		WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, LLP_LOW), low32(xfer->list_addr));
+		WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, LLP_HIGH), high32(xfer->list_addr));
+	} else {
+		WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, CONTROL1), 0);
+		WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, SAR_LOW), low32(xfer->sar));
+		WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, SAR_HIGH), high32(xfer->sar));
+		WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, DAR_LOW), low32(xfer->dar));
+		WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, DAR_HIGH), high32(xfer->dar));
+		WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, XFERSIZE), xfer->transfer_size_bytes);
+	}
+
+	WriteDbiReg(HDMA_CH_REG_ADDR(read, ch, DOORBELL), 0x1);
+}
+
+static bool poll_pending(struct dma_queue *queue)
+{
+	struct pcie_dma_xfer xfer;
+	bool waiting;
+
+	k_mutex_lock(&queue->lock, K_FOREVER);
+	waiting = dma_queue_start_pending(queue, &xfer);
+	k_mutex_unlock(&queue->lock);
+
+	return waiting;
+}
+
+/* Start the transfer on a free channel, or queue it until one frees up. Returns false if the
+ * pending queue is full.
+ */
+static bool submit_transfer(bool read, const struct pcie_dma_xfer *xfer)
+{
+	return dma_queue_submit(&pcie_dma_queues[read], xfer) == 0;
+}
+
+/* write transfer from the prespective of the chip. i.e., from chip to host */
+bool PcieDmaWriteTransfer(uint64_t chip_addr, uint64_t host_addr, uint32_t transfer_size_bytes,
+			  uint64_t msi_completion_addr, uint8_t completion_data)
+{
+	struct pcie_dma_xfer xfer = {
+		.sar = chip_addr,
+		.dar = host_addr,
+		.msi_completion_addr = msi_completion_addr,
+		.transfer_size_bytes = transfer_size_bytes,
+		.completion_data = completion_data,
+	};
+
+	return submit_transfer(false, &xfer);
 }
 
 /* read transfer from the prespective of the chip. i.e., host to chip */
 bool PcieDmaReadTransfer(uint64_t chip_addr, uint64_t host_addr, uint32_t transfer_size_bytes,
 			 uint64_t msi_completion_addr, uint8_t completion_data)
 {
-	/* reject dma request if there is a pending transaction */
-	uint32_t status = ReadDbiReg(HDMA_REG_ADDR(STATUS_OFF_RDCH_0));
+	struct pcie_dma_xfer xfer = {
+		.sar = host_addr,
+		.dar = chip_addr,
+		.msi_completion_addr = msi_completion_addr,
+		.transfer_size_bytes = transfer_size_bytes,
+		.completion_data = completion_data,
+	};
 
-	if (status == DMARunning) {
-		return false;
-	}
+	return submit_transfer(true, &xfer);
+}
 
-	/* Setup completion interrupt */
-	BH_PCIE_DWC_PCIE_USP_PF0_HDMA_CAP_HDMA_INT_SETUP_OFF_RDCH_0_reg_u int_setup;
+/* linked list transfer, the direction is from the perspective of the chip */
+bool PcieDmaLinkedListTransfer(bool host_to_chip, uint64_t list_addr, uint64_t msi_completion_addr,
+			       uint8_t completion_data)
+{
+	struct pcie_dma_xfer xfer = {
+		.list_addr = list_addr,
+		.msi_completion_addr = msi_completion_addr,
+		.completion_data = completion_data,
+		.linked_list = true,
+	};
 
-	int_setup.val = 0;
-	int_setup.f.rsie = 1;
-	int_setup.f.raie = 1;
-	WriteDbiReg(HDMA_REG_ADDR(INT_SETUP_OFF_RDCH_0), int_setup.val);
-	WriteDbiReg(HDMA_REG_ADDR(MSI_STOP_LOW_OFF_RDCH_0), low32(msi_completion_addr));
-	WriteDbiReg(HDMA_REG_ADDR(MSI_STOP_HIGH_OFF_RDCH_0), high32(msi_completion_addr));
-	WriteDbiReg(HDMA_REG_ADDR(MSI_ABORT_LOW_OFF_RDCH_0),
-		    low32(msi_completion_addr + sizeof(uint32_t)));
-	WriteDbiReg(HDMA_REG_ADDR(MSI_ABORT_HIGH_OFF_RDCH_0),
-		    high32(msi_completion_addr + sizeof(uint32_t)));
-	WriteDbiReg(HDMA_REG_ADDR(MSI_MSGD_OFF_RDCH_0), completion_data);
-
-	/* Enable read channel 0 */
-	WriteDbiReg(HDMA_REG_ADDR(EN_OFF_RDCH_0), 0x1);
-
-	WriteDbiReg(HDMA_REG_ADDR(SAR_LOW_OFF_RDCH_0), low32(host_addr));
-	WriteDbiReg(HDMA_REG_ADDR(SAR_HIGH_OFF_RDCH_0), high32(host_addr));
-	WriteDbiReg(HDMA_REG_ADDR(DAR_LOW_OFF_RDCH_0), low32(chip_addr));
-	WriteDbiReg(HDMA_REG_ADDR(DAR_HIGH_OFF_RDCH_0), high32(chip_addr));
-	WriteDbiReg(HDMA_REG_ADDR(XFERSIZE_OFF_RDCH_0), transfer_size_bytes);
-	WriteDbiReg(HDMA_REG_ADDR(DOORBELL_OFF_RDCH_0), 0x1);
-
-	return true;
+	return submit_transfer(host_to_chip, &xfer);
 }
 
 static uint8_t pcie_dma_transfer_handler(const union request *request, struct response *response)
@@ -205,5 +261,34 @@ static uint8_t pcie_dma_transfer_handler(const union request *request, struct re
 	return accept ? 0 : 1;
 }
 
+/** @brief Handles the request to start a linked list PCIe DMA transfer
+ * @param[in] request The request, of type @ref pcie_dma_ll_rqst
+ * @param[out] response Unused
+ * @return 0 if the transfer was started or queued, 1 if the pending queue is full
+ */
+static uint8_t pcie_dma_ll_transfer_handler(const union request *request,
+					    struct response *response)
+{
+	const struct pcie_dma_ll_rqst *rqst = &request->pcie_dma_ll;
+	uint64_t list_addr = ((uint64_t)rqst->list_addr_high << 32) | rqst->list_addr_low;
+	uint64_t msi_completion_addr =
+		((uint64_t)rqst->msi_completion_addr_high << 32) | rqst->msi_completion_addr_low;
+	bool accept = PcieDmaLinkedListTransfer(rqst->host_to_chip, list_addr, msi_completion_addr,
+						rqst->completion_data);
+
+	return accept ? 0 : 1;
+}
+
+static int pcie_dma_init(void)
+{
+	dma_queue_init(&pcie_dma_queues[0], &pcie_dma_write_pending, alloc_channel, start_transfer,
+		       poll_pending);
+	dma_queue_init(&pcie_dma_queues[1], &pcie_dma_read_pending, alloc_channel, start_transfer,
+		       poll_pending);
+	return 0;
+}
+SYS_INIT_APP(pcie_dma_init);
+
 REGISTER_MESSAGE(TT_SMC_MSG_PCIE_DMA_HOST_TO_CHIP_TRANSFER, pcie_dma_transfer_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_PCIE_DMA_CHIP_TO_HOST_TRANSFER, pcie_dma_transfer_handler);
+REGISTER_MESSAGE(TT_SMC_MSG_PCIE_DMA_LL_TRANSFER, pcie_dma_ll_transfer_handler);
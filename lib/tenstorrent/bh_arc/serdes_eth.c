@@ -40,12 +40,22 @@ static int NOC2AxiWrite32SerdesReg(uint8_t *src, uint8_t *dst, size_t len)
 	return 0;
 }
 
-void LoadSerdesEthRegs(uint32_t serdes_inst, uint32_t ring, uint8_t *buf, size_t buf_size,
-		       size_t spi_address, size_t image_size)
+/* The register table is checked against data_crc as it is written, there is no second pass */
+int LoadSerdesEthRegs(uint32_t serdes_inst, uint32_t ring, uint8_t *buf, size_t buf_size,
+		      size_t spi_address, size_t image_size, uint32_t data_crc)
 {
+	struct tt_boot_fs_cksum_ctx cksum;
+	int rc;
+
 	SetupSerdesTlb(serdes_inst, ring, SERDES_INST_BASE_ADDR(serdes_inst) + CMN_OFFSET);
-	spi_transfer_by_parts(flash, spi_address, image_size, buf, buf_size, NULL,
-			      NOC2AxiWrite32SerdesReg);
+	tt_boot_fs_cksum_init(&cksum);
+	rc = spi_transfer_by_parts(flash, spi_address, image_size, buf, buf_size, NULL,
+				   NOC2AxiWrite32SerdesReg, &cksum);
+	if (rc < 0) {
+		return rc;
+	}
+
+	return tt_boot_fs_cksum_final(&cksum) == data_crc ? 0 : -EIO;
 }
 
 int LoadSerdesEthFw(uint32_t serdes_inst, uint32_t ring, uint8_t *buf, size_t buf_size,
@@ -57,7 +67,7 @@ int LoadSerdesEthFw(uint32_t serdes_inst, uint32_t ring, uint8_t *buf, size_t bu
 	volatile uint32_t *serdes_tlb =
 		GetTlbWindowAddr(ring, SERDES_ETH_SETUP_TLB, SERDES_INST_SRAM_ADDR(serdes_inst));
 	rc = spi_arc_dma_transfer_to_tile(flash, spi_address, image_size, buf, buf_size,
-					  (uint8_t *)serdes_tlb);
+					  (uint8_t *)serdes_tlb, NULL);
 
 	return rc;
 }
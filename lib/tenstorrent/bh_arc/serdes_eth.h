@@ -38,8 +38,8 @@ typedef struct {
 	uint32_t data;
 } SerdesRegData;
 
-void LoadSerdesEthRegs(uint32_t serdes_inst, uint32_t ring, uint8_t *buf, size_t buf_size,
-		       size_t spi_address, size_t image_size);
+int LoadSerdesEthRegs(uint32_t serdes_inst, uint32_t ring, uint8_t *buf, size_t buf_size,
+		      size_t spi_address, size_t image_size, uint32_t data_crc);
 int LoadSerdesEthFw(uint32_t serdes_inst, uint32_t ring, uint8_t *buf, size_t buf_size,
 		    size_t spi_address, size_t image_size);
 
@@ -4,8 +4,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include "fw_image_cache.h"
 #include "reg.h"
 #include "status_reg.h"
+#include "timer.h"
 #include "util.h"
 
 #include <stdbool.h>
@@ -23,19 +25,33 @@
 
 #define SPI_PAGE_SIZE   256
 #define SECTOR_SIZE     4096
-#define SPI_BUFFER_SIZE 4096
+#define SPI_BUFFER_SIZE CONFIG_TT_BH_ARC_SPI_BUFFER_SIZE
 #define BYTE_GET(v, b)  FIELD_GET(0xFFu << ((b) * 8), (v))
 
 #define SSI_RX_DLY_SR_DEPTH            64
 #define SPI_RX_SAMPLE_DELAY_TRAIN_ADDR 0x13FFC
 #define SPI_RX_SAMPLE_DELAY_TRAIN_DATA 0xA5A55A5A
 
+#ifdef CONFIG_ZTEST
+#define STATIC
+#else
+#define STATIC static
+#endif
+
 LOG_MODULE_REGISTER(spi_eeprom, CONFIG_TT_APP_LOG_LEVEL);
 
+BUILD_ASSERT(IS_POWER_OF_TWO(SPI_BUFFER_SIZE), "SPI buffer size must be a power of two");
+/* Only whole sectors can share an erase, so a flash update needs room for at least one beside
+ * its manifest
+ */
+BUILD_ASSERT(SPI_BUFFER_SIZE >= SECTOR_SIZE + CONFIG_TT_BH_ARC_FLASH_UPDATE_MAX_RANGES *
+						  sizeof(struct flash_update_range),
+	     "SPI buffer must hold a whole sector beside the largest flash update manifest");
+
 /* Temporary buffer to hold SPI page */
-static uint8_t spi_page_buf[SPI_BUFFER_SIZE];
+static uint8_t spi_page_buf[SECTOR_SIZE];
 /* Global buffer for SPI programming */
-static uint8_t spi_global_buffer[SPI_BUFFER_SIZE];
+STATIC uint8_t spi_global_buffer[SPI_BUFFER_SIZE];
 static struct flash_pages_info page_info;
 static bool flash_locked = true;
 
@@ -67,111 +83,386 @@ static int SpiBlockRead(uint32_t spi_address, uint32_t num_bytes, uint8_t *dest)
 	return rc;
 }
 
-/* automatically erases sectors and merges incoming data with existing data as needed */
-static int SpiSmartWrite(uint32_t address, const uint8_t *data, uint32_t num_bytes)
+/* Counters of the sectors visited by flash writes */
+struct flash_update_stats {
+	uint32_t bytes;
+	/* Sectors that already held the data */
+	uint32_t sectors_skipped;
+	/* Sectors where the data only cleared bits, programmed without an erase */
+	uint32_t sectors_programmed;
+	uint32_t sectors_erased;
+	/* Erase commands issued, consecutive sectors share one */
+	uint32_t erase_ops;
+	/* Refclk cycles spent in flash writes */
+	uint64_t busy_time;
+};
+
+/* Counters of the write in progress, and totals since boot */
+static struct flash_update_stats update_stats;
+static struct flash_update_stats total_stats;
+
+enum sector_action {
+	SECTOR_SKIP,
+	SECTOR_PROGRAM,
+	SECTOR_ERASE,
+};
+
+/* Consecutive whole sectors that need an erase. They are erased with a single call, so that the
+ * flash driver can use block erases, and then written from the caller's data.
+ */
+struct erase_run {
+	uint32_t addr;
+	uint32_t size;
+	const uint8_t *data;
+};
+
+/* Bytes are only programmed without an erase when they are still erased. Programming a byte
+ * a second time to clear more bits is not supported by every flash part.
+ */
+static enum sector_action ClassifySector(const uint8_t *old, const uint8_t *new, uint32_t len)
 {
-	uint32_t sector_size = page_info.size;
-	uint32_t addr = ROUND_DOWN(address, sector_size);
-	uint32_t chunk_size;
-	int rc;
-
-	__ASSERT(sector_size > sizeof(spi_page_buf), "Sector size is larger than temp buffer");
-	sys_trace_named_event("spiwrite", address, num_bytes);
+	enum sector_action action = SECTOR_SKIP;
 
-	/* Phase 1: Write first chunk (may be unaligned)*/
-	chunk_size = MIN((ROUND_UP((address + 1), sector_size) - address), num_bytes);
-	rc = flash_read(flash, addr, spi_page_buf, sector_size);
-	if (rc < 0) {
-		LOG_ERR("%s failed %sat 0x%08x: %d", "Flash read", "[phase 1] ", addr, rc);
-		return rc;
-	}
-	if (memcmp(&spi_page_buf[address - addr], data, chunk_size) != 0) {
-		/* Write this block */
-		memcpy(&spi_page_buf[address - addr], data, chunk_size);
-		rc = flash_erase(flash, addr, sector_size);
-		if (rc < 0) {
-			LOG_ERR("%s failed %sat 0x%08x: %d", "Flash erase", "[phase 1] ", addr, rc);
-			return rc;
+	for (uint32_t i = 0; i < len; i++) {
+		if (old[i] == new[i]) {
+			continue;
 		}
-		rc = flash_write(flash, addr, spi_page_buf, sector_size);
-		if (rc < 0) {
-			LOG_ERR("%s failed %sat 0x%08x: %d", "Flash write", "[phase 1] ", addr, rc);
-			return rc;
+		if (old[i] != 0xFF) {
+			return SECTOR_ERASE;
 		}
+		action = SECTOR_PROGRAM;
 	}
-	addr += sector_size;
-	data += chunk_size;
-	num_bytes -= chunk_size;
 
-	/* Phase 2: Write aligned data  */
-	while (num_bytes > sector_size) {
+	return action;
+}
+
+/* Program the bytes of [addr, addr + len) that differ from old, which are all erased */
+static int ProgramChanges(uint32_t addr, const uint8_t *old, const uint8_t *new, uint32_t len)
+{
+	for (uint32_t i = 0; i < len;) {
+		uint32_t start = i;
+		int rc;
+
+		if (old[i] == new[i]) {
+			i++;
+			continue;
+		}
+		while (i < len && old[i] != new[i]) {
+			i++;
+		}
 
-		rc = flash_read(flash, addr, spi_page_buf, sector_size);
+		rc = flash_write(flash, addr + start, &new[start], i - start);
 		if (rc < 0) {
-			LOG_ERR("%s failed %sat 0x%08x: %d", "Flash read", "[phase 2] ", addr, rc);
+			LOG_ERR("%s failed %sat 0x%08x: %d", "Flash write", "", addr + start, rc);
 			return rc;
 		}
-		if (memcmp(spi_page_buf, data, MIN(sector_size, sizeof(spi_page_buf))) != 0) {
-			/* Write this block */
-			rc = flash_erase(flash, addr, sector_size);
-			if (rc < 0) {
-				LOG_ERR("%s failed %sat 0x%08x: %d", "Flash erase", "[phase 2] ",
-					addr, rc);
-				return rc;
-			}
-			rc = flash_write(flash, addr, data, sector_size);
-			if (rc < 0) {
-				LOG_ERR("%s failed %sat 0x%08x: %d", "Flash write", "[phase 2] ",
-					addr, rc);
-				return rc;
-			}
-		}
-		addr += sector_size;
-		data += sector_size;
-		num_bytes -= sector_size;
 	}
 
-	if (num_bytes == 0) {
-		/* No need for phase 3 */
+	return 0;
+}
+
+static int FlushEraseRun(struct erase_run *run)
+{
+	int rc;
+
+	if (run->size == 0) {
 		return 0;
 	}
 
-	/* Phase 3: Write last chunk (may be unaligned) */
-	chunk_size = num_bytes;
+	rc = flash_erase(flash, run->addr, run->size);
+	if (rc < 0) {
+		LOG_ERR("%s failed %sat 0x%08x: %d", "Flash erase", "", run->addr, rc);
+		return rc;
+	}
+	update_stats.erase_ops++;
+
+	rc = flash_write(flash, run->addr, run->data, run->size);
+	if (rc < 0) {
+		LOG_ERR("%s failed %sat 0x%08x: %d", "Flash write", "", run->addr, rc);
+		return rc;
+	}
+
+	run->size = 0;
+	return 0;
+}
+
+/* Replace [offset, offset + len) of the sector at addr with data */
+static int UpdateSector(struct erase_run *run, uint32_t addr, uint32_t offset, const uint8_t *data,
+			uint32_t len)
+{
+	uint32_t sector_size = page_info.size;
+	int rc;
+
 	rc = flash_read(flash, addr, spi_page_buf, sector_size);
 	if (rc < 0) {
-		LOG_ERR("%s failed %sat 0x%08x: %d", "Flash read", "[phase 3] ", addr, rc);
+		LOG_ERR("%s failed %sat 0x%08x: %d", "Flash read", "", addr, rc);
 		return rc;
 	}
-	if (memcmp(spi_page_buf, data, chunk_size) != 0) {
-		/* Write this block */
-		memcpy(spi_page_buf, data, chunk_size);
-		rc = flash_erase(flash, addr, sector_size);
-		if (rc < 0) {
-			LOG_ERR("%s failed %sat 0x%08x: %d", "Flash erase", "[phase 3] ", addr, rc);
-			return rc;
+
+	switch (ClassifySector(&spi_page_buf[offset], data, len)) {
+	case SECTOR_SKIP:
+		update_stats.sectors_skipped++;
+		return 0;
+
+	case SECTOR_PROGRAM:
+		update_stats.sectors_programmed++;
+		return ProgramChanges(addr + offset, &spi_page_buf[offset], data, len);
+
+	case SECTOR_ERASE:
+		update_stats.sectors_erased++;
+		break;
+	}
+
+	if (len == sector_size) {
+		if (run->size != 0 &&
+		    (run->addr + run->size != addr || run->data + run->size != data)) {
+			rc = FlushEraseRun(run);
+			if (rc < 0) {
+				return rc;
+			}
+		}
+		if (run->size == 0) {
+			run->addr = addr;
+			run->data = data;
 		}
-		rc = flash_write(flash, addr, spi_page_buf, sector_size);
+		run->size += sector_size;
+		return 0;
+	}
+
+	/* Partial sector, merge the data with the rest of the sector */
+	memcpy(&spi_page_buf[offset], data, len);
+	rc = flash_erase(flash, addr, sector_size);
+	if (rc < 0) {
+		LOG_ERR("%s failed %sat 0x%08x: %d", "Flash erase", "", addr, rc);
+		return rc;
+	}
+	update_stats.erase_ops++;
+
+	rc = flash_write(flash, addr, spi_page_buf, sector_size);
+	if (rc < 0) {
+		LOG_ERR("%s failed %sat 0x%08x: %d", "Flash write", "", addr, rc);
+	}
+	return rc;
+}
+
+/* Bytes in the pending erase run are not in flash yet, so they are only reported once it is
+ * flushed
+ */
+static void ReportProgress(const struct erase_run *run)
+{
+	WriteReg(FLASH_UPDATE_PROGRESS_REG_ADDR, update_stats.bytes - run->size);
+}
+
+static int SpiSmartWriteRange(struct erase_run *run, uint32_t address, const uint8_t *data,
+			      uint32_t num_bytes)
+{
+	uint32_t sector_size = page_info.size;
+
+	sys_trace_named_event("spiwrite", address, num_bytes);
+
+	while (num_bytes > 0) {
+		uint32_t addr = ROUND_DOWN(address, sector_size);
+		uint32_t offset = address - addr;
+		uint32_t len = MIN(sector_size - offset, num_bytes);
+		int rc = UpdateSector(run, addr, offset, data, len);
+
 		if (rc < 0) {
-			LOG_ERR("%s failed %sat 0x%08x: %d", "Flash write", "[phase 3] ", addr, rc);
 			return rc;
 		}
+
+		address += len;
+		data += len;
+		num_bytes -= len;
+
+		update_stats.bytes += len;
+		ReportProgress(run);
 	}
+
 	return 0;
 }
 
+static uint64_t FlashUpdateBegin(void)
+{
+	__ASSERT(page_info.size <= sizeof(spi_page_buf), "Sector size is larger than temp buffer");
+
+	/* Cached directory and images may no longer match the flash */
+	fw_image_cache_invalidate();
+
+	memset(&update_stats, 0, sizeof(update_stats));
+	WriteReg(FLASH_UPDATE_PROGRESS_REG_ADDR, 0);
+
+	return TimerTimestamp();
+}
+
+static void FlashUpdateEnd(uint64_t start)
+{
+	update_stats.busy_time = TimerTimestamp() - start;
+
+	total_stats.bytes += update_stats.bytes;
+	total_stats.sectors_skipped += update_stats.sectors_skipped;
+	total_stats.sectors_programmed += update_stats.sectors_programmed;
+	total_stats.sectors_erased += update_stats.sectors_erased;
+	total_stats.erase_ops += update_stats.erase_ops;
+	total_stats.busy_time += update_stats.busy_time;
+}
+
+/* Writes only the sectors that differ, erasing them only when the data sets bits */
+static int SpiSmartWrite(uint32_t address, const uint8_t *data, uint32_t num_bytes)
+{
+	struct erase_run run = {0};
+	uint64_t start = FlashUpdateBegin();
+	int rc = SpiSmartWriteRange(&run, address, data, num_bytes);
+
+	if (rc == 0) {
+		rc = FlushEraseRun(&run);
+		ReportProgress(&run);
+	}
+
+	FlashUpdateEnd(start);
+	return rc;
+}
+
+static int SpiManifestWrite(const struct flash_update_range *ranges, uint32_t num_ranges)
+{
+	struct erase_run run = {0};
+	uint64_t start = FlashUpdateBegin();
+	int rc = 0;
+
+	for (uint32_t i = 0; i < num_ranges && rc == 0; i++) {
+		rc = SpiSmartWriteRange(&run, ranges[i].spi_addr,
+					(const uint8_t *)ranges[i].data_addr, ranges[i].num_bytes);
+	}
+
+	if (rc == 0) {
+		rc = FlushEraseRun(&run);
+		ReportProgress(&run);
+	}
+
+	FlashUpdateEnd(start);
+	return rc;
+}
+
 /* If we are using the spi buffer memory type, */
 /* then make sure the passed in address and length is actually within the spi_buffer bounds. */
 static bool check_csm_region(uint32_t addr, uint32_t num_bytes)
 {
-	return addr < (uint32_t)spi_global_buffer ||
-	       (addr + num_bytes) > ((uint32_t)spi_global_buffer + sizeof(spi_global_buffer));
+	uint32_t start = (uint32_t)spi_global_buffer;
+	uint32_t end = start + sizeof(spi_global_buffer);
+
+	/* Written so that addr + num_bytes can't wrap around */
+	return addr < start || addr > end || num_bytes > end - addr;
+}
+
+/* SPI reads and writes are run on their own work queue with a deferred response, so that other
+ * host messages and system work queue items are not blocked behind them. They are queued in order,
+ * so reads still observe earlier writes. Flash lock and unlock are queued with them, so each write
+ * sees the lock state the host set before sending it.
+ */
+struct eeprom_op {
+	union request request;
+	/* Flash update manifest, copied out of the SPI buffer before it is checked, so that the
+	 * host can't change it between the check and the update.
+	 */
+	struct flash_update_range ranges[CONFIG_TT_BH_ARC_FLASH_UPDATE_MAX_RANGES];
+	struct msgqueue_deferred_response deferred;
+};
+
+/* Each op holds a reserved response slot, which bounds the number of ops in flight. */
+K_MSGQ_DEFINE(eeprom_ops, sizeof(struct eeprom_op), NUM_MSG_QUEUES * MSG_QUEUE_SIZE, 4);
+
+static uint8_t run_flash_update(const struct eeprom_op *op, struct response *response)
+{
+	const struct flash_update_stats *stats = &total_stats;
+	uint16_t num_ranges = op->request.flash_update.num_ranges;
+	int rc = 0;
+
+	if (num_ranges != 0) {
+		rc = SpiManifestWrite(op->ranges, num_ranges);
+		stats = &update_stats;
+	}
+
+	response->data[1] = stats->bytes;
+	response->data[2] = stats->sectors_skipped;
+	response->data[3] = stats->sectors_programmed;
+	response->data[4] = stats->sectors_erased;
+	response->data[5] = stats->erase_ops;
+	response->data[6] = MIN(stats->busy_time / REFCLK_F_MHZ, UINT32_MAX);
+
+	return rc;
+}
+
+static uint8_t run_eeprom_op(const struct eeprom_op *op, struct response *response)
+{
+	const union request *request = &op->request;
+	uint32_t spi_address = request->data[1];
+	uint32_t num_bytes = request->data[2];
+	uint8_t *csm_addr = (uint8_t *)request->data[3];
+
+	switch (request->command_code) {
+	case TT_SMC_MSG_FLASH_LOCK:
+		flash_locked = true;
+		return 0;
+	case TT_SMC_MSG_FLASH_UNLOCK:
+		flash_locked = false;
+		return 0;
+	case TT_SMC_MSG_FLASH_UPDATE:
+		if (request->flash_update.num_ranges != 0 && flash_locked) {
+			return 2;
+		}
+		return run_flash_update(op, response);
+	case TT_SMC_MSG_WRITE_EEPROM:
+		if (flash_locked) {
+			/* Flash is locked; cannot write */
+			return 2;
+		}
+		return SpiSmartWrite(spi_address, csm_addr, num_bytes);
+	default:
+		return SpiBlockRead(spi_address, num_bytes, csm_addr);
+	}
+}
+
+static void eeprom_work_handler(struct k_work *work)
+{
+	struct eeprom_op op;
+
+	while (k_msgq_get(&eeprom_ops, &op, K_NO_WAIT) == 0) {
+		struct response response = {0};
+
+		uint8_t exit_code = run_eeprom_op(&op, &response);
+
+		msgqueue_complete_response(&op.deferred, &response, exit_code);
+	}
+}
+static K_WORK_DEFINE(eeprom_work, eeprom_work_handler);
+
+static K_THREAD_STACK_DEFINE(eeprom_work_q_stack, CONFIG_TT_BH_ARC_EEPROM_THREAD_STACK_SIZE);
+static struct k_work_q eeprom_work_q;
+
+/* Every op runs on the eeprom work queue, which owns spi_page_buf, the update statistics and the
+ * flash lock state. Running an op anywhere else would race with it and overtake queued ops.
+ */
+static uint8_t defer_eeprom_op(struct eeprom_op *op, struct response *response)
+{
+	/* Only the message dispatcher queues ops, so the free space can't change under us. */
+	if (k_msgq_num_free_get(&eeprom_ops) == 0) {
+		/* Busy, the host may retry once earlier ops have completed */
+		return 3;
+	}
+
+	/* Fails for batch sub-requests, which share the batch's response slot */
+	if (msgqueue_defer_response(&op->deferred) != 0) {
+		return 0xff;
+	}
+
+	k_msgq_put(&eeprom_ops, op, K_NO_WAIT);
+	k_work_submit_to_queue(&eeprom_work_q, &eeprom_work);
+
+	return 0;
 }
 
 static uint8_t read_eeprom_handler(const union request *request, struct response *response)
 {
 	uint8_t buffer_mem_type = BYTE_GET(request->data[0], 1);
-	uint32_t spi_address = request->data[1];
 	uint32_t num_bytes = request->data[2];
 	uint8_t *csm_addr = (uint8_t *)request->data[3];
 
@@ -189,21 +480,17 @@ static uint8_t read_eeprom_handler(const union request *request, struct response
 		return 1;
 	}
 
-	return SpiBlockRead(spi_address, num_bytes, csm_addr);
+	struct eeprom_op op = {.request = *request};
+
+	return defer_eeprom_op(&op, response);
 }
 
 static uint8_t write_eeprom_handler(const union request *request, struct response *response)
 {
 	uint8_t buffer_mem_type = BYTE_GET(request->data[0], 1);
-	uint32_t spi_address = request->data[1];
 	uint32_t num_bytes = request->data[2];
 	uint8_t *csm_addr = (uint8_t *)request->data[3];
 
-	if (flash_locked) {
-		/* Flash is locked; cannot write */
-		return 2;
-	}
-
 	if (!device_is_ready(flash)) {
 		/* Flash init failed */
 		return 1;
@@ -218,7 +505,48 @@ static uint8_t write_eeprom_handler(const union request *request, struct respons
 		return 1;
 	}
 
-	return SpiSmartWrite(spi_address, csm_addr, num_bytes);
+	struct eeprom_op op = {.request = *request};
+
+	return defer_eeprom_op(&op, response);
+}
+
+/** @brief Handles the request to write a manifest of SPI flash ranges
+ * @param[in] request The request, of type @ref flash_update_rqst
+ * @param[out] response data[1]: bytes written, data[2]: sectors skipped, data[3]: sectors
+ *	programmed without an erase, data[4]: sectors erased, data[5]: erase commands,
+ *	data[6]: time spent in microseconds. Counters are for this update, or since boot when
+ *	@ref flash_update_rqst::num_ranges is 0.
+ * @return 0 for success, 1 if flash is not available, 2 if flash is locked, the manifest has
+ *	more than CONFIG_TT_BH_ARC_FLASH_UPDATE_MAX_RANGES ranges, or the manifest or data are
+ *	outside of the SPI programming buffer, otherwise the flash error
+ */
+static uint8_t flash_update_handler(const union request *request, struct response *response)
+{
+	const struct flash_update_rqst *rqst = &request->flash_update;
+	struct eeprom_op op = {.request = *request};
+	size_t manifest_size = rqst->num_ranges * sizeof(struct flash_update_range);
+
+	if (!device_is_ready(flash)) {
+		return 1;
+	}
+
+	if (rqst->num_ranges != 0) {
+		if (rqst->num_ranges > ARRAY_SIZE(op.ranges) ||
+		    !IS_ALIGNED(rqst->manifest_addr, sizeof(uint32_t)) ||
+		    check_csm_region(rqst->manifest_addr, manifest_size)) {
+			return 2;
+		}
+
+		/* Check the copy that is used for the update, not the SPI buffer */
+		memcpy(op.ranges, (const void *)rqst->manifest_addr, manifest_size);
+		for (uint32_t i = 0; i < rqst->num_ranges; i++) {
+			if (check_csm_region(op.ranges[i].data_addr, op.ranges[i].num_bytes)) {
+				return 2;
+			}
+		}
+	}
+
+	return defer_eeprom_op(&op, response);
 }
 
 /* Challenge message issued from tt-flash to confirm a firmware update. */
@@ -230,25 +558,35 @@ static uint8_t confirm_flashed_spi_handler(const union request *request, struct
 
 static uint8_t flash_lock_handler(const union request *request, struct response *response)
 {
-	flash_locked = true;
-	return 0;
+	struct eeprom_op op = {.request = *request};
+
+	return defer_eeprom_op(&op, response);
 }
 
 static uint8_t flash_unlock_handler(const union request *request, struct response *response)
 {
-	flash_locked = false;
-	return 0;
+	struct eeprom_op op = {.request = *request};
+
+	return defer_eeprom_op(&op, response);
 }
 
 REGISTER_MESSAGE(TT_SMC_MSG_READ_EEPROM, read_eeprom_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_WRITE_EEPROM, write_eeprom_handler);
+REGISTER_MESSAGE(TT_SMC_MSG_FLASH_UPDATE, flash_update_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_CONFIRM_FLASHED_SPI, confirm_flashed_spi_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_FLASH_LOCK, flash_lock_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_FLASH_UNLOCK, flash_unlock_handler);
 
 static int InitSpiFS(void)
 {
-	if (!IS_ENABLED(CONFIG_ARC)) {
+	const struct k_work_queue_config cfg = {.name = "eeprom"};
+
+	k_work_queue_start(&eeprom_work_q, eeprom_work_q_stack,
+			   K_THREAD_STACK_SIZEOF(eeprom_work_q_stack),
+			   CONFIG_TT_BH_ARC_EEPROM_THREAD_PRIORITY, &cfg);
+
+	/* native_sim builds only have SPI flash when a test labels a flash simulator spi_flash */
+	if (!IS_ENABLED(CONFIG_ARC) && !device_is_ready(flash)) {
 		return 0;
 	}
 
@@ -5,6 +5,7 @@
  */
 
 #include "arc_dma.h"
+#include "fw_image_cache.h"
 
 #include <stdlib.h>
 
@@ -18,7 +19,8 @@ LOG_MODULE_REGISTER(spi_flash_buf, CONFIG_TT_APP_LOG_LEVEL);
 
 int spi_transfer_by_parts(const struct device *dev, size_t spi_address, size_t image_size,
 			  uint8_t *buf, size_t buf_size, uint8_t *tlb_dst,
-			  int (*cb)(uint8_t *src, uint8_t *dst, size_t len))
+			  int (*cb)(uint8_t *src, uint8_t *dst, size_t len),
+			  struct tt_boot_fs_cksum_ctx *cksum)
 {
 	if ((buf == NULL) || (buf_size == 0)) {
 		return -EINVAL;
@@ -33,10 +35,16 @@ int spi_transfer_by_parts(const struct device *dev, size_t spi_address, size_t i
 	for (size_t offset = 0, len = MIN(buf_size, image_size); len > 0;
 	     image_size -= len, offset += len, len = MIN(buf_size, image_size)) {
 
-		rc = flash_read(dev, spi_address + offset, buf, len);
-		if (rc < 0) {
-			LOG_ERR("%s() failed: %d", "flash_read", rc);
-			break;
+		if (!fw_image_cache_copy(spi_address + offset, buf, len)) {
+			rc = flash_read(dev, spi_address + offset, buf, len);
+			if (rc < 0) {
+				LOG_ERR("%s() failed: %d", "flash_read", rc);
+				break;
+			}
+		}
+
+		if (cksum != NULL) {
+			tt_boot_fs_cksum_update(cksum, buf, len);
 		}
 
 		rc = cb(buf, tlb_dst + offset, len);
@@ -56,9 +64,134 @@ static int arc_dma_transfer_wrapper(uint8_t *src, uint8_t *dst, size_t len)
 	return 0;
 }
 
+static int spi_dma_start(struct arc_dma_waiter *waiter, uint8_t *src, uint8_t *dst, size_t len)
+{
+	struct arc_dma_copy copy = {
+		.src = src,
+		.dst = dst,
+		.len = len,
+	};
+
+	ArcDmaWaiterInit(waiter);
+
+	int rc = ArcDmaSubmit(&copy, 1, ArcDmaWaiterCallback, waiter);
+
+	if (rc < 0) {
+		LOG_ERR("%s() failed: %d", "ArcDmaSubmit", rc);
+	}
+
+	return rc;
+}
+
+static int spi_dma_wait(struct arc_dma_waiter *waiter)
+{
+	int rc = ArcDmaWait(waiter);
+
+	if (rc < 0) {
+		LOG_ERR("%s() failed: %d", "ArcDmaWait", rc);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+/* Splits buf in two halves, so that the flash read into one half overlaps the DMA of the other
+ * half to the tile.
+ */
+static int spi_dma_transfer_pipelined(const struct device *dev, size_t spi_address,
+				      size_t image_size, uint8_t *buf, size_t chunk_size,
+				      uint8_t *tlb_dst, struct tt_boot_fs_cksum_ctx *cksum)
+{
+	struct arc_dma_waiter waiter;
+	bool dma_pending = false;
+	size_t len;
+	int rc = 0;
+
+	for (size_t offset = 0, i = 0; offset < image_size; offset += len, i++) {
+		uint8_t *chunk = buf + (i % 2) * chunk_size;
+
+		len = MIN(chunk_size, image_size - offset);
+
+		/* The DMA of this half was waited for before the other half was sent. The start of
+		 * an image that is too large to cache whole may still be resident.
+		 */
+		if (!fw_image_cache_copy(spi_address + offset, chunk, len)) {
+			rc = flash_read(dev, spi_address + offset, chunk, len);
+			if (rc < 0) {
+				LOG_ERR("%s() failed: %d", "flash_read", rc);
+				break;
+			}
+		}
+
+		/* Summed while the other half is still in flight */
+		if (cksum != NULL) {
+			tt_boot_fs_cksum_update(cksum, chunk, len);
+		}
+
+		if (dma_pending) {
+			rc = spi_dma_wait(&waiter);
+			dma_pending = false;
+			if (rc < 0) {
+				break;
+			}
+		}
+
+		rc = spi_dma_start(&waiter, chunk, tlb_dst + offset, len);
+		if (rc < 0) {
+			break;
+		}
+		dma_pending = true;
+	}
+
+	if (dma_pending) {
+		int wait_rc = spi_dma_wait(&waiter);
+
+		if (rc == 0) {
+			rc = wait_rc;
+		}
+	}
+
+	return rc;
+}
+
 int spi_arc_dma_transfer_to_tile(const struct device *dev, size_t spi_address, size_t image_size,
-				 uint8_t *buf, size_t buf_size, uint8_t *tlb_dst)
+				 uint8_t *buf, size_t buf_size, uint8_t *tlb_dst,
+				 struct tt_boot_fs_cksum_ctx *cksum)
 {
-	return spi_transfer_by_parts(dev, spi_address, image_size, buf, buf_size, tlb_dst,
-				     arc_dma_transfer_wrapper);
+	size_t chunk_size = ROUND_DOWN(buf_size / 2, sizeof(uint32_t));
+
+	if ((buf == NULL) || (buf_size == 0)) {
+		return -EINVAL;
+	}
+
+	if (image_size > (size_t)INT32_MAX) {
+		return -E2BIG;
+	}
+
+	/* Resident images are sent in a single DMA straight from the cache */
+	const uint8_t *cached = fw_image_cache_get(spi_address, image_size);
+
+	if (cached != NULL) {
+		bool ok = ArcDmaTransfer(cached, tlb_dst, image_size);
+
+		if (cksum != NULL) {
+			tt_boot_fs_cksum_update(cksum, cached, image_size);
+		}
+
+		fw_image_cache_put();
+		if (!ok) {
+			LOG_ERR("%s() failed: %d", "ArcDmaTransfer", -EIO);
+			return -EIO;
+		}
+		return 0;
+	}
+
+	/* Images that fit in one buffer gain nothing from pipelining */
+	if ((chunk_size == 0) || (image_size <= buf_size)) {
+		return spi_transfer_by_parts(dev, spi_address, image_size, buf, buf_size, tlb_dst,
+					     arc_dma_transfer_wrapper, cksum);
+	}
+
+	return spi_dma_transfer_pipelined(dev, spi_address, image_size, buf, chunk_size, tlb_dst,
+					  cksum);
 }
@@ -56,6 +56,36 @@
 #define I2C0_TARGET_DEBUG_STATE_REG_ADDR     RESET_UNIT_SCRATCH_RAM_REG_ADDR(19)
 #define I2C0_TARGET_DEBUG_STATE_2_REG_ADDR   RESET_UNIT_SCRATCH_RAM_REG_ADDR(20)
 #define ARC_HANG_PC                          RESET_UNIT_SCRATCH_RAM_REG_ADDR(21)
+/**
+ * @ingroup telemetry
+ * @brief Register holding the telemetry snapshot sequence number.
+ *
+ * Odd while a snapshot is being written. See @ref telemetry_snapshots for the read protocol.
+ */
+#define TELEMETRY_SNAPSHOT_SEQ_REG_ADDR      RESET_UNIT_SCRATCH_RAM_REG_ADDR(22)
+/**
+ * @ingroup telemetry
+ * @brief Register address pointing to the two telemetry snapshot buffers.
+ */
+#define TELEMETRY_SNAPSHOT_REG_ADDR          RESET_UNIT_SCRATCH_RAM_REG_ADDR(23)
+/**
+ * @ingroup telemetry
+ * @brief Register address pointing to the telemetry stream ring buffer header.
+ */
+#define TELEMETRY_STREAM_REG_ADDR            RESET_UNIT_SCRATCH_RAM_REG_ADDR(24)
+/**
+ * @ingroup telemetry
+ * @brief Register holding a hash of the telemetry table layout.
+ *
+ * Changes whenever the version or the tag to offset mapping of the telemetry table changes.
+ */
+#define TELEMETRY_LAYOUT_HASH_REG_ADDR       RESET_UNIT_SCRATCH_RAM_REG_ADDR(25)
+/* Bytes processed so far by the SPI flash write or update in progress */
+#define FLASH_UPDATE_PROGRESS_REG_ADDR       RESET_UNIT_SCRATCH_RAM_REG_ADDR(26)
+/* Address of the DVFS trace ring buffer header, see dvfs_trace.c */
+#define DVFS_TRACE_REG_ADDR                  RESET_UNIT_SCRATCH_RAM_REG_ADDR(27)
+/* Address of the V/F curve lookup table, see vf_curve.c */
+#define VF_CURVE_TABLE_REG_ADDR              RESET_UNIT_SCRATCH_RAM_REG_ADDR(28)
 
 #define STATUS_FW_VUART_REG_ADDR(n)          RESET_UNIT_SCRATCH_RAM_REG_ADDR(40 + (n))
 /* SCRATCH_RAM_40 - SCRATCH_RAM_41 reserved for virtual uarts */
@@ -18,10 +18,13 @@
 
 #include <float.h> /* for FLT_MAX */
 #include <math.h>  /* for floor */
+#include <stdatomic.h>
 #include <stdint.h>
 #include <string.h>
 
+#include <tenstorrent/msgqueue.h>
 #include <tenstorrent/post_code.h>
+#include <tenstorrent/smc_msg.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/drivers/misc/bh_fwtable.h>
 #include <zephyr/device.h>
@@ -60,6 +63,13 @@ struct telemetry_entry {
 	uint16_t offset;
 };
 
+/* Only the tags in TELEMETRY_TABLE_TAGS are published, so the table has no unused entries */
+#define TELEM_TABLE_ENTRY(tag)       {tag, TELEM_OFFSET(tag)},
+#define TELEM_TABLE_COUNT_ENTRY(tag) +1
+#define TELEM_TABLE_ENTRY_COUNT      (0 TELEMETRY_TABLE_TAGS(TELEM_TABLE_COUNT_ENTRY))
+
+BUILD_ASSERT(TELEM_TABLE_ENTRY_COUNT <= TAG_COUNT);
+
 /**
  * @brief Represents the telemetry table containing telemetry data and metadata.
  */
@@ -77,7 +87,7 @@ struct telemetry_table {
 	/**
 	 * @brief The table mapping telemetry tags to their offsets.
 	 */
-	struct telemetry_entry tag_table[TAG_COUNT];
+	struct telemetry_entry tag_table[TELEM_TABLE_ENTRY_COUNT];
 
 	/**
 	 * @brief The telemetry data corresponding to the tags.
@@ -100,69 +110,8 @@ struct telemetry_table {
  * The address of this table is published in the @ref TELEMETRY_TABLE_REG_ADDR register.
  */
 
-/* clang-format off */
 static struct telemetry_table telemetry_table = {
-	.tag_table = {
-		[0] = {TAG_BOARD_ID_HIGH, TELEM_OFFSET(TAG_BOARD_ID_HIGH)},
-		[1] = {TAG_BOARD_ID_LOW, TELEM_OFFSET(TAG_BOARD_ID_LOW)},
-		[3] = {TAG_HARVESTING_STATE, TELEM_OFFSET(TAG_HARVESTING_STATE)},
-		[4] = {TAG_UPDATE_TELEM_SPEED, TELEM_OFFSET(TAG_UPDATE_TELEM_SPEED)},
-		[5] = {TAG_VCORE, TELEM_OFFSET(TAG_VCORE)},
-		[6] = {TAG_TDP, TELEM_OFFSET(TAG_TDP)},
-		[7] = {TAG_TDC, TELEM_OFFSET(TAG_TDC)},
-		[8] = {TAG_VDD_LIMITS, TELEM_OFFSET(TAG_VDD_LIMITS)},
-		[9] = {TAG_THM_LIMIT_SHUTDOWN, TELEM_OFFSET(TAG_THM_LIMIT_SHUTDOWN)},
-		[10] = {TAG_ASIC_TEMPERATURE, TELEM_OFFSET(TAG_ASIC_TEMPERATURE)},
-		[11] = {TAG_VREG_TEMPERATURE, TELEM_OFFSET(TAG_VREG_TEMPERATURE)},
-		[12] = {TAG_BOARD_TEMPERATURE, TELEM_OFFSET(TAG_BOARD_TEMPERATURE)},
-		[13] = {TAG_AICLK, TELEM_OFFSET(TAG_AICLK)},
-		[14] = {TAG_AXICLK, TELEM_OFFSET(TAG_AXICLK)},
-		[15] = {TAG_ARCCLK, TELEM_OFFSET(TAG_ARCCLK)},
-		[16] = {TAG_L2CPUCLK0, TELEM_OFFSET(TAG_L2CPUCLK0)},
-		[17] = {TAG_L2CPUCLK1, TELEM_OFFSET(TAG_L2CPUCLK1)},
-		[18] = {TAG_L2CPUCLK2, TELEM_OFFSET(TAG_L2CPUCLK2)},
-		[19] = {TAG_L2CPUCLK3, TELEM_OFFSET(TAG_L2CPUCLK3)},
-		[20] = {TAG_ETH_LIVE_STATUS, TELEM_OFFSET(TAG_ETH_LIVE_STATUS)},
-		[21] = {TAG_GDDR_STATUS, TELEM_OFFSET(TAG_GDDR_STATUS)},
-		[22] = {TAG_GDDR_SPEED, TELEM_OFFSET(TAG_GDDR_SPEED)},
-		[23] = {TAG_ETH_FW_VERSION, TELEM_OFFSET(TAG_ETH_FW_VERSION)},
-		[24] = {TAG_GDDR_FW_VERSION, TELEM_OFFSET(TAG_GDDR_FW_VERSION)},
-		[25] = {TAG_DM_APP_FW_VERSION, TELEM_OFFSET(TAG_DM_APP_FW_VERSION)},
-		[26] = {TAG_DM_BL_FW_VERSION, TELEM_OFFSET(TAG_DM_BL_FW_VERSION)},
-		[27] = {TAG_FLASH_BUNDLE_VERSION, TELEM_OFFSET(TAG_FLASH_BUNDLE_VERSION)},
-		[28] = {TAG_CM_FW_VERSION, TELEM_OFFSET(TAG_CM_FW_VERSION)},
-		[29] = {TAG_L2CPU_FW_VERSION, TELEM_OFFSET(TAG_L2CPU_FW_VERSION)},
-		[30] = {TAG_FAN_SPEED, TELEM_OFFSET(TAG_FAN_SPEED)},
-		[31] = {TAG_TIMER_HEARTBEAT, TELEM_OFFSET(TAG_TIMER_HEARTBEAT)},
-		[32] = {TAG_ENABLED_TENSIX_COL, TELEM_OFFSET(TAG_ENABLED_TENSIX_COL)},
-		[33] = {TAG_ENABLED_ETH, TELEM_OFFSET(TAG_ENABLED_ETH)},
-		[34] = {TAG_ENABLED_GDDR, TELEM_OFFSET(TAG_ENABLED_GDDR)},
-		[35] = {TAG_ENABLED_L2CPU, TELEM_OFFSET(TAG_ENABLED_L2CPU)},
-		[36] = {TAG_PCIE_USAGE, TELEM_OFFSET(TAG_PCIE_USAGE)},
-		[37] = {TAG_NOC_TRANSLATION, TELEM_OFFSET(TAG_NOC_TRANSLATION)},
-		[38] = {TAG_FAN_RPM, TELEM_OFFSET(TAG_FAN_RPM)},
-		[39] = {TAG_GDDR_0_1_TEMP, TELEM_OFFSET(TAG_GDDR_0_1_TEMP)},
-		[40] = {TAG_GDDR_2_3_TEMP, TELEM_OFFSET(TAG_GDDR_2_3_TEMP)},
-		[41] = {TAG_GDDR_4_5_TEMP, TELEM_OFFSET(TAG_GDDR_4_5_TEMP)},
-		[42] = {TAG_GDDR_6_7_TEMP, TELEM_OFFSET(TAG_GDDR_6_7_TEMP)},
-		[43] = {TAG_GDDR_0_1_CORR_ERRS, TELEM_OFFSET(TAG_GDDR_0_1_CORR_ERRS)},
-		[44] = {TAG_GDDR_2_3_CORR_ERRS, TELEM_OFFSET(TAG_GDDR_2_3_CORR_ERRS)},
-		[45] = {TAG_GDDR_4_5_CORR_ERRS, TELEM_OFFSET(TAG_GDDR_4_5_CORR_ERRS)},
-		[46] = {TAG_GDDR_6_7_CORR_ERRS, TELEM_OFFSET(TAG_GDDR_6_7_CORR_ERRS)},
-		[47] = {TAG_GDDR_UNCORR_ERRS, TELEM_OFFSET(TAG_GDDR_UNCORR_ERRS)},
-		[48] = {TAG_MAX_GDDR_TEMP, TELEM_OFFSET(TAG_MAX_GDDR_TEMP)},
-		[49] = {TAG_ASIC_LOCATION, TELEM_OFFSET(TAG_ASIC_LOCATION)},
-		[50] = {TAG_BOARD_POWER_LIMIT, TELEM_OFFSET(TAG_BOARD_POWER_LIMIT)},
-		[51] = {TAG_INPUT_POWER, TELEM_OFFSET(TAG_INPUT_POWER)},
-		[52] = {TAG_ASIC_ID_HIGH, TELEM_OFFSET(TAG_ASIC_ID_HIGH)},
-		[53] = {TAG_ASIC_ID_LOW, TELEM_OFFSET(TAG_ASIC_ID_LOW)},
-		[54] = {TAG_THERM_TRIP_COUNT, TELEM_OFFSET(TAG_THERM_TRIP_COUNT)},
-		[55] = {TAG_TELEM_ENUM_COUNT, TELEM_OFFSET(TAG_TELEM_ENUM_COUNT)},
-		[56] = {TAG_AICLK_LIMIT_MAX, TELEM_OFFSET(TAG_AICLK_LIMIT_MAX)},
-		[57] = {TAG_TDC_LIMIT_MAX, TELEM_OFFSET(TAG_TDC_LIMIT_MAX)},
-		[58] = {TAG_THM_LIMIT_THROTTLE, TELEM_OFFSET(TAG_THM_LIMIT_THROTTLE)},
-		[59] = {TAG_TDP_LIMIT_MAX, TELEM_OFFSET(TAG_TDP_LIMIT_MAX)},
-	},
+	.tag_table = {TELEMETRY_TABLE_TAGS(TELEM_TABLE_ENTRY)},
 };
 
 /**
@@ -173,11 +122,35 @@ static struct telemetry_table telemetry_table = {
  */
 static uint32_t *telemetry = &telemetry_table.telemetry[0];
 
+/**
+ * @brief Consistent copies of the telemetry data buffer.
+ *
+ * The telemetry data buffer is updated in place, so a reader may see multi-word values (e.g.
+ * @ref TAG_BOARD_ID_HIGH / @ref TAG_BOARD_ID_LOW) from different updates. At the end of every
+ * update the buffer is copied into one of these snapshots, alternating between them. The address
+ * of the snapshots is published in @ref TELEMETRY_SNAPSHOT_REG_ADDR and the sequence number in
+ * @ref TELEMETRY_SNAPSHOT_SEQ_REG_ADDR.
+ *
+ * The sequence number is odd while snapshot ((seq + 1) / 2) % 2 is being written, and even once
+ * it is complete. To read without locking:
+ *
+ *     s1 = seq; snapshot = telemetry_snapshots[(s1 / 2) % 2]; s2 = seq;
+ *
+ * The copy is consistent if s2 - (s1 & ~1) <= 2, i.e. the writer has not yet started
+ * overwriting the snapshot that was read. Updates are at least TELEM_MIN_PERIOD_MS (10 ms) apart,
+ * so retries are rare.
+ */
+static uint32_t telemetry_snapshots[2][TAG_COUNT];
+static uint32_t telemetry_snapshot_seq;
+
 /** @} */ /* end of telemetry_table group */
 
 static struct k_timer telem_update_timer;
 static struct k_work telem_update_worker;
+/* Timer tick, the shortest of the group refresh periods */
 static int telem_update_interval = 100;
+/* Set once StartTelemetryTimer() has started the update timer */
+static bool telem_timer_running;
 
 uint32_t ConvertFloatToTelemetry(float value)
 {
@@ -295,12 +268,41 @@ int GetMaxGDDRTemp(void)
 	return max_gddr_temp;
 }
 
+#define FNV1A_32_OFFSET_BASIS 0x811c9dc5
+#define FNV1A_32_PRIME        0x01000193
+
+static uint32_t fnv1a_32(uint32_t hash, const void *data, size_t len)
+{
+	const uint8_t *bytes = data;
+
+	for (size_t i = 0; i < len; i++) {
+		hash = (hash ^ bytes[i]) * FNV1A_32_PRIME;
+	}
+
+	return hash;
+}
+
+/* FNV-1a over the version, entry count and tag table. Host libraries can cache the tag to offset
+ * mapping and only walk the table again when this changes.
+ */
+static uint32_t telemetry_layout_hash(void)
+{
+	uint32_t hash = FNV1A_32_OFFSET_BASIS;
+
+	hash = fnv1a_32(hash, &telemetry_table.version, sizeof(telemetry_table.version));
+	hash = fnv1a_32(hash, &telemetry_table.entry_count, sizeof(telemetry_table.entry_count));
+	hash = fnv1a_32(hash, telemetry_table.tag_table, sizeof(telemetry_table.tag_table));
+
+	return hash;
+}
+
 static void write_static_telemetry(uint32_t app_version)
 {
 	telemetry_table.version = TELEMETRY_VERSION; /* v0.1.0 - Only update when redefining the
 						      * meaning of an existing tag
 						      */
-	telemetry_table.entry_count = TAG_COUNT;     /* Runtime count of telemetry entries */
+	/* Runtime count of telemetry entries, which skips the undefined tags */
+	telemetry_table.entry_count = TELEM_TABLE_ENTRY_COUNT;
 	telemetry[TAG_TELEM_ENUM_COUNT] = TAG_COUNT; /* Count of telemetry tags */
 
 	const FwTable *fw_table = tt_bh_fwtable_get_fw_table(fwtable_dev);
@@ -363,12 +365,24 @@ static void write_static_telemetry(uint32_t app_version)
 	telemetry[TAG_ASIC_LOCATION] = tt_bh_fwtable_get_asic_location(fwtable_dev);
 }
 
-static void update_telemetry(void)
+static void publish_telemetry_snapshot(void)
+{
+	uint32_t *snapshot = telemetry_snapshots[((telemetry_snapshot_seq + 2) / 2) % 2];
+
+	WriteReg(TELEMETRY_SNAPSHOT_SEQ_REG_ADDR, ++telemetry_snapshot_seq);
+	atomic_thread_fence(memory_order_seq_cst);
+
+	memcpy(snapshot, telemetry, sizeof(telemetry_snapshots[0]));
+
+	atomic_thread_fence(memory_order_seq_cst);
+	WriteReg(TELEMETRY_SNAPSHOT_SEQ_REG_ADDR, ++telemetry_snapshot_seq);
+}
+
+static void update_power_telemetry(uint32_t period_ms)
 {
-	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_TELEMETRY_START);
 	TelemetryInternalData telemetry_internal_data;
 
-	ReadTelemetryInternal(telem_update_interval, &telemetry_internal_data);
+	ReadTelemetryInternal(period_ms, &telemetry_internal_data);
 
 	/* Get all dynamically updated values */
 	telemetry[TAG_VCORE] =
@@ -386,6 +400,11 @@ static void update_telemetry(void)
 							    */
 	telemetry[TAG_VREG_TEMPERATURE] = 0x000000;        /* VREG temperature - need I2C line */
 	telemetry[TAG_BOARD_TEMPERATURE] = 0x000000;       /* Board temperature - need I2C line */
+	telemetry[TAG_INPUT_POWER] = GetInputPower(); /* Input power - reported in W */
+}
+
+static void update_clock_telemetry(uint32_t period_ms)
+{
 	clock_control_get_rate(pll_dev_0, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK,
 			       &telemetry[TAG_AICLK]);
 	/* first 16 bits - MAX ASIC FREQ (Not Available yet), lower 16 bits - current AICLK */
@@ -420,17 +439,58 @@ static void update_telemetry(void)
 		&telemetry[TAG_L2CPUCLK3]); /* first 16 bits - MAX L2CPUCLK3 FREQ (Not Available
 					     * yet), lower 16 bits - current L2CPUCLK3
 					     */
+}
 
+static void update_fan_telemetry(uint32_t period_ms)
+{
 	telemetry[TAG_ETH_LIVE_STATUS] =
 		0x00000000; /* ETH live status lower 16 bits: heartbeat status, upper 16 bits:
 			     * retrain_status - Not Available yet
 			     */
 	telemetry[TAG_FAN_SPEED] = GetFanSpeed(); /* Target fan speed - reported in percentage */
 	telemetry[TAG_FAN_RPM] = GetFanRPM();     /* Actual fan RPM */
+}
+
+static void update_gddr_telemetry(uint32_t period_ms)
+{
 	UpdateGddrTelemetry();
 	telemetry[TAG_MAX_GDDR_TEMP] = GetMaxGDDRTemp();
-	telemetry[TAG_INPUT_POWER] = GetInputPower(); /* Input power - reported in W */
+}
+
+struct telem_group {
+	void (*update)(uint32_t period_ms);
+	uint32_t period_ms;
+	int64_t last_update;
+};
+
+/* Refresh period of each group of dynamic tags. The update timer ticks at the shortest period and
+ * each group is refreshed once its own period has elapsed.
+ */
+static struct telem_group telem_groups[TELEM_GROUP_COUNT] = {
+	[TELEM_GROUP_POWER] = {update_power_telemetry, 100},
+	[TELEM_GROUP_CLOCKS] = {update_clock_telemetry, 100},
+	[TELEM_GROUP_FAN] = {update_fan_telemetry, 100},
+	[TELEM_GROUP_GDDR] = {update_gddr_telemetry, 100},
+};
+
+static void update_telemetry(bool force)
+{
+	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_TELEMETRY_START);
+	int64_t now = k_uptime_get();
+
+	for (unsigned int i = 0; i < TELEM_GROUP_COUNT; i++) {
+		struct telem_group *group = &telem_groups[i];
+
+		/* Allow for timer jitter of up to half a tick */
+		if (force || now - group->last_update + telem_update_interval / 2 >=
+				     group->period_ms) {
+			group->update(group->period_ms);
+			group->last_update = now;
+		}
+	}
+
 	telemetry[TAG_TIMER_HEARTBEAT]++; /* Incremented every time the timer is called */
+	publish_telemetry_snapshot();
 	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_TELEMETRY_END);
 }
 
@@ -438,7 +498,7 @@ static void update_telemetry(void)
 static void telemetry_work_handler(struct k_work *work)
 {
 	/* Repeat fetching of dynamic telemetry values */
-	update_telemetry();
+	update_telemetry(false);
 }
 static void telemetry_timer_handler(struct k_timer *timer)
 {
@@ -458,11 +518,13 @@ void init_telemetry(uint32_t app_version)
 {
 	write_static_telemetry(app_version);
 	/* fill the dynamic values once before starting timed updates */
-	update_telemetry();
+	update_telemetry(true);
 
 	/* Publish the telemetry data pointer for readers in Scratch RAM */
 	WriteReg(TELEMETRY_DATA_REG_ADDR, (uint32_t)&telemetry[0]);
 	WriteReg(TELEMETRY_TABLE_REG_ADDR, (uint32_t)&telemetry_table);
+	WriteReg(TELEMETRY_LAYOUT_HASH_REG_ADDR, telemetry_layout_hash());
+	WriteReg(TELEMETRY_SNAPSHOT_REG_ADDR, (uint32_t)&telemetry_snapshots[0][0]);
 }
 
 void StartTelemetryTimer(void)
@@ -474,8 +536,64 @@ void StartTelemetryTimer(void)
 	 */
 	k_timer_start(&telem_update_timer, K_MSEC(telem_update_interval),
 		      K_MSEC(telem_update_interval));
+	telem_timer_running = true;
+}
+
+int SetTelemetryGroupPeriod(uint32_t group, uint32_t period_ms)
+{
+	if (period_ms < TELEM_MIN_PERIOD_MS || period_ms > TELEM_MAX_PERIOD_MS) {
+		return -EINVAL;
+	}
+
+	if (group == TELEM_GROUP_ALL) {
+		for (unsigned int i = 0; i < TELEM_GROUP_COUNT; i++) {
+			telem_groups[i].period_ms = period_ms;
+		}
+	} else if (group < TELEM_GROUP_COUNT) {
+		telem_groups[group].period_ms = period_ms;
+	} else {
+		return -EINVAL;
+	}
+
+	uint32_t interval = UINT32_MAX;
+
+	for (unsigned int i = 0; i < TELEM_GROUP_COUNT; i++) {
+		interval = MIN(interval, telem_groups[i].period_ms);
+	}
+
+	telem_update_interval = interval;
+	telemetry[TAG_UPDATE_TELEM_SPEED] = telem_update_interval;
+
+	/* Only restart the timer if StartTelemetryTimer() has already started it */
+	if (telem_timer_running) {
+		k_timer_start(&telem_update_timer, K_MSEC(telem_update_interval),
+			      K_MSEC(telem_update_interval));
+	}
+
+	return 0;
 }
 
+/** @brief Handles the request to change telemetry refresh periods
+ * @param[in] request The request, of type @ref telem_period_rqst
+ * @param[out] response data[1]: the resulting update timer period in milliseconds
+ * @return 0 for success, 1 for an invalid group or period
+ */
+static uint8_t set_telem_period_handler(const union request *request, struct response *response)
+{
+	const struct telem_period_rqst *rqst = &request->telem_period;
+	int ret = SetTelemetryGroupPeriod(rqst->group, rqst->period_ms);
+
+	if (ret < 0) {
+		return 1;
+	}
+
+	response->data[1] = telem_update_interval;
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_SET_TELEM_PERIOD, set_telem_period_handler);
+
 void UpdateDmFwVersion(uint32_t bl_version, uint32_t app_version)
 {
 	telemetry[TAG_DM_BL_FW_VERSION] = bl_version;
@@ -231,14 +231,92 @@
  */
 #define TAG_COUNT 65
 
+/* Tags published in the telemetry table, in table order. The table is generated from this list,
+ * so entries are contiguous.
+ */
+#define TELEMETRY_TABLE_TAGS(X)                                                                    \
+	X(TAG_BOARD_ID_HIGH)                                                                       \
+	X(TAG_BOARD_ID_LOW)                                                                        \
+	X(TAG_HARVESTING_STATE)                                                                    \
+	X(TAG_UPDATE_TELEM_SPEED)                                                                  \
+	X(TAG_VCORE)                                                                               \
+	X(TAG_TDP)                                                                                 \
+	X(TAG_TDC)                                                                                 \
+	X(TAG_VDD_LIMITS)                                                                          \
+	X(TAG_THM_LIMIT_SHUTDOWN)                                                                  \
+	X(TAG_ASIC_TEMPERATURE)                                                                    \
+	X(TAG_VREG_TEMPERATURE)                                                                    \
+	X(TAG_BOARD_TEMPERATURE)                                                                   \
+	X(TAG_AICLK)                                                                               \
+	X(TAG_AXICLK)                                                                              \
+	X(TAG_ARCCLK)                                                                              \
+	X(TAG_L2CPUCLK0)                                                                           \
+	X(TAG_L2CPUCLK1)                                                                           \
+	X(TAG_L2CPUCLK2)                                                                           \
+	X(TAG_L2CPUCLK3)                                                                           \
+	X(TAG_ETH_LIVE_STATUS)                                                                     \
+	X(TAG_GDDR_STATUS)                                                                         \
+	X(TAG_GDDR_SPEED)                                                                          \
+	X(TAG_ETH_FW_VERSION)                                                                      \
+	X(TAG_GDDR_FW_VERSION)                                                                     \
+	X(TAG_DM_APP_FW_VERSION)                                                                   \
+	X(TAG_DM_BL_FW_VERSION)                                                                    \
+	X(TAG_FLASH_BUNDLE_VERSION)                                                                \
+	X(TAG_CM_FW_VERSION)                                                                       \
+	X(TAG_L2CPU_FW_VERSION)                                                                    \
+	X(TAG_FAN_SPEED)                                                                           \
+	X(TAG_TIMER_HEARTBEAT)                                                                     \
+	X(TAG_ENABLED_TENSIX_COL)                                                                  \
+	X(TAG_ENABLED_ETH)                                                                         \
+	X(TAG_ENABLED_GDDR)                                                                        \
+	X(TAG_ENABLED_L2CPU)                                                                       \
+	X(TAG_PCIE_USAGE)                                                                          \
+	X(TAG_NOC_TRANSLATION)                                                                     \
+	X(TAG_FAN_RPM)                                                                             \
+	X(TAG_GDDR_0_1_TEMP)                                                                       \
+	X(TAG_GDDR_2_3_TEMP)                                                                       \
+	X(TAG_GDDR_4_5_TEMP)                                                                       \
+	X(TAG_GDDR_6_7_TEMP)                                                                       \
+	X(TAG_GDDR_0_1_CORR_ERRS)                                                                  \
+	X(TAG_GDDR_2_3_CORR_ERRS)                                                                  \
+	X(TAG_GDDR_4_5_CORR_ERRS)                                                                  \
+	X(TAG_GDDR_6_7_CORR_ERRS)                                                                  \
+	X(TAG_GDDR_UNCORR_ERRS)                                                                    \
+	X(TAG_MAX_GDDR_TEMP)                                                                       \
+	X(TAG_ASIC_LOCATION)                                                                       \
+	X(TAG_BOARD_POWER_LIMIT)                                                                   \
+	X(TAG_INPUT_POWER)                                                                         \
+	X(TAG_ASIC_ID_HIGH)                                                                        \
+	X(TAG_ASIC_ID_LOW)                                                                         \
+	X(TAG_THERM_TRIP_COUNT)                                                                    \
+	X(TAG_TELEM_ENUM_COUNT)                                                                    \
+	X(TAG_AICLK_LIMIT_MAX)                                                                     \
+	X(TAG_TDC_LIMIT_MAX)                                                                       \
+	X(TAG_THM_LIMIT_THROTTLE)                                                                  \
+	X(TAG_TDP_LIMIT_MAX)
+
 /* Telemetry tags are at offset `tag` in the telemetry buffer */
 #define TELEM_OFFSET(tag) (tag)
 
+/* Groups of dynamic telemetry tags that are refreshed together */
+enum telem_group_id {
+	TELEM_GROUP_POWER,  /* VCORE, TDP, TDC, temperatures, input power */
+	TELEM_GROUP_CLOCKS, /* AICLK, AXICLK, ARCCLK, L2CPUCLKs */
+	TELEM_GROUP_FAN,    /* Fan speed and RPM */
+	TELEM_GROUP_GDDR,   /* GDDR status, temperatures and error counters */
+	TELEM_GROUP_COUNT,
+	TELEM_GROUP_ALL = 0xff,
+};
+
+#define TELEM_MIN_PERIOD_MS 10
+#define TELEM_MAX_PERIOD_MS 60000
+
 void init_telemetry(uint32_t app_version);
 uint32_t ConvertFloatToTelemetry(float value);
 float ConvertTelemetryToFloat(int32_t value);
 int GetMaxGDDRTemp(void);
 void StartTelemetryTimer(void);
+int SetTelemetryGroupPeriod(uint32_t group, uint32_t period_ms);
 void UpdateDmFwVersion(uint32_t bl_version, uint32_t app_version);
 void UpdateTelemetryNocTranslation(bool translation_enabled);
 void UpdateTelemetryBoardPowerLimit(uint32_t power_limit);
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "reg.h"
+#include "status_reg.h"
+#include "telemetry.h"
+#include "telemetry_internal.h"
+#include "timer.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/clock_control/clock_control_tt_bh.h>
+#include <zephyr/kernel.h>
+
+/* "TSTR" */
+#define TELEM_STREAM_MAGIC   0x52545354
+#define TELEM_STREAM_VERSION 1
+
+/* Each record starts with a 64-bit refclk timestamp */
+#define TELEM_STREAM_TIMESTAMP_WORDS 2
+
+static const struct device *const pll_dev_0 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(pll0));
+
+/**
+ * @ingroup telemetry
+ * @brief Header of the telemetry stream ring buffer.
+ *
+ * The address of the header is published in @ref TELEMETRY_STREAM_REG_ADDR. Records are
+ * @ref record_words words long: the low and high words of the refclk timestamp (see
+ * @ref TimerTimestamp), followed by one value for each entry of @ref tags, in the same format as
+ * the telemetry table. Record n is at data[(n % capacity) * record_words].
+ *
+ * The firmware advances @ref head after writing a record. The host advances @ref tail after
+ * consuming records. When the ring is full, new records are dropped and counted in
+ * @ref dropped.
+ */
+struct telem_stream_header {
+	/** @brief TELEM_STREAM_MAGIC, "TSTR" */
+	uint32_t magic;
+	/** @brief Layout version of this header and the records */
+	uint32_t version;
+	/** @brief Sampling period in milliseconds, 0 when stopped */
+	uint32_t period_ms;
+	/** @brief Number of tags sampled into each record */
+	uint32_t num_tags;
+	/** @brief Size of each record in 32-bit words */
+	uint32_t record_words;
+	/** @brief Number of records in the ring */
+	uint32_t capacity;
+	/** @brief Number of records written since streaming was started, written by firmware */
+	volatile uint32_t head;
+	/** @brief Number of records consumed by the host, written by host */
+	volatile uint32_t tail;
+	/** @brief Number of records dropped because the ring was full */
+	uint32_t dropped;
+	/** @brief Telemetry tags sampled into each record */
+	uint8_t tags[TELEM_STREAM_MAX_TAGS];
+};
+
+static struct {
+	struct telem_stream_header header;
+	uint32_t data[CONFIG_TT_BH_ARC_TELEM_STREAM_BUF_WORDS];
+} telem_stream;
+
+static uint32_t sample_tag(uint8_t tag, const TelemetryInternalData *internal)
+{
+	uint32_t value;
+
+	/* Values the telemetry table only refreshes every update interval are read directly.
+	 * The internal data is kept fresh by DVFS.
+	 */
+	switch (tag) {
+	case TAG_VCORE:
+		return internal->vcore_voltage;
+	case TAG_TDP:
+		return internal->vcore_power;
+	case TAG_TDC:
+		return internal->vcore_current;
+	case TAG_ASIC_TEMPERATURE:
+		return ConvertFloatToTelemetry(internal->asic_temperature);
+	case TAG_AICLK:
+		clock_control_get_rate(
+			pll_dev_0, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK, &value);
+		return value;
+	default:
+		return GetTelemetryTag(tag);
+	}
+}
+
+static void telem_stream_work_handler(struct k_work *work)
+{
+	struct telem_stream_header *header = &telem_stream.header;
+	uint32_t head = header->head;
+
+	if (head - header->tail >= header->capacity) {
+		header->dropped++;
+		return;
+	}
+
+	TelemetryInternalData internal;
+	uint32_t *record = &telem_stream.data[(head % header->capacity) * header->record_words];
+	uint64_t timestamp = TimerTimestamp();
+
+	ReadTelemetryInternal(header->period_ms, &internal);
+
+	record[0] = (uint32_t)timestamp;
+	record[1] = (uint32_t)(timestamp >> 32);
+	for (uint32_t i = 0; i < header->num_tags; i++) {
+		record[TELEM_STREAM_TIMESTAMP_WORDS + i] = sample_tag(header->tags[i], &internal);
+	}
+
+	atomic_thread_fence(memory_order_seq_cst);
+	header->head = head + 1;
+}
+static K_WORK_DEFINE(telem_stream_worker, telem_stream_work_handler);
+
+static void telem_stream_timer_handler(struct k_timer *timer)
+{
+	k_work_submit(&telem_stream_worker);
+}
+static K_TIMER_DEFINE(telem_stream_timer, telem_stream_timer_handler, NULL);
+
+static int telem_stream_start(const uint8_t *tags, uint32_t num_tags, uint32_t period_ms)
+{
+	struct telem_stream_header *header = &telem_stream.header;
+	struct k_work_sync sync;
+
+	/* Wait for a record that is being written, so it can't land in the restarted ring */
+	k_timer_stop(&telem_stream_timer);
+	k_work_cancel_sync(&telem_stream_worker, &sync);
+	header->period_ms = 0;
+
+	if (num_tags == 0) {
+		return 0;
+	}
+
+	if (num_tags > TELEM_STREAM_MAX_TAGS || period_ms == 0) {
+		return -EINVAL;
+	}
+
+	for (uint32_t i = 0; i < num_tags; i++) {
+		if (!GetTelemetryTagValid(tags[i])) {
+			return -EINVAL;
+		}
+	}
+
+	header->magic = TELEM_STREAM_MAGIC;
+	header->version = TELEM_STREAM_VERSION;
+	header->num_tags = num_tags;
+	header->record_words = TELEM_STREAM_TIMESTAMP_WORDS + num_tags;
+	header->capacity = ARRAY_SIZE(telem_stream.data) / header->record_words;
+	header->head = 0;
+	header->tail = 0;
+	header->dropped = 0;
+	memset(header->tags, 0, sizeof(header->tags));
+	memcpy(header->tags, tags, num_tags);
+	header->period_ms = period_ms;
+
+	WriteReg(TELEMETRY_STREAM_REG_ADDR, (uint32_t)header);
+	k_timer_start(&telem_stream_timer, K_MSEC(period_ms), K_MSEC(period_ms));
+
+	return 0;
+}
+
+/** @brief Handles the request to start or stop telemetry streaming
+ * @param[in] request The request, of type @ref telem_stream_rqst
+ * @param[out] response data[1]: address of the stream header
+ * @return 0 for success, 1 for an invalid tag, tag count or period
+ */
+static uint8_t telem_stream_handler(const union request *request, struct response *response)
+{
+	const struct telem_stream_rqst *rqst = &request->telem_stream;
+	int ret = telem_stream_start(rqst->tags, rqst->num_tags, rqst->period_ms);
+
+	if (ret < 0) {
+		return 1;
+	}
+
+	response->data[1] = (uint32_t)&telem_stream.header;
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_TELEM_STREAM, telem_stream_handler);
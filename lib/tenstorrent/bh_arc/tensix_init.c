@@ -21,6 +21,8 @@
 
 #define TENSIX_L1_SIZE (1536 * 1024)
 
+#define NOC_DMA_WAIT_TIMEOUT K_MSEC(100)
+
 static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
 static const struct device *const dma_noc = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(dma1));
 
@@ -72,14 +74,31 @@ static void EnableTensixCG(void)
 	NOC2AXIWrite32(ring, noc_tlb, cg_ctrl_en, enable_all_tensix_cg);
 }
 
+/* Each step of the wipe copies what the previous one cleared, so it is waited for */
+static int wipe_l1_step(struct dma_config *config)
+{
+	int rc = dma_config(dma_noc, 1, config);
+
+	if (rc == 0) {
+		rc = dma_start(dma_noc, 1);
+	}
+	if (rc == 0) {
+		rc = tt_bh_dma_noc_wait_channel(dma_noc, 1, NOC_DMA_WAIT_TIMEOUT);
+	}
+
+	return rc;
+}
+
 /**
  * @brief Zeros the l1 of every non-harvested tensix core
  *
  * First zero the l1 of an arbitrary non-harvested tensix core, then broadcasts the zero'd l1 to
  * all other non-harvested tensix cores. This approach is faster than iterating over all tensix
  * cores sequentially to clear each l1.
+ *
+ * @return 0 on success, otherwise the DMA error
  */
-static void wipe_l1(void)
+static int wipe_l1(void)
 {
 	uint64_t addr = 0;
 	uint8_t tensix_x, tensix_y;
@@ -111,8 +130,11 @@ static void wipe_l1(void)
 		.user_data = &coords,
 	};
 
-	dma_config(dma_noc, 1, &config);
-	dma_start(dma_noc, 1);
+	int rc = wipe_l1_step(&config);
+
+	if (rc != 0) {
+		return rc;
+	}
 
 	/* wipe entire L1 of the chosen tensix */
 	uint32_t offset = sizeof(sram_buffer);
@@ -126,8 +148,10 @@ static void wipe_l1(void)
 		block.dest_address = offset;
 		block.block_size = size;
 
-		dma_config(dma_noc, 1, &config);
-		dma_start(dma_noc, 1);
+		rc = wipe_l1_step(&config);
+		if (rc != 0) {
+			return rc;
+		}
 
 		offset += offset;
 	}
@@ -138,8 +162,7 @@ static void wipe_l1(void)
 	block.dest_address = addr;
 	block.block_size = TENSIX_L1_SIZE;
 
-	dma_config(dma_noc, 1, &config);
-	dma_start(dma_noc, 1);
+	return wipe_l1_step(&config);
 }
 
 void TensixInit(void)
@@ -161,8 +184,6 @@ static int tensix_init(void)
 
 	TensixInit();
 
-	wipe_l1();
-
-	return 0;
+	return wipe_l1();
 }
 SYS_INIT_APP(tensix_init);
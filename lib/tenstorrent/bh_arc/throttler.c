@@ -6,6 +6,7 @@
 
 #include <zephyr/sys/util.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
 #include <zephyr/sys/byteorder.h>
 #include "throttler.h"
 #include "aiclk_ppm.h"
@@ -17,20 +18,22 @@
 #define kThrottlerAiclkScaleFactor 500.0F
 #define DEFAULT_BOARD_POWER_LIMIT  150
 
+/* The workload model follows increases in power per MHz quickly and decreases slowly, so that it
+ * predicts the peaks of the workload rather than its average
+ */
+#define WORKLOAD_MODEL_RISE_ALPHA 0.1F
+#define WORKLOAD_MODEL_FALL_ALPHA 0.001F
+
+#ifdef CONFIG_ZTEST
+#define STATIC
+#else
+#define STATIC static
+#endif
+
 LOG_MODULE_REGISTER(throttler);
 
 static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
 
-typedef enum {
-	kThrottlerTDP,
-	kThrottlerFastTDC,
-	kThrottlerTDC,
-	kThrottlerThm,
-	kThrottlerBoardPower,
-	kThrottlerGDDRThm,
-	kThrottlerCount,
-} ThrottlerId;
-
 typedef struct {
 	float min;
 	float max;
@@ -66,21 +69,28 @@ static const ThrottlerLimitRange throttler_limit_ranges[kThrottlerCount] = {
 
 typedef struct {
 	float alpha_filter;
-	float p_gain;
-	float d_gain;
+	float kp;
+	float ki;           /* per second */
+	float kd;           /* seconds */
+	uint32_t period_ms; /* time between updates, a multiple of the DVFS period */
 } ThrottlerParams;
 
 typedef struct {
 	const AiclkArbMax arb_max; /* The arbiter associated with this throttler */
 
-	const ThrottlerParams params;
+	ThrottlerParams params;
 	float limit;
 	float value;
 	float error;
 	float prev_error;
-	float output;
+	float integral; /* integral term in MHz */
+	float output;   /* change of the arbiter in the last update, normalized */
+	uint32_t elapsed_ms;
 } Throttler;
 
+/* Integral action used to be applied by adding a proportional term to the arbiter every 1 ms, so
+ * ki here is that gain times 1000. Thermal throttlers respond slowly and update less often.
+ */
 static Throttler throttler[kThrottlerCount] = {
 	[kThrottlerTDP] = {
 
@@ -88,8 +98,10 @@ static Throttler throttler[kThrottlerCount] = {
 			.params = {
 
 					.alpha_filter = 1.0,
-					.p_gain = 0.2,
-					.d_gain = 0,
+					.kp = 0,
+					.ki = 200,
+					.kd = 0,
+					.period_ms = 1,
 				},
 		},
 	[kThrottlerFastTDC] = {
@@ -98,8 +110,10 @@ static Throttler throttler[kThrottlerCount] = {
 			.params = {
 
 					.alpha_filter = 1.0,
-					.p_gain = 0.5,
-					.d_gain = 0,
+					.kp = 0,
+					.ki = 500,
+					.kd = 0,
+					.period_ms = 1,
 				},
 		},
 	[kThrottlerTDC] = {
@@ -108,8 +122,10 @@ static Throttler throttler[kThrottlerCount] = {
 			.params = {
 
 					.alpha_filter = 0.1,
-					.p_gain = 0.2,
-					.d_gain = 0,
+					.kp = 0,
+					.ki = 200,
+					.kd = 0,
+					.period_ms = 1,
 				},
 		},
 	[kThrottlerThm] = {
@@ -118,8 +134,10 @@ static Throttler throttler[kThrottlerCount] = {
 			.params = {
 
 					.alpha_filter = 1.0,
-					.p_gain = 0.2,
-					.d_gain = 0,
+					.kp = 0,
+					.ki = 200,
+					.kd = 0,
+					.period_ms = 10,
 				},
 		},
 	[kThrottlerBoardPower] = {
@@ -127,8 +145,10 @@ static Throttler throttler[kThrottlerCount] = {
 			.params = {
 
 					.alpha_filter = 1.0,
-					.p_gain = 0.1,
-					.d_gain = 0.1,
+					.kp = 0.1,
+					.ki = 100,
+					.kd = 0,
+					.period_ms = 1,
 			}
 	},
 	[kThrottlerGDDRThm] = {
@@ -136,12 +156,34 @@ static Throttler throttler[kThrottlerCount] = {
 			.params = {
 
 					.alpha_filter = 1.0,
-					.p_gain = 0.2,
-					.d_gain = 0,
+					.kp = 0,
+					.ki = 200,
+					.kd = 0,
+					.period_ms = 10,
 				},
 	}
 };
 
+/* Feed-forward model of the power and current drawn per MHz of AICLK by a workload of intensity 1,
+ * learned while workloads announced with ThrottlerWorkloadHint() run
+ */
+typedef struct {
+	float intensity; /* intensity of the announced workload, 0 when there is none */
+	float power_per_mhz;
+	float current_per_mhz;
+} WorkloadModel;
+
+static WorkloadModel workload_model;
+
+/* Workload hint from the message queue, latched until the next UpdateThrottlers() applies it so
+ * that only the DVFS update changes the throttlers and their arbiters
+ */
+static struct {
+	struct k_spinlock lock;
+	bool pending;
+	float intensity;
+} workload_hint;
+
 static void SetThrottlerLimit(ThrottlerId id, float limit)
 {
 	float clamped_limit =
@@ -151,6 +193,67 @@ static void SetThrottlerLimit(ThrottlerId id, float limit)
 	throttler[id].limit = clamped_limit;
 }
 
+STATIC void LoadThrottlerParams(ThrottlerId id, const FwTable_ThrottlerParams *fw_params)
+{
+	ThrottlerParams params = throttler[id].params;
+
+	if (fw_params->has_alpha_filter) {
+		params.alpha_filter = fw_params->alpha_filter;
+	}
+	if (fw_params->has_kp) {
+		params.kp = fw_params->kp;
+	}
+	if (fw_params->has_ki) {
+		params.ki = fw_params->ki;
+	}
+	if (fw_params->has_kd) {
+		params.kd = fw_params->kd;
+	}
+	if (fw_params->has_period_ms) {
+		params.period_ms = fw_params->period_ms;
+	}
+
+	/* Every throttler protects the chip or board, so it must keep integrating towards its
+	 * limit. Negative gains would push AICLK up as the limit is exceeded.
+	 */
+	if (!(params.alpha_filter > 0 && params.alpha_filter <= 1.0F) || params.kp < 0 ||
+	    !(params.ki > 0) || params.kd < 0 || params.period_ms == 0) {
+		LOG_WRN("Ignoring invalid fw_table parameters of throttler %d", id);
+		return;
+	}
+
+	throttler[id].params = params;
+}
+
+static void InitThrottlerParams(void)
+{
+	const FwTable *fw_table = tt_bh_fwtable_get_fw_table(fwtable_dev);
+	const FwTable_ThrottlerTable *table = &fw_table->throttler_table;
+
+	if (!fw_table->has_throttler_table) {
+		return;
+	}
+
+	if (table->has_tdp) {
+		LoadThrottlerParams(kThrottlerTDP, &table->tdp);
+	}
+	if (table->has_fast_tdc) {
+		LoadThrottlerParams(kThrottlerFastTDC, &table->fast_tdc);
+	}
+	if (table->has_tdc) {
+		LoadThrottlerParams(kThrottlerTDC, &table->tdc);
+	}
+	if (table->has_thm) {
+		LoadThrottlerParams(kThrottlerThm, &table->thm);
+	}
+	if (table->has_board_power) {
+		LoadThrottlerParams(kThrottlerBoardPower, &table->board_power);
+	}
+	if (table->has_gddr_thm) {
+		LoadThrottlerParams(kThrottlerGDDRThm, &table->gddr_thm);
+	}
+}
+
 void InitThrottlers(void)
 {
 	SetThrottlerLimit(kThrottlerTDP,
@@ -164,47 +267,226 @@ void InitThrottlers(void)
 	SetThrottlerLimit(kThrottlerBoardPower, DEFAULT_BOARD_POWER_LIMIT);
 	SetThrottlerLimit(kThrottlerGDDRThm,
 			  tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.gddr_thm_limit);
+
+	InitThrottlerParams();
+
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		Throttler *t = &throttler[i];
+
+		t->value = 0;
+		t->error = 0;
+		t->prev_error = 0;
+		t->integral = GetThrottlerArbMax(t->arb_max);
+		t->output = 0;
+		t->elapsed_ms = 0;
+	}
+
+	workload_model = (WorkloadModel){0};
+
+	k_spinlock_key_t key = k_spin_lock(&workload_hint.lock);
+
+	workload_hint.pending = false;
+
+	k_spin_unlock(&workload_hint.lock, key);
+}
+
+/* Returns true when the throttler is due for an update */
+static bool ThrottlerDue(ThrottlerId id)
+{
+	Throttler *t = &throttler[id];
+
+	t->elapsed_ms++;
+	if (t->elapsed_ms < t->params.period_ms) {
+		return false;
+	}
+
+	t->elapsed_ms = 0;
+	return true;
 }
 
 static void UpdateThrottler(ThrottlerId id, float value)
 {
 	Throttler *t = &throttler[id];
+	float period_s = t->params.period_ms / 1000.0F;
 
 	t->value = t->params.alpha_filter * value + (1 - t->params.alpha_filter) * t->value;
 	t->error = (t->limit - t->value) / t->limit;
-	t->output = t->params.p_gain * t->error + t->params.d_gain * (t->error - t->prev_error);
-	t->prev_error = t->error;
+	t->integral += t->params.ki * period_s * t->error * kThrottlerAiclkScaleFactor;
 }
 
 static void UpdateThrottlerArb(ThrottlerId id)
 {
 	Throttler *t = &throttler[id];
+	float period_s = t->params.period_ms / 1000.0F;
+	float pd = t->params.kp * t->error + t->params.kd * (t->error - t->prev_error) / period_s;
+	float prev_arb_val = GetThrottlerArbMax(t->arb_max);
+
+	t->prev_error = t->error;
+
+	SetAiclkArbMax(t->arb_max, t->integral + pd * kThrottlerAiclkScaleFactor);
 
+	/* Anti-windup: when the arbiter is clamped to fmin or fmax, back off the integral so that
+	 * it tracks the clamped arbiter instead of accumulating past it
+	 */
 	float arb_val = GetThrottlerArbMax(t->arb_max);
 
-	arb_val += t->output * kThrottlerAiclkScaleFactor;
+	t->integral = arb_val - pd * kThrottlerAiclkScaleFactor;
+	t->output = (arb_val - prev_arb_val) / kThrottlerAiclkScaleFactor;
+}
 
-	SetAiclkArbMax(t->arb_max, arb_val);
+static float LearnRate(float sample, float model)
+{
+	return sample > model ? WORKLOAD_MODEL_RISE_ALPHA : WORKLOAD_MODEL_FALL_ALPHA;
 }
 
-void CalculateThrottlers(void)
+static void LearnWorkloadModel(const TelemetryInternalData *data)
 {
-	TelemetryInternalData telemetry_internal_data;
+	WorkloadModel *m = &workload_model;
+	AiclkDecision decision;
 
-	ReadTelemetryInternal(1, &telemetry_internal_data);
+	GetAiclkDecision(&decision);
+
+	/* Only learn while the announced workload may be running at the measured frequency */
+	if (m->intensity == 0 || decision.curr_freq == 0 || decision.forced || decision.sweep) {
+		return;
+	}
+
+	float power_per_mhz = data->vcore_power / (decision.curr_freq * m->intensity);
+	float current_per_mhz = data->vcore_current / (decision.curr_freq * m->intensity);
+
+	m->power_per_mhz += LearnRate(power_per_mhz, m->power_per_mhz) *
+			    (power_per_mhz - m->power_per_mhz);
+	m->current_per_mhz += LearnRate(current_per_mhz, m->current_per_mhz) *
+			      (current_per_mhz - m->current_per_mhz);
+}
+
+/* AICLK limit of the throttler for a workload drawing value_per_mhz */
+static float PredictLimit(ThrottlerId id, float value_per_mhz)
+{
+	Throttler *t = &throttler[id];
+	float arb_val = GetThrottlerArbMax(t->arb_max);
+
+	if (value_per_mhz <= 0) {
+		return arb_val;
+	}
+
+	return MIN(arb_val, t->limit / value_per_mhz);
+}
+
+/* Lower the throttler's arbiter ahead of a predicted overshoot */
+static void PreThrottle(ThrottlerId id, float value_per_mhz)
+{
+	Throttler *t = &throttler[id];
+	float predicted_freq = PredictLimit(id, value_per_mhz);
+
+	if (predicted_freq < GetThrottlerArbMax(t->arb_max)) {
+		SetAiclkArbMax(t->arb_max, predicted_freq);
+		/* Continue closed-loop control from the pre-throttled frequency */
+		t->integral = GetThrottlerArbMax(t->arb_max);
+	}
+}
+
+static void ApplyWorkloadHint(void)
+{
+	WorkloadModel *m = &workload_model;
+	bool pending;
+	float intensity;
+
+	k_spinlock_key_t key = k_spin_lock(&workload_hint.lock);
+
+	pending = workload_hint.pending;
+	intensity = workload_hint.intensity;
+	workload_hint.pending = false;
+
+	k_spin_unlock(&workload_hint.lock, key);
+
+	if (!pending) {
+		return;
+	}
 
-	UpdateThrottler(kThrottlerTDP, telemetry_internal_data.vcore_power);
-	UpdateThrottler(kThrottlerFastTDC, telemetry_internal_data.vcore_current);
-	UpdateThrottler(kThrottlerTDC, telemetry_internal_data.vcore_current);
-	UpdateThrottler(kThrottlerThm, telemetry_internal_data.asic_temperature);
-	UpdateThrottler(kThrottlerBoardPower, GetInputPower());
-	UpdateThrottler(kThrottlerGDDRThm, GetMaxGDDRTemp());
+	m->intensity = intensity;
+	if (intensity == 0) {
+		return;
+	}
+
+	PreThrottle(kThrottlerTDP, m->power_per_mhz * intensity);
+	PreThrottle(kThrottlerFastTDC, m->current_per_mhz * intensity);
+	PreThrottle(kThrottlerTDC, m->current_per_mhz * intensity);
+}
+
+/**
+ * @brief Prepare the throttlers for an upcoming workload
+ *
+ * The next throttler update lowers the AICLK limits of the power and current throttlers to the
+ * frequency at which the learned model predicts the workload reaches their limits, before the
+ * AICLK target of that DVFS update is calculated. The throttlers then raise them again in closed
+ * loop if the workload draws less than predicted. A later hint replaces one not yet applied.
+ *
+ * @param intensity Expected power per MHz of the workload, relative to the heaviest workload,
+ *	or 0 when the announced workload is over
+ * @return The predicted lowest throttler AICLK limit in MHz
+ */
+float ThrottlerWorkloadHint(float intensity)
+{
+	const WorkloadModel *m = &workload_model;
+	float limit = GetThrottlerArbMax(kAiclkArbMaxFmax);
+
+	k_spinlock_key_t key = k_spin_lock(&workload_hint.lock);
+
+	workload_hint.pending = true;
+	workload_hint.intensity = intensity;
+
+	k_spin_unlock(&workload_hint.lock, key);
+
+	if (intensity == 0) {
+		return limit;
+	}
+
+	limit = MIN(limit, PredictLimit(kThrottlerTDP, m->power_per_mhz * intensity));
+	limit = MIN(limit, PredictLimit(kThrottlerFastTDC, m->current_per_mhz * intensity));
+	limit = MIN(limit, PredictLimit(kThrottlerTDC, m->current_per_mhz * intensity));
+
+	return limit;
+}
+
+void GetThrottlerState(ThrottlerId id, float *value, float *error, float *output)
+{
+	*value = throttler[id].value;
+	*error = throttler[id].error;
+	*output = throttler[id].output;
+}
+
+/* Run one DVFS period of the throttlers on the given measurements */
+STATIC void UpdateThrottlers(const TelemetryInternalData *data, float input_power, float gddr_temp)
+{
+	ApplyWorkloadHint();
+	LearnWorkloadModel(data);
+
+	const float values[kThrottlerCount] = {
+		[kThrottlerTDP] = data->vcore_power,
+		[kThrottlerFastTDC] = data->vcore_current,
+		[kThrottlerTDC] = data->vcore_current,
+		[kThrottlerThm] = data->asic_temperature,
+		[kThrottlerBoardPower] = input_power,
+		[kThrottlerGDDRThm] = gddr_temp,
+	};
 
 	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
-		UpdateThrottlerArb(i);
+		if (ThrottlerDue(i)) {
+			UpdateThrottler(i, values[i]);
+			UpdateThrottlerArb(i);
+		}
 	}
 }
 
+void CalculateThrottlers(void)
+{
+	TelemetryInternalData telemetry_internal_data;
+
+	ReadTelemetryInternal(1, &telemetry_internal_data);
+	UpdateThrottlers(&telemetry_internal_data, GetInputPower(), GetMaxGDDRTemp());
+}
+
 int32_t Dm2CmSetBoardPowerLimit(const uint8_t *data, uint8_t size)
 {
 	if (size != 2) {
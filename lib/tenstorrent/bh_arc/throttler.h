@@ -6,8 +6,22 @@
 #ifndef THROTTLER_H
 #define THROTTLER_H
 
+#include <stdint.h>
+
+typedef enum {
+	kThrottlerTDP,
+	kThrottlerFastTDC,
+	kThrottlerTDC,
+	kThrottlerThm,
+	kThrottlerBoardPower,
+	kThrottlerGDDRThm,
+	kThrottlerCount,
+} ThrottlerId;
+
 void InitThrottlers(void);
 void CalculateThrottlers(void);
+void GetThrottlerState(ThrottlerId id, float *value, float *error, float *output);
+float ThrottlerWorkloadHint(float intensity);
 int32_t Dm2CmSetBoardPowerLimit(const uint8_t *data, uint8_t size);
 
 #endif
@@ -15,6 +15,7 @@
 #include "gddr.h"
 #include "asic_state.h"
 #include "noc_init.h"
+#include "msg_stats.h"
 LOG_MODULE_REGISTER(tt_shell, CONFIG_LOG_DEFAULT_LEVEL);
 
 static int l2cpu_enable_handler(const struct shell *sh, size_t argc, char **argv)
@@ -148,12 +149,66 @@ static int telem_handler(const struct shell *sh, size_t argc, char **argv)
 	return 0;
 }
 
+static void msg_stats_print_hist(const struct shell *sh, const struct msg_stats *stats)
+{
+	for (uint32_t i = 0; i < MSG_STATS_NUM_BUCKETS; i++) {
+		if (stats->hist[i] != 0) {
+			shell_print(sh, "  < %10u: %u", i == 0 ? 1 : BIT(i), stats->hist[i]);
+		}
+	}
+}
+
+static int msg_stats_handler(const struct shell *sh, size_t argc, char **argv)
+{
+	struct msg_stats stats;
+	int ret;
+
+	if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+		msg_stats_reset();
+		shell_print(sh, "OK");
+		return 0;
+	}
+
+	if (argc == 2) {
+		if (strcmp(argv[1], "wait") == 0) {
+			ret = msg_stats_get_queue_wait(&stats);
+		} else {
+			unsigned long code = strtoul(argv[1], NULL, 0);
+
+			ret = code > UINT8_MAX ? -EINVAL : msg_stats_get(code, &stats);
+		}
+
+		if (ret < 0) {
+			shell_error(sh, "Invalid message code");
+			return ret;
+		}
+
+		shell_print(sh, "count %u, max %u, mean %u (refclk cycles)", stats.count, stats.max,
+			    stats.count == 0 ? 0 : (uint32_t)(stats.total / stats.count));
+		msg_stats_print_hist(sh, &stats);
+		return 0;
+	}
+
+	shell_print(sh, "code  count       mean        max");
+	for (uint32_t code = 0; code < CONFIG_TT_BH_ARC_NUM_MSG_CODES; code++) {
+		if (msg_stats_get(code, &stats) < 0 || stats.count == 0) {
+			continue;
+		}
+		shell_print(sh, "0x%02X  %-10u  %-10u %u", code, stats.count,
+			    (uint32_t)(stats.total / stats.count), stats.max);
+	}
+
+	return 0;
+}
+
 SHELL_STATIC_SUBCMD_SET_CREATE(
 	sub_tt_commands, SHELL_CMD_ARG(mrisc_power, NULL, "[off|on]", mrisc_power_handler, 2, 0),
 	SHELL_CMD_ARG(tensix_power, NULL, "[off|on]", tensix_enable_handler, 2, 0),
 	SHELL_CMD_ARG(l2cpu_power, NULL, "[off|on]", l2cpu_enable_handler, 2, 0),
 	SHELL_CMD_ARG(asic_state, NULL, "[|0|3]", asic_state_handler, 1, 1),
 	SHELL_CMD_ARG(telem, NULL, "<Telemetry Index> [|x|f|d]", telem_handler, 2, 1),
+	SHELL_COND_CMD_ARG(CONFIG_TT_BH_ARC_MSG_STATS, msg_stats, NULL, "[|<code>|wait|reset]",
+			   msg_stats_handler, 1, 1),
 	SHELL_SUBCMD_SET_END);
 
 SHELL_CMD_REGISTER(tt, &sub_tt_commands, "Tensorrent commands", NULL);
@@ -6,6 +6,8 @@
 
 #include <zephyr/sys/util.h>
 #include "aiclk_ppm.h"
+#include "reg.h"
+#include "status_reg.h"
 #include "vf_curve.h"
 #include <zephyr/drivers/misc/bh_fwtable.h>
 #include <tenstorrent/msgqueue.h>
@@ -17,6 +19,20 @@
 #define VOLTAGE_MARGIN_MAX 150.0F
 #define VOLTAGE_MARGIN_MIN -150.0F
 
+/* "VFCT" */
+#define VF_TABLE_MAGIC   0x54434656
+#define VF_TABLE_VERSION 1
+
+/* The table covers every fmin and fmax accepted by aiclk_ppm.c */
+#define VF_TABLE_FMIN_MHZ 200
+#define VF_TABLE_FMAX_MHZ 1400
+#define VF_TABLE_STEP_MHZ CONFIG_TT_BH_ARC_VF_TABLE_STEP_MHZ
+#define VF_TABLE_ENTRIES                                                                           \
+	(DIV_ROUND_UP(VF_TABLE_FMAX_MHZ - VF_TABLE_FMIN_MHZ, VF_TABLE_STEP_MHZ) + 1)
+
+/* Voltages are stored in 1/16 mV units */
+#define VF_TABLE_FRAC_BITS 4
+
 static const float vf_quadratic_coeff = 0.00031395F;
 static const float vf_linear_coeff = -0.43953F;
 static const float vf_constant = 828.83F;
@@ -26,6 +42,89 @@ static float voltage_margin_mv = VOLTAGE_MARGIN_MAX;
 
 static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
 
+/**
+ * @brief V/F curve sampled at fixed frequency steps.
+ *
+ * The address of the table is published in @ref VF_CURVE_TABLE_REG_ADDR. Entry i holds the
+ * voltage, margins included, at fmin_mhz + i * step_mhz. Voltages between entries are linearly
+ * interpolated. The table is rebuilt whenever the margins change.
+ */
+static struct {
+	/** @brief VF_TABLE_MAGIC, "VFCT" */
+	uint32_t magic;
+	/** @brief Layout version of this table */
+	uint32_t version;
+	/** @brief Frequency of the first entry in MHz */
+	uint32_t fmin_mhz;
+	/** @brief Frequency step between entries in MHz */
+	uint32_t step_mhz;
+	/** @brief Number of entries */
+	uint32_t num_entries;
+	/** @brief Number of fractional bits in each voltage */
+	uint32_t frac_bits;
+	/** @brief Frequency margin the table was built with, in MHz */
+	int32_t freq_margin_mhz;
+	/** @brief Voltage margin the table was built with, in mV */
+	int32_t voltage_margin_mv;
+	/** @brief Voltage at each frequency step in 1/16 mV */
+	uint16_t voltage[VF_TABLE_ENTRIES];
+} vf_table;
+
+BUILD_ASSERT(VF_TABLE_ENTRIES >= 2, "V/F table needs at least one segment");
+
+static float vf_curve_eval(float freq_mhz)
+{
+	float freq_with_margin_mhz = freq_mhz + freq_margin_mhz;
+	float voltage_mv = vf_quadratic_coeff * freq_with_margin_mhz * freq_with_margin_mhz +
+			   vf_linear_coeff * freq_with_margin_mhz + vf_constant;
+
+	return voltage_mv + voltage_margin_mv;
+}
+
+static void build_vf_table(void)
+{
+	for (uint32_t i = 0; i < VF_TABLE_ENTRIES; i++) {
+		float voltage_mv = vf_curve_eval(VF_TABLE_FMIN_MHZ + i * VF_TABLE_STEP_MHZ);
+
+		vf_table.voltage[i] =
+			CLAMP(voltage_mv * BIT(VF_TABLE_FRAC_BITS) + 0.5F, 0.0F, (float)UINT16_MAX);
+	}
+
+	vf_table.magic = VF_TABLE_MAGIC;
+	vf_table.version = VF_TABLE_VERSION;
+	vf_table.fmin_mhz = VF_TABLE_FMIN_MHZ;
+	vf_table.step_mhz = VF_TABLE_STEP_MHZ;
+	vf_table.num_entries = VF_TABLE_ENTRIES;
+	vf_table.frac_bits = VF_TABLE_FRAC_BITS;
+	vf_table.freq_margin_mhz = freq_margin_mhz;
+	vf_table.voltage_margin_mv = voltage_margin_mv;
+
+	WriteReg(VF_CURVE_TABLE_REG_ADDR, (uint32_t)&vf_table);
+}
+
+static bool in_vf_table(uint32_t freq_mhz)
+{
+	return vf_table.num_entries != 0 && freq_mhz >= VF_TABLE_FMIN_MHZ &&
+	       freq_mhz <= VF_TABLE_FMAX_MHZ;
+}
+
+/* Interpolated voltage in 1/16 mV, freq_mhz must be covered by the table */
+static uint32_t vf_table_lookup(uint32_t freq_mhz)
+{
+	uint32_t offset = freq_mhz - VF_TABLE_FMIN_MHZ;
+	uint32_t i = offset / VF_TABLE_STEP_MHZ;
+	uint32_t k = offset % VF_TABLE_STEP_MHZ;
+	int32_t v0 = vf_table.voltage[i];
+
+	if (k == 0) {
+		return v0;
+	}
+
+	int32_t v1 = vf_table.voltage[i + 1];
+
+	return v0 + (v1 - v0) * (int32_t)k / VF_TABLE_STEP_MHZ;
+}
+
 void InitVFCurve(void)
 {
 	freq_margin_mhz =
@@ -34,35 +133,102 @@ void InitVFCurve(void)
 	voltage_margin_mv =
 		CLAMP(tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.voltage_margin,
 		      VOLTAGE_MARGIN_MIN, VOLTAGE_MARGIN_MAX);
+
+	build_vf_table();
 }
 
 /**
  * @brief Calculate the voltage based on the frequency
  *
+ * Frequencies covered by the V/F table are looked up without floating point. Others, which
+ * only come from host requests, are evaluated from the curve.
+ *
  * @param freq_mhz The frequency in MHz
- * @return The voltage in mV
+ * @return The voltage in mV, 0 if the curve is negative at freq_mhz
  */
-float VFCurve(float freq_mhz)
+uint32_t VFCurve(uint32_t freq_mhz)
 {
-	float freq_with_margin_mhz = freq_mhz + freq_margin_mhz;
-	float voltage_mv = vf_quadratic_coeff * freq_with_margin_mhz * freq_with_margin_mhz +
-			   vf_linear_coeff * freq_with_margin_mhz + vf_constant;
+	if (in_vf_table(freq_mhz)) {
+		return vf_table_lookup(freq_mhz) >> VF_TABLE_FRAC_BITS;
+	}
 
-	return voltage_mv + voltage_margin_mv;
+	float voltage_mv = vf_curve_eval(freq_mhz);
+
+	return voltage_mv < 0.0F ? 0 : (uint32_t)voltage_mv;
 }
 
-static uint8_t get_voltage_curve_from_freq_handler(const union request *request,
-						   struct response *response)
+/**
+ * @brief Find the highest frequency that runs at a voltage
+ *
+ * Assumes voltage increases monotonically with frequency between fmin and fmax.
+ *
+ * @param voltage_mv The voltage in mV
+ * @param fmin The lowest frequency to consider in MHz
+ * @param fmax The highest frequency to consider in MHz
+ * @return The highest frequency in [fmin, fmax] whose voltage does not exceed voltage_mv, or
+ *	fmin - 1 if there is none
+ */
+uint32_t VFCurveMaxFreq(uint32_t voltage_mv, uint32_t fmin, uint32_t fmax)
 {
-	float input_freq_mhz = (float)request->get_voltage_curve_from_freq.input_freq_mhz;
-	float voltage_mv = VFCurve(input_freq_mhz);
+	if (!in_vf_table(fmin) || !in_vf_table(fmax)) {
+		/* Binary search the curve, starting high at fmax + 1 to allow for fmax */
+		uint32_t high_freq = fmax + 1;
+		uint32_t low_freq = fmin;
+
+		while (low_freq < high_freq) {
+			uint32_t mid_freq = (low_freq + high_freq) / 2;
+
+			if (VFCurve(mid_freq) > voltage_mv) {
+				high_freq = mid_freq;
+			} else {
+				low_freq = mid_freq + 1;
+			}
+		}
 
-	if (voltage_mv < 0.0F) {
-		response->data[1] = 0U;
-	} else {
-		response->data[1] = (uint32_t)(voltage_mv);
+		return low_freq - 1;
 	}
 
+	/* VFCurve(f) <= voltage_mv exactly when the interpolated voltage is below target */
+	uint32_t target = (MIN(voltage_mv, UINT16_MAX) + 1) << VF_TABLE_FRAC_BITS;
+
+	if (vf_table_lookup(fmin) >= target) {
+		return fmin - 1;
+	}
+	if (vf_table_lookup(fmax) < target) {
+		return fmax;
+	}
+
+	/* Find the last entry below target. Entry lo is at or below fmin, so it is below target,
+	 * and entry hi is past the crossing somewhere at or before fmax.
+	 */
+	uint32_t lo = (fmin - VF_TABLE_FMIN_MHZ) / VF_TABLE_STEP_MHZ;
+	uint32_t hi = DIV_ROUND_UP(fmax - VF_TABLE_FMIN_MHZ, VF_TABLE_STEP_MHZ);
+
+	while (hi - lo > 1) {
+		uint32_t mid = (lo + hi) / 2;
+
+		if (vf_table.voltage[mid] < target) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+
+	/* Solve v0 + (v1 - v0) * k / step < target for the largest k in the segment */
+	uint32_t v0 = vf_table.voltage[lo];
+	uint32_t v1 = vf_table.voltage[lo + 1];
+	uint32_t k = ((target - v0) * VF_TABLE_STEP_MHZ - 1) / (v1 - v0);
+
+	k = MIN(k, VF_TABLE_STEP_MHZ - 1);
+
+	return MIN(VF_TABLE_FMIN_MHZ + lo * VF_TABLE_STEP_MHZ + k, fmax);
+}
+
+static uint8_t get_voltage_curve_from_freq_handler(const union request *request,
+						   struct response *response)
+{
+	response->data[1] = VFCurve(request->get_voltage_curve_from_freq.input_freq_mhz);
+
 	return 0;
 }
 
@@ -6,6 +6,9 @@
 #ifndef VF_CURVE_H
 #define VF_CURVE_H
 
+#include <stdint.h>
+
 void InitVFCurve(void);
-float VFCurve(float freq_mhz);
+uint32_t VFCurve(uint32_t freq_mhz);
+uint32_t VFCurveMaxFreq(uint32_t voltage_mv, uint32_t fmin, uint32_t fmax);
 #endif
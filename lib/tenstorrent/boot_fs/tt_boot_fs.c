@@ -12,22 +12,144 @@
 #include <zephyr/device.h>
 #include <zephyr/drivers/flash.h>
 #include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
 LOG_MODULE_REGISTER(tt_boot_fs, CONFIG_TT_APP_LOG_LEVEL);
 
+/* tt_boot_fs_get_file() reads and checksums files in chunks of this size */
+#define TT_BOOT_FS_GET_FILE_CHUNK_SIZE 4096
+
+/* Open addressing hash table slots, kept at most half full */
+#define FD_INDEX_NUM_SLOTS (2 * CONFIG_TT_BOOT_FS_IMAGE_COUNT_MAX)
+
+BUILD_ASSERT(CONFIG_TT_BOOT_FS_IMAGE_COUNT_MAX < UINT8_MAX, "fd index must fit in a uint8_t");
+
+/* In-RAM directory of a boot filesystem, hashed by image tag */
+struct fd_index {
+	tt_boot_fs_fd fds[CONFIG_TT_BOOT_FS_IMAGE_COUNT_MAX];
+	/* Index into fds plus one, 0 for an empty slot */
+	uint8_t slots[FD_INDEX_NUM_SLOTS];
+	bool valid;
+};
+
 tt_boot_fs boot_fs_data;
-static tt_boot_fs_fd boot_fs_cache[16];
+
+/* Directory of the filesystem set up by tt_boot_fs_mount() */
+static struct fd_index mount_index;
+
+/* Directory of the flash device last passed to tt_boot_fs_find_fd_by_tag() */
+static struct fd_index dev_index;
+static const struct device *dev_index_dev;
+
+static K_MUTEX_DEFINE(index_lock);
+
+static tt_checksum_res_t calculate_and_compare_checksum(uint8_t *data, size_t num_bytes,
+							uint32_t expected, bool skip_checksum);
 
 uint32_t tt_boot_fs_next(uint32_t last_fd_addr)
 {
 	return (last_fd_addr + sizeof(tt_boot_fs_fd));
 }
 
-static int tt_boot_fs_load_cache(tt_boot_fs *tt_boot_fs)
+/* Tags compare like strncmp(), so only the bytes up to the first NUL are significant */
+static void tag_to_key(const uint8_t *tag, uint8_t key[TT_BOOT_FS_IMAGE_TAG_SIZE])
+{
+	size_t len = strnlen((const char *)tag, TT_BOOT_FS_IMAGE_TAG_SIZE);
+
+	memset(key, 0, TT_BOOT_FS_IMAGE_TAG_SIZE);
+	memcpy(key, tag, len);
+}
+
+/* FNV-1a */
+static uint32_t key_hash(const uint8_t key[TT_BOOT_FS_IMAGE_TAG_SIZE])
 {
-	tt_boot_fs->hal_spi_read_f(TT_BOOT_FS_FD_HEAD_ADDR, sizeof(boot_fs_cache),
-				   (uint8_t *)boot_fs_cache);
+	uint32_t hash = 2166136261U;
+
+	for (size_t i = 0; i < TT_BOOT_FS_IMAGE_TAG_SIZE; i++) {
+		hash ^= key[i];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static void fd_index_reset(struct fd_index *index)
+{
+	memset(index->slots, 0, sizeof(index->slots));
+	index->valid = false;
+}
+
+/* Add fds[i] to the index, unless an earlier file has the same tag */
+static void fd_index_add(struct fd_index *index, size_t i)
+{
+	uint8_t key[TT_BOOT_FS_IMAGE_TAG_SIZE];
+	uint32_t slot;
+
+	tag_to_key(index->fds[i].image_tag, key);
+	slot = key_hash(key) % FD_INDEX_NUM_SLOTS;
+
+	while (index->slots[slot] != 0) {
+		const tt_boot_fs_fd *fd = &index->fds[index->slots[slot] - 1];
+
+		if (strncmp((const char *)key, (const char *)fd->image_tag,
+			    TT_BOOT_FS_IMAGE_TAG_SIZE) == 0) {
+			return;
+		}
+		slot = (slot + 1) % FD_INDEX_NUM_SLOTS;
+	}
+
+	index->slots[slot] = i + 1;
+}
+
+static const tt_boot_fs_fd *fd_index_find(const struct fd_index *index, const uint8_t *tag)
+{
+	uint8_t key[TT_BOOT_FS_IMAGE_TAG_SIZE];
+	uint32_t slot;
+
+	tag_to_key(tag, key);
+	slot = key_hash(key) % FD_INDEX_NUM_SLOTS;
+
+	/* The table is never full, so there is always an empty slot to stop at */
+	while (index->slots[slot] != 0) {
+		const tt_boot_fs_fd *fd = &index->fds[index->slots[slot] - 1];
+
+		if (strncmp((const char *)key, (const char *)fd->image_tag,
+			    TT_BOOT_FS_IMAGE_TAG_SIZE) == 0) {
+			return fd;
+		}
+		slot = (slot + 1) % FD_INDEX_NUM_SLOTS;
+	}
+
+	return NULL;
+}
+
+static int tt_boot_fs_load_cache(const tt_boot_fs *tt_boot_fs)
+{
+	k_mutex_lock(&index_lock, K_FOREVER);
+
+	fd_index_reset(&mount_index);
+	tt_boot_fs->hal_spi_read_f(TT_BOOT_FS_FD_HEAD_ADDR, sizeof(mount_index.fds),
+				   (uint8_t *)mount_index.fds);
+
+	ARRAY_FOR_EACH(mount_index.fds, i) {
+		tt_boot_fs_fd *fd = &mount_index.fds[i];
+
+		if (fd->flags.f.invalid) {
+			continue;
+		}
+
+		if (calculate_and_compare_checksum((uint8_t *)fd,
+						   sizeof(tt_boot_fs_fd) - sizeof(uint32_t),
+						   fd->fd_crc, false) == TT_BOOT_FS_CHK_FAIL) {
+			continue;
+		}
+
+		fd_index_add(&mount_index, i);
+	}
+	mount_index.valid = true;
+
+	k_mutex_unlock(&index_lock);
 
 	return TT_BOOT_FS_OK;
 }
@@ -82,33 +204,95 @@ int tt_boot_fs_add_file(const tt_boot_fs *tt_boot_fs, tt_boot_fs_fd fd,
 
 	tt_boot_fs->hal_spi_write_f(fd.spi_addr, total_image_size, image_data_src);
 
-	return TT_BOOT_FS_OK;
+	/* The HAL does not say which flash device it writes, so drop the device directory too */
+	k_mutex_lock(&index_lock, K_FOREVER);
+	fd_index_reset(&dev_index);
+	k_mutex_unlock(&index_lock);
+
+	return tt_boot_fs_load_cache(tt_boot_fs);
+}
+
+static uint32_t cksum_words(uint32_t cksum, const uint8_t *data, size_t num_words)
+{
+	if (!IS_ALIGNED(data, sizeof(uint32_t))) {
+		for (size_t i = 0; i < num_words; i++) {
+			cksum += UNALIGNED_GET((const uint32_t *)data + i);
+		}
+		return cksum;
+	}
+
+	const uint32_t *words = (const uint32_t *)data;
+	uint32_t sum[4] = {cksum};
+	size_t i = 0;
+
+	/* Separate accumulators so that consecutive adds do not depend on each other */
+	for (; i + 8 <= num_words; i += 8) {
+		sum[0] += words[i + 0] + words[i + 4];
+		sum[1] += words[i + 1] + words[i + 5];
+		sum[2] += words[i + 2] + words[i + 6];
+		sum[3] += words[i + 3] + words[i + 7];
+	}
+
+	for (; i < num_words; i++) {
+		sum[0] += words[i];
+	}
+
+	return sum[0] + sum[1] + sum[2] + sum[3];
 }
 
 uint32_t tt_boot_fs_cksum(uint32_t cksum, const uint8_t *data, size_t num_bytes)
 {
+	struct tt_boot_fs_cksum_ctx ctx = {.cksum = cksum};
+
 	if (num_bytes == 0 || data == NULL) {
 		return 0;
 	}
 
-	/* Always read 1 fewer word, and handle the 4 possible alignment cases outside the loop */
-	const uint32_t num_dwords = num_bytes / sizeof(uint32_t) - 1;
-	uint32_t *data_as_dwords = (uint32_t *)data;
+	tt_boot_fs_cksum_update(&ctx, data, num_bytes);
+
+	return tt_boot_fs_cksum_final(&ctx);
+}
+
+void tt_boot_fs_cksum_init(struct tt_boot_fs_cksum_ctx *ctx)
+{
+	*ctx = (struct tt_boot_fs_cksum_ctx){0};
+}
+
+void tt_boot_fs_cksum_update(struct tt_boot_fs_cksum_ctx *ctx, const uint8_t *data, size_t size)
+{
+	ctx->size += size;
+
+	/* Complete the word left over from the previous chunk */
+	while (ctx->tail_len != 0 && size > 0) {
+		ctx->tail |= (uint32_t)*data++ << (8 * ctx->tail_len++);
+		size--;
+
+		if (ctx->tail_len == sizeof(uint32_t)) {
+			ctx->cksum += ctx->tail;
+			ctx->tail = 0;
+			ctx->tail_len = 0;
+		}
+	}
+
+	size_t num_words = size / sizeof(uint32_t);
 
-	for (uint32_t i = 0; i < num_dwords; i++) {
-		cksum += *data_as_dwords++;
+	ctx->cksum = cksum_words(ctx->cksum, data, num_words);
+	data += num_words * sizeof(uint32_t);
+	size -= num_words * sizeof(uint32_t);
+
+	while (size-- > 0) {
+		ctx->tail |= (uint32_t)*data++ << (8 * ctx->tail_len++);
 	}
+}
 
-	switch (num_bytes % 4) {
-	case 0:
-		cksum += *data_as_dwords & 0xffffffff;
-		break;
-	default:
-		__ASSERT(false, "size %zu is not a multiple of 4", num_bytes);
-		break;
+uint32_t tt_boot_fs_cksum_final(const struct tt_boot_fs_cksum_ctx *ctx)
+{
+	/* scripts/tt_boot_fs.py does not checksum data shorter than a word */
+	if (ctx->size < sizeof(uint32_t)) {
+		return ctx->cksum;
 	}
 
-	return cksum;
+	return ctx->cksum + ctx->tail;
 }
 
 static tt_checksum_res_t calculate_and_compare_checksum(uint8_t *data, size_t num_bytes,
@@ -128,30 +312,20 @@ static tt_checksum_res_t calculate_and_compare_checksum(uint8_t *data, size_t nu
 
 static int find_fd_by_tag(const tt_boot_fs *tt_boot_fs, const uint8_t *tag, tt_boot_fs_fd *fd_data)
 {
-	for (uint32_t i = 0; i < ARRAY_SIZE(boot_fs_cache); i++) {
-		if (boot_fs_cache[i].flags.f.invalid) {
-			continue;
-		}
+	int ret = TT_BOOT_FS_ERR;
 
-		if (memcmp(boot_fs_cache[i].image_tag, tag, TT_BOOT_FS_IMAGE_TAG_SIZE) != 0) {
-			continue;
-		}
+	k_mutex_lock(&index_lock, K_FOREVER);
 
-		tt_checksum_res_t chk_res = calculate_and_compare_checksum(
-			(uint8_t *)&boot_fs_cache[i], sizeof(tt_boot_fs_fd) - sizeof(uint32_t),
-			boot_fs_cache[i].fd_crc, false);
+	const tt_boot_fs_fd *fd = mount_index.valid ? fd_index_find(&mount_index, tag) : NULL;
 
-		if (chk_res == TT_BOOT_FS_CHK_FAIL) {
-			continue;
-		}
-
-		/* Found the right file descriptor */
-		*fd_data = boot_fs_cache[i];
-		return TT_BOOT_FS_OK;
+	if (fd != NULL) {
+		*fd_data = *fd;
+		ret = TT_BOOT_FS_OK;
 	}
 
-	/* File descriptor not found */
-	return TT_BOOT_FS_ERR;
+	k_mutex_unlock(&index_lock);
+
+	return ret;
 }
 
 int tt_boot_fs_get_file(const tt_boot_fs *tt_boot_fs, const uint8_t *tag, uint8_t *buf,
@@ -172,9 +346,17 @@ int tt_boot_fs_get_file(const tt_boot_fs *tt_boot_fs, const uint8_t *tag, uint8_
 	}
 	*file_size = fd_data.flags.f.image_size;
 
-	tt_boot_fs->hal_spi_read_f(fd_data.spi_addr, fd_data.flags.f.image_size, buf);
-	if (calculate_and_compare_checksum(buf, fd_data.flags.f.image_size, fd_data.data_crc,
-					   false) != TT_BOOT_FS_CHK_OK) {
+	/* Sum each chunk right after it is read, while it is still in the data cache */
+	struct tt_boot_fs_cksum_ctx cksum;
+
+	tt_boot_fs_cksum_init(&cksum);
+	for (size_t offset = 0, len; offset < *file_size; offset += len) {
+		len = MIN(TT_BOOT_FS_GET_FILE_CHUNK_SIZE, *file_size - offset);
+		tt_boot_fs->hal_spi_read_f(fd_data.spi_addr + offset, len, buf + offset);
+		tt_boot_fs_cksum_update(&cksum, buf + offset, len);
+	}
+
+	if (tt_boot_fs_cksum_final(&cksum) != fd_data.data_crc) {
 		return TT_BOOT_FS_ERR;
 	}
 
@@ -232,33 +414,61 @@ int tt_boot_fs_ls(const struct device *dev, tt_boot_fs_fd *fds, size_t nfds, siz
 	return found;
 }
 
+static int dev_index_build(const struct device *flash_dev)
+{
+	fd_index_reset(&dev_index);
+
+	int ret = tt_boot_fs_ls(flash_dev, dev_index.fds, ARRAY_SIZE(dev_index.fds), 0);
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (int i = 0; i < ret; i++) {
+		fd_index_add(&dev_index, i);
+	}
+	dev_index.valid = true;
+	dev_index_dev = flash_dev;
+
+	return 0;
+}
+
 int tt_boot_fs_find_fd_by_tag(const struct device *flash_dev, const uint8_t *tag, tt_boot_fs_fd *fd)
 {
 	if (tag == NULL) {
 		return -EINVAL;
 	}
 
-	int ret;
-
-	tt_boot_fs_fd fds[CONFIG_TT_BOOT_FS_IMAGE_COUNT_MAX];
+	int ret = 0;
 
-	ret = tt_boot_fs_ls(flash_dev, fds, ARRAY_SIZE(fds), 0);
+	k_mutex_lock(&index_lock, K_FOREVER);
 
-	if (ret < 0) {
-		return ret;
+	if (!dev_index.valid || dev_index_dev != flash_dev) {
+		ret = dev_index_build(flash_dev);
 	}
 
-	ARRAY_FOR_EACH(fds, i) {
-		if (i >= ret) {
-			break;
-		}
+	if (ret == 0) {
+		const tt_boot_fs_fd *found = fd_index_find(&dev_index, tag);
 
-		if (strncmp(tag, fds[i].image_tag, sizeof(fds[i].image_tag)) == 0) {
-			if (fd != NULL) {
-				*fd = fds[i];
-			}
-			return 0;
+		if (found == NULL) {
+			ret = -ENOENT;
+		} else if (fd != NULL) {
+			*fd = *found;
 		}
 	}
-	return -ENOENT;
+
+	k_mutex_unlock(&index_lock);
+
+	return ret;
+}
+
+void tt_boot_fs_invalidate(const struct device *flash_dev)
+{
+	k_mutex_lock(&index_lock, K_FOREVER);
+
+	if (dev_index_dev == flash_dev) {
+		fd_index_reset(&dev_index);
+	}
+
+	k_mutex_unlock(&index_lock);
 }
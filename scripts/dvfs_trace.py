@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2025 Tenstorrent AI ULC
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+This script reads and decodes the DVFS control loop trace recorded by SMC
+firmware built with CONFIG_TT_BH_ARC_DVFS_TRACE. Each record describes one DVFS
+update: how long it took, which AICLK arbiters set the target frequency, the
+state of each throttler, and the target and achieved AICLK and VCORE.
+
+The trace is read from the chip over PCIe, or decoded from a raw dump of the
+ring buffer (header followed by the records) saved with --save.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+
+# Register definitions
+ARC_RESET_UNIT = 0x80030000
+SMC_SCRATCH_RAM_BASE = ARC_RESET_UNIT + 0x400
+DVFS_TRACE_REG = SMC_SCRATCH_RAM_BASE + 27 * 4
+
+DVFS_TRACE_MAGIC = 0x54465644  # "DVFT"
+DVFS_TRACE_VERSION = 1
+REFCLK_MHZ = 50
+
+# struct dvfs_trace_header
+HEADER_FORMAT = "<7I"
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+HEADER_HEAD_OFFSET = 20
+HEADER_FROZEN_OFFSET = 24
+
+# struct dvfs_trace_record, followed by num_throttlers struct dvfs_trace_throttler
+RECORD_FORMAT = "<IIHHHHbbBB"
+THROTTLER_FORMAT = "<Hhh"
+
+VALUE_SCALE = 16.0
+ERROR_SCALE = 16384.0
+
+# AiclkArbMin and AiclkArbMax in aiclk_ppm.h
+ARB_MIN_NAMES = ["fmin", "busy"]
+ARB_MAX_NAMES = ["fmax", "tdp", "fast_tdc", "tdc", "thm", "board_power", "voltage", "gddr_thm"]
+
+# ThrottlerId in throttler.h
+THROTTLER_NAMES = ["tdp", "fast_tdc", "tdc", "thm", "board_power", "gddr_thm"]
+
+FLAG_NAMES = {0x1: "forced_freq", 0x2: "sweep", 0x4: "forced_voltage"}
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Read and decode the SMC DVFS control loop trace.", allow_abbrev=False
+    )
+    parser.add_argument(
+        "--asic-id",
+        type=int,
+        default=0,
+        help="Specify which ASIC to read the trace from (default: 0).",
+    )
+    parser.add_argument(
+        "--input",
+        type=str,
+        help="Decode a raw trace saved with --save instead of reading the chip.",
+    )
+    parser.add_argument(
+        "--save",
+        type=str,
+        help="Save the raw trace read from the chip to this file.",
+    )
+    parser.add_argument(
+        "--csv",
+        action="store_true",
+        help="Print the records as CSV instead of a table.",
+    )
+    return parser.parse_args()
+
+
+def parse_header(data):
+    magic, version, record_size, capacity, num_throttlers, head, frozen = struct.unpack_from(
+        HEADER_FORMAT, data
+    )
+    if magic != DVFS_TRACE_MAGIC:
+        raise ValueError(f"Bad DVFS trace magic 0x{magic:08x}")
+    if version != DVFS_TRACE_VERSION:
+        raise ValueError(f"Unsupported DVFS trace version {version}")
+    return {
+        "record_size": record_size,
+        "capacity": capacity,
+        "num_throttlers": num_throttlers,
+        "head": head,
+        "frozen": frozen,
+    }
+
+
+def read_chip(asic_id):
+    """
+    Read the header and records from the chip, freezing the trace while reading
+    """
+    import pyluwen
+
+    chip = pyluwen.PciChip(asic_id)
+    header_addr = chip.axi_read32(DVFS_TRACE_REG)
+    if header_addr == 0:
+        raise RuntimeError("DVFS trace is not enabled in the running firmware")
+
+    chip.axi_write32(header_addr + HEADER_FROZEN_OFFSET, 1)
+    try:
+        # Let an update that was already recording finish
+        time.sleep(0.01)
+        words = [chip.axi_read32(header_addr + i * 4) for i in range(HEADER_SIZE // 4)]
+        header = parse_header(struct.pack("<7I", *words))
+        size = header["record_size"] * header["capacity"]
+        words += [chip.axi_read32(header_addr + HEADER_SIZE + i * 4) for i in range(size // 4)]
+    finally:
+        chip.axi_write32(header_addr + HEADER_FROZEN_OFFSET, 0)
+
+    return struct.pack(f"<{len(words)}I", *words)
+
+
+def arb_name(names, index):
+    if index < 0:
+        return "-"
+    return names[index] if index < len(names) else str(index)
+
+
+def decode(data):
+    """
+    Yield the records of a raw trace in the order they were written
+    """
+    header = parse_header(data)
+    record_size = header["record_size"]
+    capacity = header["capacity"]
+    head = header["head"]
+
+    for n in range(max(0, head - capacity), head):
+        offset = HEADER_SIZE + (n % capacity) * record_size
+        (
+            timestamp,
+            duration,
+            targ_freq,
+            curr_freq,
+            targ_voltage,
+            curr_voltage,
+            arb_min,
+            arb_max,
+            flags,
+            _,
+        ) = struct.unpack_from(RECORD_FORMAT, data, offset)
+        offset += struct.calcsize(RECORD_FORMAT)
+
+        throttlers = {}
+        for i in range(header["num_throttlers"]):
+            value, error, output = struct.unpack_from(THROTTLER_FORMAT, data, offset)
+            offset += struct.calcsize(THROTTLER_FORMAT)
+            name = THROTTLER_NAMES[i] if i < len(THROTTLER_NAMES) else f"throttler{i}"
+            throttlers[name] = (value / VALUE_SCALE, error / ERROR_SCALE, output / ERROR_SCALE)
+
+        yield {
+            "seq": n,
+            "timestamp_us": timestamp / REFCLK_MHZ,
+            "duration_us": duration / REFCLK_MHZ,
+            "arb_min": arb_name(ARB_MIN_NAMES, arb_min),
+            "arb_max": arb_name(ARB_MAX_NAMES, arb_max),
+            "targ_freq": targ_freq,
+            "curr_freq": curr_freq,
+            "targ_voltage": targ_voltage,
+            "curr_voltage": curr_voltage,
+            "flags": "|".join(name for bit, name in FLAG_NAMES.items() if flags & bit) or "-",
+            "throttlers": throttlers,
+        }
+
+
+def flatten(record):
+    row = {k: v for k, v in record.items() if k != "throttlers"}
+    for name, (value, error, output) in record["throttlers"].items():
+        row[f"{name}_value"] = f"{value:.2f}"
+        row[f"{name}_error"] = f"{error:.4f}"
+        row[f"{name}_output"] = f"{output:.4f}"
+    return row
+
+
+def print_csv(records):
+    writer = None
+    for record in records:
+        row = flatten(record)
+        if writer is None:
+            writer = csv.DictWriter(sys.stdout, fieldnames=list(row.keys()))
+            writer.writeheader()
+        writer.writerow(row)
+
+
+def print_table(records):
+    print(
+        f"{'seq':>8} {'time_us':>12} {'dur_us':>8} {'arb_min':>8} {'arb_max':>12} "
+        f"{'targ':>5} {'curr':>5} {'targ_mv':>7} {'curr_mv':>7}  throttlers (value/error/output)"
+    )
+    for r in records:
+        throttlers = " ".join(
+            f"{name}={value:.1f}/{error:+.3f}/{output:+.3f}"
+            for name, (value, error, output) in r["throttlers"].items()
+        )
+        flags = "" if r["flags"] == "-" else f" [{r['flags']}]"
+        print(
+            f"{r['seq']:>8} {r['timestamp_us']:>12.1f} {r['duration_us']:>8.1f} "
+            f"{r['arb_min']:>8} {r['arb_max']:>12} {r['targ_freq']:>5} {r['curr_freq']:>5} "
+            f"{r['targ_voltage']:>7} {r['curr_voltage']:>7}  {throttlers}{flags}"
+        )
+
+
+def main():
+    args = parse_args()
+
+    if args.input:
+        with open(args.input, "rb") as f:
+            data = f.read()
+    else:
+        data = read_chip(args.asic_id)
+        if args.save:
+            with open(args.save, "wb") as f:
+                f.write(data)
+
+    records = decode(data)
+    if args.csv:
+        print_csv(records)
+    else:
+        print_table(records)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/clock_control/clock_control_tt_bh.h>
+
+#define BENCH_ITERATIONS  32
+#define SETTLE_TIMEOUT_MS 100
+
+static const struct device *const pll = DEVICE_DT_GET(DT_NODELABEL(pll0));
+static const clock_control_subsys_t aiclk_subsys =
+	(clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK;
+
+struct transition_stats {
+	uint64_t total_ns;
+	uint64_t max_ns;
+};
+
+static void add_sample(struct transition_stats *stats, uint64_t ns)
+{
+	stats->total_ns += ns;
+	stats->max_ns = MAX(stats->max_ns, ns);
+}
+
+/* Wait until AICLK reads back within tolerance of rate, since increases may still be stepping */
+static void wait_settled(uint32_t rate)
+{
+	int64_t start = k_uptime_get();
+	uint32_t new_rate = 0;
+
+	do {
+		if (clock_control_get_rate(pll, aiclk_subsys, &new_rate) == 0 &&
+		    IN_RANGE(new_rate, rate - rate * CONFIG_CLOCK_CTRL_TOLERANCE_PERCENT / 100,
+			     rate + rate * CONFIG_CLOCK_CTRL_TOLERANCE_PERCENT / 100)) {
+			return;
+		}
+	} while (k_uptime_get() - start < SETTLE_TIMEOUT_MS);
+
+	ztest_test_fail();
+}
+
+static void transition(uint32_t rate, struct transition_stats *returned,
+		       struct transition_stats *settled)
+{
+	uint32_t start = k_cycle_get_32();
+
+	zassert_ok(clock_control_set_rate(pll, aiclk_subsys, (clock_control_subsys_rate_t)rate));
+	add_sample(returned, k_cyc_to_ns_floor64(k_cycle_get_32() - start));
+
+	wait_settled(rate);
+	add_sample(settled, k_cyc_to_ns_floor64(k_cycle_get_32() - start));
+}
+
+ZTEST(clock_control_bench, test_aiclk_fmin_fmax_transition_latency)
+{
+	struct transition_stats up_returned = {0}, up_settled = {0};
+	struct transition_stats down_returned = {0}, down_settled = {0};
+	uint32_t initial_rate;
+
+	zassert_ok(clock_control_get_rate(pll, aiclk_subsys, &initial_rate));
+
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+		transition(CONFIG_CLOCK_CTRL_AICLK_MIN_RATE, &down_returned, &down_settled);
+		transition(CONFIG_CLOCK_CTRL_AICLK_MAX_RATE, &up_returned, &up_settled);
+	}
+
+	zassert_ok(clock_control_set_rate(pll, aiclk_subsys,
+					  (clock_control_subsys_rate_t)initial_rate));
+	wait_settled(initial_rate);
+
+	TC_PRINT("AICLK %u -> %u MHz (%s): blocked mean %llu ns max %llu ns, "
+		 "settled mean %llu ns max %llu ns\n",
+		 CONFIG_CLOCK_CTRL_AICLK_MIN_RATE, CONFIG_CLOCK_CTRL_AICLK_MAX_RATE,
+		 IS_ENABLED(CONFIG_CLOCK_CONTROL_TT_BH_AICLK_ASYNC) ? "async" : "sync",
+		 up_returned.total_ns / BENCH_ITERATIONS, up_returned.max_ns,
+		 up_settled.total_ns / BENCH_ITERATIONS, up_settled.max_ns);
+	TC_PRINT("AICLK %u -> %u MHz: blocked mean %llu ns max %llu ns\n",
+		 CONFIG_CLOCK_CTRL_AICLK_MAX_RATE, CONFIG_CLOCK_CTRL_AICLK_MIN_RATE,
+		 down_returned.total_ns / BENCH_ITERATIONS, down_returned.max_ns);
+}
+
+ZTEST_SUITE(clock_control_bench, NULL, NULL, NULL, NULL, NULL);
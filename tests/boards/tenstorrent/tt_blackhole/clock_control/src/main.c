@@ -67,6 +67,11 @@ ZTEST(clock_control_rate, test_set_rate_aiclk)
 					     (clock_control_subsys_rate_t)target_rate);
 		zassert_ok(ret, "set_rate for AICLK failed with %d", ret);
 
+		/* Increases finish stepping from a timer after set_rate returns */
+		if (IS_ENABLED(CONFIG_CLOCK_CONTROL_TT_BH_AICLK_ASYNC)) {
+			k_msleep(10);
+		}
+
 		ret = clock_control_get_rate(pll, aiclk_subsys, &new_rate);
 		zassert_ok(ret, "get_rate for AICLK failed with %d", ret);
 
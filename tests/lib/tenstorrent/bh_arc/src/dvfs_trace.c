@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "aiclk_ppm.h"
+#include "dvfs_trace.h"
+#include "telemetry_internal.h"
+#include "throttler.h"
+#include "voltage.h"
+
+#define FLAG_SWEEP          BIT(1)
+#define FLAG_FORCED_VOLTAGE BIT(2)
+
+#define VALUE_SCALE 16.0F
+#define ERROR_SCALE 16384.0F
+
+#define AICLK_FMAX    1400.0F
+#define BUSY_AICLK    1200
+#define TDP_AICLK     1000
+#define SWEEP_AICLK   900
+#define FORCED_VDD_MV 800
+
+/* Leading words of struct dvfs_trace_header, as read by scripts/dvfs_trace.py */
+struct trace_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t record_size;
+	uint32_t capacity;
+	uint32_t num_throttlers;
+	uint32_t head;
+	uint32_t frozen;
+};
+
+/* struct dvfs_trace_record, which follows the header in the ring */
+struct trace_record {
+	uint32_t timestamp;
+	uint32_t duration;
+	uint16_t targ_freq;
+	uint16_t curr_freq;
+	uint16_t targ_voltage;
+	uint16_t curr_voltage;
+	int8_t arb_min;
+	int8_t arb_max;
+	uint8_t flags;
+	uint8_t reserved;
+	struct {
+		uint16_t value;
+		int16_t error;
+		int16_t output;
+	} throttlers[kThrottlerCount];
+};
+
+extern void UpdateThrottlers(const TelemetryInternalData *data, float input_power,
+			     float gddr_temp);
+
+static uint32_t send_trace_request(uint8_t flags, struct trace_header **header)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.dvfs_trace.command_code = TT_SMC_MSG_DVFS_TRACE;
+	req.dvfs_trace.flags = flags;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	zassert_equal(rsp.data[0], 0);
+	*header = (struct trace_header *)(uintptr_t)rsp.data[1];
+
+	return rsp.data[2];
+}
+
+static struct trace_record *trace_record(struct trace_header *header, uint32_t n)
+{
+	struct trace_record *records = (struct trace_record *)(header + 1);
+
+	return &records[n % header->capacity];
+}
+
+static void send_sweep(uint8_t command_code, uint32_t low, uint32_t high)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.command_code = command_code;
+	req.data[1] = low;
+	req.data[2] = high;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	zassert_equal(rsp.data[0], 0);
+}
+
+static void check_throttlers(const struct trace_record *record)
+{
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		float value, error, output;
+
+		GetThrottlerState(i, &value, &error, &output);
+		zassert_within(record->throttlers[i].value, value * VALUE_SCALE, 1, "%d", i);
+		zassert_within(record->throttlers[i].error, error * ERROR_SCALE, 1, "%d", i);
+		zassert_within(record->throttlers[i].output, output * ERROR_SCALE, 1, "%d", i);
+	}
+}
+
+ZTEST(dvfs_trace, test_dvfs_trace_records_and_resets)
+{
+	struct trace_header *header;
+
+	dvfs_trace_init();
+
+	for (int i = 0; i < CONFIG_TT_BH_ARC_DVFS_TRACE_ENTRIES + 3; i++) {
+		dvfs_trace_end(dvfs_trace_begin());
+	}
+
+	zassert_equal(send_trace_request(0, &header), CONFIG_TT_BH_ARC_DVFS_TRACE_ENTRIES + 3);
+	zassert_equal(header->magic, 0x54465644);
+	zassert_equal(header->record_size, 20 + 6 * kThrottlerCount);
+	zassert_equal(header->capacity, CONFIG_TT_BH_ARC_DVFS_TRACE_ENTRIES);
+	zassert_equal(header->num_throttlers, kThrottlerCount);
+
+	/* The host freezes the trace while it reads it */
+	header->frozen = 1;
+	dvfs_trace_end(dvfs_trace_begin());
+	zassert_equal(header->head, CONFIG_TT_BH_ARC_DVFS_TRACE_ENTRIES + 3);
+	header->frozen = 0;
+
+	/* The reset is left to the next update, which then records from the start of the ring */
+	zassert_equal(send_trace_request(BIT(0), &header), CONFIG_TT_BH_ARC_DVFS_TRACE_ENTRIES + 3);
+	zassert_equal(header->head, CONFIG_TT_BH_ARC_DVFS_TRACE_ENTRIES + 3);
+	dvfs_trace_end(dvfs_trace_begin());
+	zassert_equal(header->head, 1);
+
+	/* A reset requested while the trace is frozen still applies */
+	send_trace_request(BIT(0), &header);
+	header->frozen = 1;
+	dvfs_trace_end(dvfs_trace_begin());
+	zassert_equal(header->head, 0);
+	header->frozen = 0;
+}
+
+ZTEST(dvfs_trace, test_dvfs_trace_record_contents)
+{
+	const TelemetryInternalData telemetry = {
+		.vcore_power = 40,
+		.vcore_current = 30,
+		.asic_temperature = 30,
+	};
+	struct trace_header *header;
+	struct trace_record *record;
+
+	dvfs_trace_init();
+	send_trace_request(0, &header);
+
+	/* Every measurement is below its limit, so the throttlers leave their arbiters at fmax */
+	for (AiclkArbMax i = 0; i < kAiclkArbMaxCount; i++) {
+		SetAiclkArbMax(i, AICLK_FMAX);
+	}
+	InitThrottlers();
+	UpdateThrottlers(&telemetry, 100, 30);
+
+	/* The busy arbiter raises AICLK, and the TDP arbiter limits it */
+	SetAiclkArbMin(kAiclkArbMinBusy, BUSY_AICLK);
+	SetAiclkArbMax(kAiclkArbMaxTDP, TDP_AICLK);
+	CalculateTargAiclk();
+	dvfs_trace_end(dvfs_trace_begin());
+
+	record = trace_record(header, 0);
+	zassert_equal(header->head, 1);
+	zassert_equal(record->targ_freq, TDP_AICLK);
+	zassert_equal(record->arb_min, kAiclkArbMinBusy);
+	zassert_equal(record->arb_max, kAiclkArbMaxTDP);
+	zassert_equal(record->flags, 0);
+	zassert_equal(record->reserved, 0);
+	check_throttlers(record);
+	zassert_not_equal(record->throttlers[kThrottlerTDP].value, 0);
+	zassert_not_equal(record->throttlers[kThrottlerBoardPower].error, 0);
+
+	/* The overrides are flagged, and the arbiter winners are still those of the limits */
+	send_sweep(TT_SMC_MSG_AISWEEP_START, SWEEP_AICLK, SWEEP_AICLK);
+	voltage_arbiter.forced_voltage = FORCED_VDD_MV;
+	CalculateTargAiclk();
+	dvfs_trace_end(dvfs_trace_begin());
+
+	record = trace_record(header, 1);
+	zassert_equal(header->head, 2);
+	zassert_equal(record->targ_freq, SWEEP_AICLK);
+	zassert_equal(record->arb_min, kAiclkArbMinBusy);
+	zassert_equal(record->arb_max, kAiclkArbMaxTDP);
+	zassert_equal(record->flags, FLAG_SWEEP | FLAG_FORCED_VOLTAGE);
+	check_throttlers(record);
+
+	/* Without a busy or limiting arbiter there are no winners */
+	send_sweep(TT_SMC_MSG_AISWEEP_STOP, 0, 0);
+	voltage_arbiter.forced_voltage = 0;
+	SetAiclkArbMin(kAiclkArbMinBusy, 0);
+	SetAiclkArbMax(kAiclkArbMaxTDP, AICLK_FMAX);
+	CalculateTargAiclk();
+	dvfs_trace_end(dvfs_trace_begin());
+
+	record = trace_record(header, 2);
+	zassert_equal(record->arb_min, -1);
+	zassert_equal(record->arb_max, -1);
+	zassert_equal(record->flags, 0);
+}
+
+ZTEST_SUITE(dvfs_trace, NULL, NULL, NULL, NULL, NULL);
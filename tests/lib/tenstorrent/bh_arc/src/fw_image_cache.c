@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/tt_boot_fs.h>
+
+#include "fw_image_cache.h"
+
+#define POOL_SIZE CONFIG_TT_BH_ARC_FW_IMAGE_CACHE_SIZE
+
+/* Clear of the boot fs directory, and of the ranges the other suites write */
+#define SMALL_ADDR 0x40000
+#define SMALL_SIZE 1024
+#define LARGE_ADDR 0x50000
+#define LARGE_SIZE (POOL_SIZE + 4096)
+
+static const struct device *const flash = DEVICE_DT_GET(DT_NODELABEL(flashcontroller0));
+
+static uint8_t small_image[SMALL_SIZE];
+static uint8_t large_image[LARGE_SIZE];
+static uint8_t read_buf[LARGE_SIZE];
+
+static void fill_image(uint8_t *image, size_t size, uint8_t seed)
+{
+	for (size_t i = 0; i < size; i++) {
+		image[i] = seed + i * 7;
+	}
+}
+
+static void make_fd(tt_boot_fs_fd *fd, const char *tag, uint32_t spi_addr, const uint8_t *image,
+		    size_t size)
+{
+	*fd = (tt_boot_fs_fd){
+		.spi_addr = spi_addr,
+		.flags.f.image_size = size,
+		.data_crc = tt_boot_fs_cksum(0, image, size),
+	};
+	strncpy((char *)fd->image_tag, tag, sizeof(fd->image_tag));
+	fd->fd_crc = tt_boot_fs_cksum(0, (uint8_t *)fd, sizeof(*fd) - sizeof(fd->fd_crc));
+}
+
+static void write_flash(uint32_t addr, const void *data, size_t size)
+{
+	zassert_ok(flash_erase(flash, addr, ROUND_UP(size, 4096)));
+	zassert_ok(flash_write(flash, addr, data, size));
+}
+
+static void write_boot_fs(uint8_t seed)
+{
+	tt_boot_fs_fd fds[3];
+
+	fill_image(small_image, sizeof(small_image), seed);
+	fill_image(large_image, sizeof(large_image), seed + 1);
+
+	make_fd(&fds[0], "small", SMALL_ADDR, small_image, sizeof(small_image));
+	make_fd(&fds[1], "large", LARGE_ADDR, large_image, sizeof(large_image));
+	fds[2] = (tt_boot_fs_fd){.flags.f.invalid = 1};
+	fds[2].fd_crc = tt_boot_fs_cksum(0, (uint8_t *)&fds[2], sizeof(fds[2]) - sizeof(uint32_t));
+
+	write_flash(TT_BOOT_FS_FD_HEAD_ADDR, fds, sizeof(fds));
+	write_flash(SMALL_ADDR, small_image, sizeof(small_image));
+	write_flash(LARGE_ADDR, large_image, sizeof(large_image));
+
+	fw_image_cache_invalidate();
+}
+
+ZTEST(fw_image_cache, test_fw_image_cache_get_put)
+{
+	tt_boot_fs_fd fd;
+	const uint8_t *data;
+
+	/* Nothing is resident until it is loaded */
+	zassert_ok(fw_image_cache_find("small", &fd));
+	zassert_is_null(fw_image_cache_get(SMALL_ADDR, SMALL_SIZE));
+
+	zassert_ok(fw_image_cache_load("small", &fd));
+	zassert_equal(fd.spi_addr, SMALL_ADDR);
+
+	data = fw_image_cache_get(SMALL_ADDR, SMALL_SIZE);
+	zassert_not_null(data);
+	zassert_mem_equal(data, small_image, SMALL_SIZE);
+	fw_image_cache_put();
+
+	/* Ranges within the image are resident too, ranges past its end are not */
+	data = fw_image_cache_get(SMALL_ADDR + 100, 200);
+	zassert_not_null(data);
+	zassert_mem_equal(data, &small_image[100], 200);
+	fw_image_cache_put();
+	zassert_is_null(fw_image_cache_get(SMALL_ADDR + 100, SMALL_SIZE));
+
+	zassert_ok(fw_image_cache_read(SMALL_ADDR, read_buf, SMALL_SIZE));
+	zassert_mem_equal(read_buf, small_image, SMALL_SIZE);
+}
+
+static K_THREAD_STACK_DEFINE(invalidate_stack, 1024);
+static struct k_thread invalidate_thread;
+static atomic_t invalidated;
+
+static void invalidate_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	fw_image_cache_invalidate();
+	atomic_set(&invalidated, 1);
+}
+
+ZTEST(fw_image_cache, test_fw_image_cache_invalidate_waits_for_users)
+{
+	tt_boot_fs_fd fd;
+
+	zassert_ok(fw_image_cache_load("small", &fd));
+
+	/* Two references are held, invalidation waits until both are put */
+	zassert_not_null(fw_image_cache_get(SMALL_ADDR, SMALL_SIZE));
+	zassert_not_null(fw_image_cache_get(SMALL_ADDR, SMALL_SIZE));
+
+	atomic_clear(&invalidated);
+	k_thread_create(&invalidate_thread, invalidate_stack,
+			K_THREAD_STACK_SIZEOF(invalidate_stack), invalidate_entry, NULL, NULL,
+			NULL, K_PRIO_PREEMPT(0), 0, K_NO_WAIT);
+
+	k_msleep(10);
+	fw_image_cache_put();
+	k_msleep(10);
+	zassert_false(atomic_get(&invalidated));
+
+	fw_image_cache_put();
+	zassert_ok(k_thread_join(&invalidate_thread, K_SECONDS(1)));
+	zassert_true(atomic_get(&invalidated));
+
+	zassert_is_null(fw_image_cache_get(SMALL_ADDR, SMALL_SIZE));
+}
+
+ZTEST(fw_image_cache, test_fw_image_cache_invalidate_rereads_flash)
+{
+	tt_boot_fs_fd fd;
+	const uint8_t *data;
+
+	zassert_ok(fw_image_cache_load("small", &fd));
+
+	/* The flash changes under the cache, as it does for a host flash update */
+	write_boot_fs(0x5a);
+	zassert_ok(fw_image_cache_load("small", &fd));
+	zassert_equal(fd.data_crc, tt_boot_fs_cksum(0, small_image, SMALL_SIZE));
+
+	data = fw_image_cache_get(SMALL_ADDR, SMALL_SIZE);
+	zassert_not_null(data);
+	zassert_mem_equal(data, small_image, SMALL_SIZE);
+	fw_image_cache_put();
+}
+
+ZTEST(fw_image_cache, test_fw_image_cache_full_pool_falls_back_to_flash)
+{
+	tt_boot_fs_fd fd;
+	const uint8_t *data;
+
+	/* Only the start of an image larger than the pool is kept */
+	zassert_ok(fw_image_cache_load("large", &fd));
+	zassert_is_null(fw_image_cache_get(LARGE_ADDR, LARGE_SIZE));
+
+	data = fw_image_cache_get(LARGE_ADDR, POOL_SIZE);
+	zassert_not_null(data);
+	zassert_mem_equal(data, large_image, POOL_SIZE);
+	fw_image_cache_put();
+
+	/* The rest, and images loaded once the pool is full, are read from flash */
+	zassert_ok(fw_image_cache_read(LARGE_ADDR, read_buf, LARGE_SIZE));
+	zassert_mem_equal(read_buf, large_image, LARGE_SIZE);
+
+	zassert_ok(fw_image_cache_load("small", &fd));
+	zassert_is_null(fw_image_cache_get(SMALL_ADDR, SMALL_SIZE));
+	zassert_ok(fw_image_cache_read(SMALL_ADDR, read_buf, SMALL_SIZE));
+	zassert_mem_equal(read_buf, small_image, SMALL_SIZE);
+
+	/* Releasing the pool makes room for the next loader */
+	fw_image_cache_release();
+	zassert_is_null(fw_image_cache_get(LARGE_ADDR, POOL_SIZE));
+	zassert_ok(fw_image_cache_load("small", &fd));
+	zassert_not_null(fw_image_cache_get(SMALL_ADDR, SMALL_SIZE));
+	fw_image_cache_put();
+}
+
+static void fw_image_cache_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	write_boot_fs(0);
+}
+
+static void fw_image_cache_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	fw_image_cache_invalidate();
+}
+
+ZTEST_SUITE(fw_image_cache, NULL, NULL, fw_image_cache_before, fw_image_cache_after, NULL);
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "msg_stats.h"
+#include "reg_mock.h"
+
+#define RESET_UNIT_REFCLK_CNT_LO_REG_ADDR 0x800300E0
+#define STATS_MSG_CODE                    0x42
+#define SERVICE_CYCLES                    100
+/* SERVICE_CYCLES is in [2^6, 2^7) */
+#define SERVICE_BUCKET                    7
+
+static uint32_t refclk_lo;
+
+/* Each timestamp is SERVICE_CYCLES after the previous one */
+static uint32_t ReadReg_msg_stats_fake(uint32_t addr)
+{
+	if (addr == RESET_UNIT_REFCLK_CNT_LO_REG_ADDR) {
+		refclk_lo += SERVICE_CYCLES;
+		return refclk_lo;
+	}
+
+	return 0;
+}
+
+static uint8_t send_stats_request(uint8_t msg_code, uint8_t first_bucket, uint8_t flags,
+				  struct response *rsp)
+{
+	union request req = {0};
+
+	req.msg_stats.command_code = TT_SMC_MSG_GET_MSG_STATS;
+	req.msg_stats.msg_code = msg_code;
+	req.msg_stats.first_bucket = first_bucket;
+	req.msg_stats.flags = flags;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, rsp);
+
+	return rsp->data[0];
+}
+
+ZTEST(msg_stats, test_msg_stats_records_service_time)
+{
+	struct msg_stats stats;
+
+	for (int i = 0; i < 3; i++) {
+		msg_stats_end(STATS_MSG_CODE, msg_stats_begin());
+	}
+
+	zassert_ok(msg_stats_get(STATS_MSG_CODE, &stats));
+	zassert_equal(stats.count, 3);
+	zassert_equal(stats.max, SERVICE_CYCLES);
+	zassert_equal(stats.total, 3 * SERVICE_CYCLES);
+	zassert_equal(stats.hist[SERVICE_BUCKET], 3);
+
+	/* Codes that were never dispatched read back as empty */
+	zassert_ok(msg_stats_get(STATS_MSG_CODE + 1, &stats));
+	zassert_equal(stats.count, 0);
+}
+
+ZTEST(msg_stats, test_msg_stats_handler)
+{
+	struct response rsp = {0};
+
+	msg_stats_end(STATS_MSG_CODE, msg_stats_begin());
+
+	zassert_equal(send_stats_request(STATS_MSG_CODE, SERVICE_BUCKET - 3, 0, &rsp), 0);
+	zassert_equal(rsp.data[1], 1);
+	zassert_equal(rsp.data[2], SERVICE_CYCLES);
+	zassert_equal(rsp.data[3], SERVICE_CYCLES);
+	zassert_equal(rsp.data[7], 1);
+
+	/* Reading with the reset flag returns the statistics, then clears them */
+	zassert_equal(send_stats_request(STATS_MSG_CODE, 0, BIT(1), &rsp), 0);
+	zassert_equal(rsp.data[1], 1);
+	zassert_equal(send_stats_request(STATS_MSG_CODE, 0, 0, &rsp), 0);
+	zassert_equal(rsp.data[1], 0);
+}
+
+ZTEST(msg_stats, test_msg_stats_handler_rejects_bad_bucket)
+{
+	struct response rsp = {0};
+
+	zassert_equal(send_stats_request(STATS_MSG_CODE, MSG_STATS_NUM_BUCKETS, 0, &rsp), 1);
+}
+
+static void msg_stats_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	refclk_lo = 0;
+	ReadReg_fake.custom_fake = ReadReg_msg_stats_fake;
+	msg_stats_reset();
+}
+
+ZTEST_SUITE(msg_stats, NULL, NULL, msg_stats_before, NULL, NULL);
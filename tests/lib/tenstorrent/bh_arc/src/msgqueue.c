@@ -97,6 +97,162 @@ ZTEST(msgqueue, test_msgqueue_register_handler)
 	zassert_equal(rsp.data[1], 0x73737373);
 }
 
+ZTEST(msgqueue, test_msgqueue_drain_full_queue)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	msgqueue_register_handler(0x73, msgqueue_handler_73);
+
+	/* Fill the whole ring so that all requests are drained in a single pass */
+	for (uint32_t i = 0; i < MSG_QUEUE_SIZE; i++) {
+		req.data[0] = 0x73 | (i << 8);
+		msgqueue_request_push(1, &req);
+	}
+	process_message_queues();
+
+	for (uint32_t i = 0; i < MSG_QUEUE_SIZE; i++) {
+		msgqueue_response_pop(1, &rsp);
+		zassert_equal(rsp.data[0], 0);
+		zassert_equal(rsp.data[1], 0x73 | (i << 8));
+	}
+}
+
+static uint32_t dispatch_order;
+
+static uint8_t msgqueue_handler_74(const union request *req, struct response *rsp)
+{
+	rsp->data[1] = dispatch_order++;
+	return 0;
+}
+
+ZTEST(msgqueue, test_msgqueue_queue_priority)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	msgqueue_register_handler(0x74, msgqueue_handler_74);
+	dispatch_order = 0;
+
+	/* Queue 0 now has the lowest priority, so queue 3 is serviced first */
+	zassert_equal(msgqueue_set_queue_priority(0, 1), 0);
+	zassert_equal(msgqueue_set_queue_priority(NUM_MSG_QUEUES, 0), -EINVAL);
+
+	req.data[0] = 0x74;
+	msgqueue_request_push(0, &req);
+	msgqueue_request_push(3, &req);
+	process_message_queues();
+
+	msgqueue_response_pop(3, &rsp);
+	zassert_equal(rsp.data[1], 0);
+	msgqueue_response_pop(0, &rsp);
+	zassert_equal(rsp.data[1], 1);
+
+	msgqueue_set_queue_priority(0, 0);
+}
+
+static struct msgqueue_deferred_response deferred_76;
+
+static uint8_t msgqueue_handler_76(const union request *req, struct response *rsp)
+{
+	zassert_equal(msgqueue_defer_response(&deferred_76), 0);
+	zassert_equal(msgqueue_defer_response(&deferred_76), -EINVAL);
+	return 0;
+}
+
+ZTEST(msgqueue, test_msgqueue_deferred_response)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	msgqueue_register_handler(0x74, msgqueue_handler_74);
+	msgqueue_register_handler(0x76, msgqueue_handler_76);
+	dispatch_order = 0;
+
+	zassert_equal(msgqueue_defer_response(&deferred_76), -EINVAL);
+
+	req.data[0] = 0x76;
+	msgqueue_request_push(2, &req);
+	req.data[0] = 0x74;
+	msgqueue_request_push(2, &req);
+	process_message_queues();
+
+	/* The message after the deferred one has run, but its response waits for the first */
+	zassert_equal(dispatch_order, 1);
+
+	rsp.data[1] = 0x7676;
+	msgqueue_complete_response(&deferred_76, &rsp, 3);
+
+	msgqueue_response_pop(2, &rsp);
+	zassert_equal(rsp.data[0], 3);
+	zassert_equal(rsp.data[1], 0x7676);
+	msgqueue_response_pop(2, &rsp);
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], 0);
+}
+
+ZTEST(msgqueue, test_msgqueue_batch)
+{
+	static union request sub_requests[3];
+	static struct response sub_responses[3];
+	union request req = {0};
+	struct response rsp = {0};
+
+	msgqueue_register_handler(0x73, msgqueue_handler_73);
+
+	sub_requests[0].data[0] = 0x73 | (1 << 8);
+	sub_requests[1].data[0] = TT_SMC_MSG_BATCH;
+	sub_requests[2].data[0] = 0x73 | (3 << 8);
+
+	req.batch.command_code = TT_SMC_MSG_BATCH;
+	req.batch.count = ARRAY_SIZE(sub_requests);
+	req.batch.requests_addr = (uintptr_t)sub_requests;
+	req.batch.responses_addr = (uintptr_t)sub_responses;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], 3);
+	zassert_equal(sub_responses[0].data[0], 0);
+	zassert_equal(sub_responses[0].data[1], 0x73 | (1 << 8));
+	zassert_equal(sub_responses[1].data[0], 0xff); /* nested batches are rejected */
+	zassert_equal(sub_responses[2].data[0], 0);
+	zassert_equal(sub_responses[2].data[1], 0x73 | (3 << 8));
+
+	req.batch.count = MSG_BATCH_MAX_REQUESTS + 1;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	zassert_equal(rsp.data[0], 1);
+}
+
+ZTEST(msgqueue, test_msgqueue_batch_rejects_flash_messages)
+{
+	static union request sub_requests[2];
+	static struct response sub_responses[2];
+	union request req = {0};
+	struct response rsp = {0};
+
+	/* Both would have to run on the SPI flash work queue, which a batch can't wait for */
+	sub_requests[0].data[0] = TT_SMC_MSG_FLASH_LOCK;
+	sub_requests[1].data[0] = TT_SMC_MSG_FLASH_UNLOCK;
+
+	req.batch.command_code = TT_SMC_MSG_BATCH;
+	req.batch.count = ARRAY_SIZE(sub_requests);
+	req.batch.requests_addr = (uintptr_t)sub_requests;
+	req.batch.responses_addr = (uintptr_t)sub_responses;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], 2);
+	zassert_equal(sub_responses[0].data[0], 0xff);
+	zassert_equal(sub_responses[1].data[0], 0xff);
+}
+
 ZTEST(msgqueue, test_msgqueue_power_settings_cmd)
 {
 	const struct device *pll4 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(pll4));
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+
+#define BENCH_MSG_CODE   0x75
+#define BENCH_ITERATIONS 200
+
+/* Stand-in for the DVFS work item: runs on the system work queue every 1 ms, like
+ * dvfs_work_handler, and occupies it for roughly as long as a DVFS update with a voltage change.
+ */
+#define DVFS_LOAD_US 300
+
+static K_SEM_DEFINE(bench_done, 0, 1);
+
+static uint8_t msgqueue_bench_handler(const union request *req, struct response *rsp)
+{
+	rsp->data[1] = req->data[1];
+	k_sem_give(&bench_done);
+	return 0;
+}
+
+static void dvfs_load_work_handler(struct k_work *work)
+{
+	k_busy_wait(DVFS_LOAD_US);
+}
+static K_WORK_DEFINE(dvfs_load_work, dvfs_load_work_handler);
+
+static void dvfs_load_timer_handler(struct k_timer *timer)
+{
+	k_work_submit(&dvfs_load_work);
+}
+static K_TIMER_DEFINE(dvfs_load_timer, dvfs_load_timer_handler, NULL);
+
+ZTEST(msgqueue_bench, test_msgqueue_round_trip_latency)
+{
+	union request req = {0};
+	struct response rsp = {0};
+	uint64_t total_ns = 0;
+	uint64_t min_ns = UINT64_MAX;
+	uint64_t max_ns = 0;
+
+	msgqueue_register_handler(BENCH_MSG_CODE, msgqueue_bench_handler);
+	k_timer_start(&dvfs_load_timer, K_MSEC(1), K_MSEC(1));
+
+	for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+		/* Spread the requests across the DVFS period */
+		k_usleep(37 * (i % 27));
+
+		req.data[0] = BENCH_MSG_CODE;
+		req.data[1] = i;
+
+		uint32_t start = k_cycle_get_32();
+
+		msgqueue_request_push(0, &req);
+		msgqueue_notify();
+		zassert_ok(k_sem_take(&bench_done, K_MSEC(100)));
+		msgqueue_response_pop(0, &rsp);
+
+		uint64_t ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+		zassert_equal(rsp.data[0], 0);
+		zassert_equal(rsp.data[1], i);
+
+		total_ns += ns;
+		min_ns = MIN(min_ns, ns);
+		max_ns = MAX(max_ns, ns);
+	}
+
+	k_timer_stop(&dvfs_load_timer);
+
+	TC_PRINT("msgqueue round trip (%s): min %llu ns, mean %llu ns, max %llu ns\n",
+		 IS_ENABLED(CONFIG_TT_BH_ARC_MSG_QUEUE_THREAD) ? "dedicated thread"
+								 : "system work queue",
+		 min_ns, total_ns / BENCH_ITERATIONS, max_ns);
+}
+
+/* Runs against the message queues as left by the other suites. The message queue thread, when it
+ * is enabled, is already running.
+ */
+ZTEST_SUITE(msgqueue_bench, NULL, NULL, NULL, NULL, NULL);
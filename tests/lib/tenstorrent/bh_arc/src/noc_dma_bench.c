@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/dma.h>
+#include <zephyr/drivers/dma/dma_tt_bh_noc.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/ztest.h>
+
+#include "bench_time.h"
+
+#define BENCH_CHANNEL    0
+#define BENCH_ITERATIONS 64
+
+static const struct device *const dma_noc = DEVICE_DT_GET(DT_NODELABEL(dma1));
+
+static struct dma_block_config blocks[CONFIG_DMA_TT_BH_NOC_MAX_BLOCKS];
+static atomic_t blocks_done;
+static atomic_t transfers_done;
+
+static void noc_dma_bench_callback(const struct device *dev, void *user_data, uint32_t channel,
+				   int status)
+{
+	zassert_true(status == DMA_STATUS_BLOCK || status == DMA_STATUS_COMPLETE);
+
+	if (status == DMA_STATUS_COMPLETE) {
+		atomic_inc(&transfers_done);
+	} else {
+		atomic_inc(&blocks_done);
+	}
+}
+
+/* Chain the maximum number of blocks of block_size bytes and run them to completion */
+static void run_chain(uint32_t block_size, struct tt_bh_dma_noc_coords *coords)
+{
+	struct dma_config config = {
+		.channel_direction = PERIPHERAL_TO_MEMORY,
+		.source_data_size = 1,
+		.dest_data_size = 1,
+		.source_burst_length = 1,
+		.dest_burst_length = 1,
+		.block_count = ARRAY_SIZE(blocks),
+		.head_block = &blocks[0],
+		.user_data = coords,
+		.dma_callback = noc_dma_bench_callback,
+		.complete_callback_en = true,
+	};
+	struct dma_status status;
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(blocks); i++) {
+		blocks[i] = (struct dma_block_config){
+			.source_address = (uint64_t)i * block_size,
+			.dest_address = (uint64_t)i * block_size,
+			.block_size = block_size,
+			.next_block = i + 1 < ARRAY_SIZE(blocks) ? &blocks[i + 1] : NULL,
+		};
+	}
+
+	zassert_ok(dma_config(dma_noc, BENCH_CHANNEL, &config));
+	zassert_ok(dma_start(dma_noc, BENCH_CHANNEL));
+
+	do {
+		zassert_ok(dma_get_status(dma_noc, BENCH_CHANNEL, &status));
+	} while (status.busy);
+
+	zassert_equal(status.total_copied, block_size * ARRAY_SIZE(blocks));
+}
+
+ZTEST(noc_dma_bench, test_noc_dma_block_chain_throughput)
+{
+	static const uint32_t block_sizes[] = {64, 1024, 16384, 65536, 1048576};
+	struct tt_bh_dma_noc_coords coords = tt_bh_dma_noc_coords_init(1, 2, 1, 3);
+
+	for (uint32_t s = 0; s < ARRAY_SIZE(block_sizes); s++) {
+		uint32_t block_size = block_sizes[s];
+
+		atomic_clear(&blocks_done);
+		atomic_clear(&transfers_done);
+
+		uint64_t start = bench_time_ns();
+
+		for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+			run_chain(block_size, &coords);
+		}
+
+		uint64_t ns = MAX(bench_time_ns() - start, 1);
+		uint64_t bytes = (uint64_t)block_size * ARRAY_SIZE(blocks) * BENCH_ITERATIONS;
+
+		/* Every block but the last of each transfer reports DMA_STATUS_BLOCK */
+		zassert_equal(atomic_get(&transfers_done), BENCH_ITERATIONS);
+		zassert_equal(atomic_get(&blocks_done),
+			      (ARRAY_SIZE(blocks) - 1) * BENCH_ITERATIONS);
+
+		TC_PRINT("noc dma %u x %u byte blocks: %llu ns per transfer, %llu bytes/s\n",
+			 (uint32_t)ARRAY_SIZE(blocks), block_size, ns / BENCH_ITERATIONS,
+			 bytes * 1000000000ULL / ns);
+	}
+}
+
+ZTEST_SUITE(noc_dma_bench, NULL, NULL, NULL, NULL, NULL);
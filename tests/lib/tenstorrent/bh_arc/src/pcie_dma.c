@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "reg_mock.h"
+
+#define NUM_CHANNELS CONFIG_TT_BH_ARC_PCIE_DMA_CHANNELS
+
+/* HDMA registers, as seen through the PCIe DBI NOC2AXI TLB window */
+#define DBI_TLB_BASE             0xCE000000
+#define HDMA_WRCH_0_BASE         0x00380000
+#define HDMA_CHANNEL_STRIDE      0x200
+#define HDMA_READ_CHANNEL_OFFSET 0x100
+#define HDMA_DOORBELL_OFF        0x04
+#define HDMA_STATUS_OFF          0x80
+
+#define DMA_RUNNING 1
+#define DMA_STOPPED 3
+
+/* Long enough for the pending queue to be polled several times */
+#define DRAIN_TIME_MS 10
+
+static uint32_t hdma_status[2][NUM_CHANNELS];
+static uint32_t hdma_doorbells[2][NUM_CHANNELS];
+/* Whether channels keep running after their doorbell, until the test stops them */
+static bool hdma_hold_running;
+
+static bool decode_hdma_reg(uint32_t addr, uint32_t off, int *read, int *ch)
+{
+	for (*read = 0; *read < 2; (*read)++) {
+		for (*ch = 0; *ch < NUM_CHANNELS; (*ch)++) {
+			if (addr == DBI_TLB_BASE + HDMA_WRCH_0_BASE + *ch * HDMA_CHANNEL_STRIDE +
+					    *read * HDMA_READ_CHANNEL_OFFSET + off) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static uint32_t ReadReg_pcie_dma_fake(uint32_t addr)
+{
+	int read, ch;
+
+	if (decode_hdma_reg(addr, HDMA_STATUS_OFF, &read, &ch)) {
+		return hdma_status[read][ch];
+	}
+
+	return 0;
+}
+
+static void WriteReg_pcie_dma_fake(uint32_t addr, uint32_t value)
+{
+	int read, ch;
+
+	if (decode_hdma_reg(addr, HDMA_DOORBELL_OFF, &read, &ch)) {
+		hdma_doorbells[read][ch]++;
+		hdma_status[read][ch] = hdma_hold_running ? DMA_RUNNING : DMA_STOPPED;
+	}
+}
+
+static uint8_t send_dma_request(uint8_t command_code)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.data[0] = command_code;
+	req.data[1] = 64;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	return rsp.data[0];
+}
+
+static void stop_all_channels(int read)
+{
+	for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+		hdma_status[read][ch] = DMA_STOPPED;
+	}
+}
+
+ZTEST(pcie_dma, test_pcie_dma_queues_until_channel_free)
+{
+	/* One transfer starts on each channel */
+	for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+		zassert_equal(send_dma_request(TT_SMC_MSG_PCIE_DMA_CHIP_TO_HOST_TRANSFER), 0);
+		zassert_equal(hdma_doorbells[0][ch], 1);
+	}
+
+	/* The next one waits for a channel */
+	zassert_equal(send_dma_request(TT_SMC_MSG_PCIE_DMA_CHIP_TO_HOST_TRANSFER), 0);
+	k_msleep(DRAIN_TIME_MS);
+	zassert_equal(hdma_doorbells[0][NUM_CHANNELS - 1], 1);
+
+	/* and is started by the poll once that channel stops */
+	hdma_status[0][NUM_CHANNELS - 1] = DMA_STOPPED;
+	k_msleep(DRAIN_TIME_MS);
+	zassert_equal(hdma_doorbells[0][NUM_CHANNELS - 1], 2);
+	zassert_equal(hdma_doorbells[1][0], 0);
+}
+
+ZTEST(pcie_dma, test_pcie_dma_rejects_when_queue_full)
+{
+	for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+		zassert_equal(send_dma_request(TT_SMC_MSG_PCIE_DMA_HOST_TO_CHIP_TRANSFER), 0);
+	}
+
+	for (int i = 0; i < CONFIG_TT_BH_ARC_PCIE_DMA_QUEUE_DEPTH; i++) {
+		zassert_equal(send_dma_request(TT_SMC_MSG_PCIE_DMA_HOST_TO_CHIP_TRANSFER), 0);
+	}
+	zassert_equal(send_dma_request(TT_SMC_MSG_PCIE_DMA_HOST_TO_CHIP_TRANSFER), 1);
+
+	/* Every queued transfer is started once the channels complete */
+	hdma_hold_running = false;
+	stop_all_channels(1);
+	k_msleep(DRAIN_TIME_MS);
+
+	uint32_t started = 0;
+
+	for (int ch = 0; ch < NUM_CHANNELS; ch++) {
+		started += hdma_doorbells[1][ch];
+	}
+	zassert_equal(started, NUM_CHANNELS + CONFIG_TT_BH_ARC_PCIE_DMA_QUEUE_DEPTH);
+	zassert_equal(send_dma_request(TT_SMC_MSG_PCIE_DMA_HOST_TO_CHIP_TRANSFER), 0);
+}
+
+static void pcie_dma_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memset(hdma_doorbells, 0, sizeof(hdma_doorbells));
+	stop_all_channels(0);
+	stop_all_channels(1);
+	hdma_hold_running = true;
+	ReadReg_fake.custom_fake = ReadReg_pcie_dma_fake;
+	WriteReg_fake.custom_fake = WriteReg_pcie_dma_fake;
+}
+
+static void pcie_dma_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	/* Let anything still queued start before the register fakes are reset */
+	hdma_hold_running = false;
+	stop_all_channels(0);
+	stop_all_channels(1);
+	k_msleep(DRAIN_TIME_MS);
+}
+
+ZTEST_SUITE(pcie_dma, NULL, NULL, pcie_dma_before, pcie_dma_after, NULL);
@@ -109,6 +109,7 @@ ZTEST(smbus_target, test_read_byte_test)
 	zassert_equal(0, i2c_write_read(i2c0_dev, tt_i2c_addr, write_data, sizeof(write_data),
 					read_data, sizeof(read_data)));
 	zexpect_equal(0x5AU, read_data[0]);
+	zexpect_equal(214U, read_data[1]); /* PEC */
 }
 
 ZTEST(smbus_target, test_read_word_test)
@@ -123,6 +124,7 @@ ZTEST(smbus_target, test_read_word_test)
 					read_data, sizeof(read_data)));
 	zexpect_equal(0x5AU, read_data[0]);
 	zexpect_equal(0x91U, read_data[1]);
+	zexpect_equal(254U, read_data[2]); /* PEC */
 }
 
 ZTEST(smbus_target, test_read_block_test)
@@ -139,6 +141,7 @@ ZTEST(smbus_target, test_read_block_test)
 	zexpect_equal(0x91U, read_data[2]);
 	zexpect_equal(0x65U, read_data[3]);
 	zexpect_equal(0x87U, read_data[4]);
+	zexpect_equal(238U, read_data[5]); /* PEC */
 }
 
 ZTEST(smbus_target, test_write_byte_test)
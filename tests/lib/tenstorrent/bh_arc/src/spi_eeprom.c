@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/drivers/flash/flash_simulator.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "reg_mock.h"
+#include "status_reg.h"
+
+#define SECTOR_SIZE 4096
+#define MAX_RANGES  CONFIG_TT_BH_ARC_FLASH_UPDATE_MAX_RANGES
+
+/* Clear of the boot fs directory, and of the images of the fw_image_cache suite */
+#define TEST_ADDR    0x80000
+#define TEST_SECTORS 6
+
+/* The data follows the manifest in the SPI programming buffer */
+#define DATA_OFFSET 256
+
+/* Long enough for the SPI flash work queue to run the update */
+#define DRAIN_TIME_MS 10
+
+extern uint8_t spi_global_buffer[CONFIG_TT_BH_ARC_SPI_BUFFER_SIZE];
+
+static const struct device *const flash = DEVICE_DT_GET(DT_NODELABEL(flashcontroller0));
+
+static uint32_t units_erased;
+static uint32_t progress[16];
+static uint32_t num_progress;
+
+/* Replaces the erase of the flash simulator, so it has to erase the unit too */
+static int32_t count_erase_unit(const struct device *dev, uint32_t unit_offset)
+{
+	struct flash_pages_info info;
+	size_t size;
+	uint8_t *mem = flash_simulator_get_memory(dev, &size);
+
+	flash_get_page_info_by_offs(dev, unit_offset, &info);
+	memset(&mem[unit_offset], 0xFF, info.size);
+	units_erased++;
+
+	return 0;
+}
+
+static const struct flash_simulator_cb erase_counter = {
+	.erase_unit = count_erase_unit,
+};
+
+static void record_progress(uint32_t addr, uint32_t val)
+{
+	if (addr == FLASH_UPDATE_PROGRESS_REG_ADDR && num_progress < ARRAY_SIZE(progress)) {
+		progress[num_progress++] = val;
+	}
+}
+
+static uint32_t sector_addr(int sector)
+{
+	return TEST_ADDR + sector * SECTOR_SIZE;
+}
+
+static void fill_sector(int sector, uint8_t value)
+{
+	static uint8_t buf[SECTOR_SIZE];
+
+	memset(buf, value, sizeof(buf));
+	zassert_ok(flash_erase(flash, sector_addr(sector), SECTOR_SIZE));
+	if (value != 0xFF) {
+		zassert_ok(flash_write(flash, sector_addr(sector), buf, sizeof(buf)));
+	}
+}
+
+static void check_flash(uint32_t addr, const uint8_t *expect, size_t size)
+{
+	static uint8_t buf[SECTOR_SIZE];
+
+	for (size_t offset = 0; offset < size; offset += sizeof(buf)) {
+		size_t len = MIN(sizeof(buf), size - offset);
+
+		zassert_ok(flash_read(flash, addr + offset, buf, len));
+		zassert_mem_equal(buf, &expect[offset], len, "at 0x%x", addr + offset);
+	}
+}
+
+static void check_sector_filled(int sector, uint8_t value)
+{
+	static uint8_t expect[SECTOR_SIZE];
+
+	memset(expect, value, sizeof(expect));
+	check_flash(sector_addr(sector), expect, sizeof(expect));
+}
+
+static struct response send_request(const union request *req)
+{
+	struct response rsp = {0};
+
+	msgqueue_request_push(0, req);
+	process_message_queues();
+	k_msleep(DRAIN_TIME_MS);
+	msgqueue_response_pop(0, &rsp);
+
+	return rsp;
+}
+
+static void send_command(uint8_t command_code)
+{
+	union request req = {0};
+
+	req.command_code = command_code;
+	zassert_equal(send_request(&req).data[0], 0);
+}
+
+static struct flash_update_range *manifest(void)
+{
+	return (struct flash_update_range *)spi_global_buffer;
+}
+
+/* Add a range whose data is at offset in the SPI programming buffer */
+static uint8_t *add_range(int i, uint32_t spi_addr, uint32_t num_bytes, uint32_t offset)
+{
+	manifest()[i] = (struct flash_update_range){
+		.spi_addr = spi_addr,
+		.num_bytes = num_bytes,
+		.data_addr = (uintptr_t)&spi_global_buffer[offset],
+	};
+
+	return &spi_global_buffer[offset];
+}
+
+static struct response send_flash_update(uint16_t num_ranges, uintptr_t manifest_addr)
+{
+	union request req = {0};
+
+	req.flash_update.command_code = TT_SMC_MSG_FLASH_UPDATE;
+	req.flash_update.num_ranges = num_ranges;
+	req.flash_update.manifest_addr = manifest_addr;
+
+	/* Only count the erases of the update, not those of the test setup */
+	units_erased = 0;
+	num_progress = 0;
+
+	return send_request(&req);
+}
+
+ZTEST(spi_eeprom, test_flash_update_classifies_sectors)
+{
+	uint8_t *data;
+	struct response rsp;
+
+	fill_sector(0, 0x5A);
+	fill_sector(2, 0xFF);
+	fill_sector(4, 0xF0);
+
+	/* Already holds the data */
+	data = add_range(0, sector_addr(0), SECTOR_SIZE, DATA_OFFSET);
+	memset(data, 0x5A, SECTOR_SIZE);
+	/* Erased, so it is programmed without an erase */
+	data = add_range(1, sector_addr(2), SECTOR_SIZE, DATA_OFFSET + SECTOR_SIZE);
+	memset(data, 0x12, SECTOR_SIZE);
+	/* Only clears bits, but of bytes that are already programmed, so it is erased */
+	data = add_range(2, sector_addr(4), SECTOR_SIZE, DATA_OFFSET + 2 * SECTOR_SIZE);
+	memset(data, 0x30, SECTOR_SIZE);
+
+	rsp = send_flash_update(3, (uintptr_t)manifest());
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], 3 * SECTOR_SIZE);
+	zassert_equal(rsp.data[2], 1, "skipped");
+	zassert_equal(rsp.data[3], 1, "programmed");
+	zassert_equal(rsp.data[4], 1, "erased");
+	zassert_equal(rsp.data[5], 1, "erase commands");
+	zassert_equal(units_erased, 1);
+
+	check_sector_filled(0, 0x5A);
+	check_sector_filled(2, 0x12);
+	check_sector_filled(4, 0x30);
+}
+
+ZTEST(spi_eeprom, test_flash_update_programs_only_erased_bytes)
+{
+	uint8_t *data;
+	struct response rsp;
+
+	/* The first half of the sector is programmed, the second half is erased */
+	fill_sector(0, 0xFF);
+	memset(spi_global_buffer, 0x5A, SECTOR_SIZE / 2);
+	zassert_ok(flash_write(flash, sector_addr(0), spi_global_buffer, SECTOR_SIZE / 2));
+
+	/* Keeps the programmed half, and writes the erased half */
+	data = add_range(0, sector_addr(0), SECTOR_SIZE, DATA_OFFSET);
+	memset(data, 0x5A, SECTOR_SIZE / 2);
+	memset(data + SECTOR_SIZE / 2, 0x12, SECTOR_SIZE / 2);
+
+	rsp = send_flash_update(1, (uintptr_t)manifest());
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[3], 1, "programmed");
+	zassert_equal(rsp.data[4], 0, "erased");
+	zassert_equal(units_erased, 0);
+	check_flash(sector_addr(0), data, SECTOR_SIZE);
+}
+
+ZTEST(spi_eeprom, test_flash_update_merges_erase_runs)
+{
+	static uint8_t expect[3 * SECTOR_SIZE];
+	uint8_t *data;
+	struct response rsp;
+
+	for (int i = 0; i < TEST_SECTORS; i++) {
+		fill_sector(i, 0xA5);
+	}
+
+	/* Two ranges of whole sectors, consecutive in flash and in the buffer, share an erase */
+	data = add_range(0, sector_addr(0), 2 * SECTOR_SIZE, DATA_OFFSET);
+	add_range(1, sector_addr(2), SECTOR_SIZE, DATA_OFFSET + 2 * SECTOR_SIZE);
+	for (size_t i = 0; i < sizeof(expect); i++) {
+		expect[i] = i * 13;
+	}
+	memcpy(data, expect, sizeof(expect));
+
+	/* A partial sector further on is merged with the rest of its sector */
+	data = add_range(2, sector_addr(4) + 100, 100, DATA_OFFSET + 3 * SECTOR_SIZE);
+	memset(data, 0x11, 100);
+
+	WriteReg_fake.custom_fake = record_progress;
+	rsp = send_flash_update(3, (uintptr_t)manifest());
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], 3 * SECTOR_SIZE + 100);
+	zassert_equal(rsp.data[4], 4, "erased");
+	zassert_equal(rsp.data[5], 2, "erase commands");
+	zassert_equal(units_erased, 4);
+
+	check_flash(sector_addr(0), expect, sizeof(expect));
+	check_sector_filled(3, 0xA5);
+	check_sector_filled(5, 0xA5);
+
+	static uint8_t sector[SECTOR_SIZE];
+
+	memset(sector, 0xA5, sizeof(sector));
+	memset(&sector[100], 0x11, 100);
+	check_flash(sector_addr(4), sector, sizeof(sector));
+
+	/* Sectors waiting for their shared erase are not counted until it is done */
+	static const uint32_t expect_progress[] = {
+		0, 0, 0, 0, 100, 3 * SECTOR_SIZE + 100,
+	};
+
+	zassert_equal(num_progress, ARRAY_SIZE(expect_progress));
+	zassert_mem_equal(progress, expect_progress, sizeof(expect_progress));
+}
+
+ZTEST(spi_eeprom, test_flash_update_rejects_bad_manifests)
+{
+	uintptr_t buffer_end = (uintptr_t)spi_global_buffer + sizeof(spi_global_buffer);
+
+	for (int i = 0; i <= MAX_RANGES; i++) {
+		add_range(i, sector_addr(0), 4, DATA_OFFSET);
+	}
+
+	/* Too many ranges */
+	zassert_equal(send_flash_update(MAX_RANGES + 1, (uintptr_t)manifest()).data[0], 2);
+	/* Unaligned manifest */
+	zassert_equal(send_flash_update(1, (uintptr_t)manifest() + 1).data[0], 2);
+	/* Manifest past the end of the buffer */
+	zassert_equal(send_flash_update(2, buffer_end - sizeof(struct flash_update_range)).data[0],
+		      2);
+
+	/* Data past the end of the buffer */
+	add_range(1, sector_addr(0), 8, sizeof(spi_global_buffer) - 4);
+	zassert_equal(send_flash_update(2, (uintptr_t)manifest()).data[0], 2);
+	/* Data outside of the buffer */
+	manifest()[1].data_addr = (uintptr_t)progress;
+	zassert_equal(send_flash_update(2, (uintptr_t)manifest()).data[0], 2);
+
+	/* Nothing was written */
+	zassert_equal(units_erased, 0);
+
+	/* A valid manifest is still refused while the flash is locked */
+	send_command(TT_SMC_MSG_FLASH_LOCK);
+	zassert_equal(send_flash_update(1, (uintptr_t)manifest()).data[0], 2);
+	zassert_equal(units_erased, 0);
+}
+
+static void spi_eeprom_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	send_command(TT_SMC_MSG_FLASH_UNLOCK);
+
+	memset(spi_global_buffer, 0, sizeof(spi_global_buffer));
+	flash_simulator_set_callbacks(flash, &erase_counter);
+}
+
+static void spi_eeprom_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	flash_simulator_set_callbacks(flash, NULL);
+	send_command(TT_SMC_MSG_FLASH_LOCK);
+}
+
+ZTEST_SUITE(spi_eeprom, NULL, NULL, spi_eeprom_before, spi_eeprom_after, NULL);
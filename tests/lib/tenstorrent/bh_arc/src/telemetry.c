@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "telemetry.h"
+
+#define DEFAULT_PERIOD_MS 100
+
+static uint8_t send_period_request(uint8_t group, uint32_t period_ms, uint32_t *interval)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.telem_period.command_code = TT_SMC_MSG_SET_TELEM_PERIOD;
+	req.telem_period.group = group;
+	req.telem_period.period_ms = period_ms;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	*interval = rsp.data[1];
+
+	return rsp.data[0];
+}
+
+ZTEST(telemetry, test_telemetry_group_period)
+{
+	uint32_t interval;
+
+	/* The update timer runs at the shortest group period */
+	zassert_equal(send_period_request(TELEM_GROUP_CLOCKS, 20, &interval), 0);
+	zassert_equal(interval, 20);
+	zassert_equal(GetTelemetryTag(TAG_UPDATE_TELEM_SPEED), 20);
+
+	zassert_equal(send_period_request(TELEM_GROUP_FAN, 50, &interval), 0);
+	zassert_equal(interval, 20);
+
+	zassert_equal(send_period_request(TELEM_GROUP_ALL, 200, &interval), 0);
+	zassert_equal(interval, 200);
+	zassert_equal(GetTelemetryTag(TAG_UPDATE_TELEM_SPEED), 200);
+}
+
+ZTEST(telemetry, test_telemetry_group_period_rejects_bad_request)
+{
+	uint32_t interval;
+
+	zassert_equal(send_period_request(TELEM_GROUP_POWER, TELEM_MIN_PERIOD_MS - 1, &interval),
+		      1);
+	zassert_equal(send_period_request(TELEM_GROUP_POWER, TELEM_MAX_PERIOD_MS + 1, &interval),
+		      1);
+	zassert_equal(send_period_request(TELEM_GROUP_COUNT, DEFAULT_PERIOD_MS, &interval), 1);
+	zassert_equal(GetTelemetryTag(TAG_UPDATE_TELEM_SPEED), DEFAULT_PERIOD_MS);
+}
+
+static void telemetry_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	SetTelemetryGroupPeriod(TELEM_GROUP_ALL, DEFAULT_PERIOD_MS);
+}
+
+ZTEST_SUITE(telemetry, NULL, NULL, telemetry_before, NULL, NULL);
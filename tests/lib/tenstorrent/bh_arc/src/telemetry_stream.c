@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "reg_mock.h"
+#include "status_reg.h"
+#include "telemetry.h"
+
+/* Long enough that no record is sampled while a test runs */
+#define STREAM_PERIOD_MS 60000
+
+/* Leading words of struct telem_stream_header */
+struct stream_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t period_ms;
+	uint32_t num_tags;
+	uint32_t record_words;
+	uint32_t capacity;
+	uint32_t head;
+	uint32_t tail;
+	uint32_t dropped;
+	uint8_t tags[TELEM_STREAM_MAX_TAGS];
+};
+
+static uint8_t send_stream_request(const uint8_t *tags, uint8_t num_tags, uint16_t period_ms,
+				   struct stream_header **header)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.telem_stream.command_code = TT_SMC_MSG_TELEM_STREAM;
+	req.telem_stream.num_tags = num_tags;
+	req.telem_stream.period_ms = period_ms;
+	memcpy(req.telem_stream.tags, tags, MIN(num_tags, TELEM_STREAM_MAX_TAGS));
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	*header = (struct stream_header *)(uintptr_t)rsp.data[1];
+
+	return rsp.data[0];
+}
+
+static bool stream_reg_written(uint32_t value)
+{
+	for (unsigned int i = 0; i < MIN(WriteReg_fake.call_count, FFF_ARG_HISTORY_LEN); i++) {
+		if (WriteReg_fake.arg0_history[i] == TELEMETRY_STREAM_REG_ADDR &&
+		    WriteReg_fake.arg1_history[i] == value) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+ZTEST(telemetry_stream, test_telemetry_stream_start_stop)
+{
+	const uint8_t tags[] = {TAG_AICLK, TAG_VCORE, TAG_TIMER_HEARTBEAT};
+	struct stream_header *header;
+
+	zassert_equal(send_stream_request(tags, ARRAY_SIZE(tags), STREAM_PERIOD_MS, &header), 0);
+	zassert_not_null(header);
+	zassert_true(stream_reg_written((uint32_t)(uintptr_t)header));
+
+	zassert_equal(header->magic, 0x52545354);
+	zassert_equal(header->period_ms, STREAM_PERIOD_MS);
+	zassert_equal(header->num_tags, ARRAY_SIZE(tags));
+	zassert_equal(header->record_words, 2 + ARRAY_SIZE(tags));
+	zassert_equal(header->capacity,
+		      CONFIG_TT_BH_ARC_TELEM_STREAM_BUF_WORDS / header->record_words);
+	zassert_mem_equal(header->tags, tags, sizeof(tags));
+
+	/* Restarting the stream restarts the ring */
+	header->head = 5;
+	header->tail = 3;
+	zassert_equal(send_stream_request(tags, 1, STREAM_PERIOD_MS, &header), 0);
+	zassert_equal(header->num_tags, 1);
+	zassert_equal(header->head, 0);
+	zassert_equal(header->tail, 0);
+
+	zassert_equal(send_stream_request(tags, 0, 0, &header), 0);
+	zassert_equal(header->period_ms, 0);
+}
+
+ZTEST(telemetry_stream, test_telemetry_stream_rejects_bad_request)
+{
+	const uint8_t tags[] = {TAG_AICLK, TAG_COUNT};
+	const uint8_t many_tags[TELEM_STREAM_MAX_TAGS + 1] = {0};
+	struct stream_header *header;
+
+	/* Unknown tag */
+	zassert_equal(send_stream_request(tags, ARRAY_SIZE(tags), STREAM_PERIOD_MS, &header), 1);
+	/* No period */
+	zassert_equal(send_stream_request(tags, 1, 0, &header), 1);
+	/* Too many tags */
+	zassert_equal(send_stream_request(many_tags, ARRAY_SIZE(many_tags), STREAM_PERIOD_MS,
+					  &header),
+		      1);
+}
+
+ZTEST_SUITE(telemetry_stream, NULL, NULL, NULL, NULL, NULL);
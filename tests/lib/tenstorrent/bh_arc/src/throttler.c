@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/drivers/misc/bh_fwtable.h>
+#include <zephyr/ztest.h>
+
+#include "aiclk_ppm.h"
+#include "telemetry_internal.h"
+#include "throttler.h"
+
+/* kThrottlerAiclkScaleFactor, DEFAULT_BOARD_POWER_LIMIT and the AICLK limits on native_sim */
+#define AICLK_SCALE_FACTOR 500.0F
+#define BOARD_POWER_LIMIT  150.0F
+#define AICLK_FMIN         200.0F
+#define AICLK_FMAX         1400.0F
+
+/* Gains of the board power throttler before it became a PID controller. Each update added
+ * (p_gain * error + d_gain * (error - prev_error)) * AICLK_SCALE_FACTOR to its arbiter.
+ */
+#define OLD_P_GAIN 0.1F
+#define OLD_D_GAIN 0.1F
+
+extern void UpdateThrottlers(const TelemetryInternalData *data, float input_power,
+			     float gddr_temp);
+extern void LoadThrottlerParams(ThrottlerId id, const FwTable_ThrottlerParams *fw_params);
+
+static const TelemetryInternalData telemetry;
+
+static float board_power_error(float input_power)
+{
+	return (BOARD_POWER_LIMIT - input_power) / BOARD_POWER_LIMIT;
+}
+
+static float old_update(float arb_val, float error, float prev_error)
+{
+	return arb_val + (OLD_P_GAIN * error + OLD_D_GAIN * (error - prev_error)) *
+				 AICLK_SCALE_FACTOR;
+}
+
+static void throttler_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	for (AiclkArbMax i = 0; i < kAiclkArbMaxCount; i++) {
+		SetAiclkArbMax(i, AICLK_FMAX);
+	}
+	InitThrottlers();
+}
+
+static void check_matches_old_update(void)
+{
+	/* Swings around the limit without taking the arbiter to fmin or fmax */
+	static const float input_power[] = {200, 220, 240, 180, 160, 140,
+					    120, 150, 170, 130, 100, 190};
+	float arb_val = AICLK_FMAX;
+	float prev_error = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(input_power); i++) {
+		float error = board_power_error(input_power[i]);
+
+		arb_val = old_update(arb_val, error, prev_error);
+		prev_error = error;
+
+		UpdateThrottlers(&telemetry, input_power[i], 0);
+		zassert_within(GetThrottlerArbMax(kAiclkArbMaxBoardPower), arb_val, 0.01F,
+			       "update %zu", i);
+	}
+}
+
+ZTEST(throttler, test_throttler_matches_old_update)
+{
+	check_matches_old_update();
+}
+
+ZTEST(throttler, test_throttler_fw_table_params)
+{
+	/* An entry that only sets the period keeps the default gains */
+	const FwTable_ThrottlerParams period_only = {
+		.has_period_ms = true,
+		.period_ms = 1,
+	};
+
+	LoadThrottlerParams(kThrottlerBoardPower, &period_only);
+	check_matches_old_update();
+
+	/* Entries that would stop the throttler from protecting the board are ignored */
+	const FwTable_ThrottlerParams invalid[] = {
+		{.has_ki = true, .ki = 0},
+		{.has_ki = true, .ki = -100},
+		{.has_kp = true, .kp = -0.1F},
+		{.has_kd = true, .kd = -0.1F},
+		{.has_alpha_filter = true, .alpha_filter = 0},
+		{.has_alpha_filter = true, .alpha_filter = 2},
+		{.has_period_ms = true, .period_ms = 0},
+		{.has_kp = true, .kp = 1, .has_ki = true, .ki = -1},
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(invalid); i++) {
+		LoadThrottlerParams(kThrottlerBoardPower, &invalid[i]);
+	}
+	throttler_before(NULL);
+	check_matches_old_update();
+}
+
+ZTEST(throttler, test_throttler_integral_clamps_at_fmax)
+{
+	/* Far below the limit for long enough to wind the integral up well past fmax */
+	for (int i = 0; i < 100; i++) {
+		UpdateThrottlers(&telemetry, 50, 0);
+	}
+	zassert_equal(GetThrottlerArbMax(kAiclkArbMaxBoardPower), AICLK_FMAX);
+
+	/* The arbiter comes down on the first update over the limit, as if it stopped at fmax */
+	UpdateThrottlers(&telemetry, 300, 0);
+	zassert_within(GetThrottlerArbMax(kAiclkArbMaxBoardPower),
+		       old_update(AICLK_FMAX, board_power_error(300), board_power_error(50)),
+		       0.01F);
+}
+
+ZTEST(throttler, test_throttler_integral_clamps_at_fmin)
+{
+	for (int i = 0; i < 100; i++) {
+		UpdateThrottlers(&telemetry, 600, 0);
+	}
+	zassert_equal(GetThrottlerArbMax(kAiclkArbMaxBoardPower), AICLK_FMIN);
+
+	UpdateThrottlers(&telemetry, 0, 0);
+	zassert_within(GetThrottlerArbMax(kAiclkArbMaxBoardPower),
+		       old_update(AICLK_FMIN, board_power_error(0), board_power_error(600)),
+		       0.01F);
+}
+
+ZTEST_SUITE(throttler, NULL, NULL, throttler_before, NULL, NULL);
@@ -9,6 +9,85 @@
 #include <tenstorrent/msgqueue.h>
 #include <stdlib.h>
 
+#include "reg_mock.h"
+#include "status_reg.h"
+#include "vf_curve.h"
+
+/* Leading words of the V/F table published in VF_CURVE_TABLE_REG_ADDR */
+struct vf_table_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t fmin_mhz;
+	uint32_t step_mhz;
+	uint32_t num_entries;
+	uint32_t frac_bits;
+	int32_t freq_margin_mhz;
+	int32_t voltage_margin_mv;
+	uint16_t voltage[];
+};
+
+static struct vf_table_header *init_vf_table(void)
+{
+	RESET_FAKE(WriteReg);
+	InitVFCurve();
+
+	zassert_equal(WriteReg_fake.call_count, 1);
+	zassert_equal(WriteReg_fake.arg0_val, VF_CURVE_TABLE_REG_ADDR);
+
+	return (struct vf_table_header *)(uintptr_t)WriteReg_fake.arg1_val;
+}
+
+static float vf_curve_ref(const struct vf_table_header *table, float freq_mhz)
+{
+	float freq = freq_mhz + table->freq_margin_mhz;
+
+	return 0.00031395F * freq * freq - 0.43953F * freq + 828.83F + table->voltage_margin_mv;
+}
+
+ZTEST(vf_curve, test_vf_table_matches_curve)
+{
+	struct vf_table_header *table = init_vf_table();
+
+	zassert_equal(table->magic, 0x54434656);
+	zassert_equal(table->fmin_mhz, 200);
+	zassert_equal(table->step_mhz, CONFIG_TT_BH_ARC_VF_TABLE_STEP_MHZ);
+	zassert_true(table->fmin_mhz + (table->num_entries - 1) * table->step_mhz >= 1400);
+
+	for (uint32_t i = 0; i < table->num_entries; i++) {
+		float voltage = (float)table->voltage[i] / BIT(table->frac_bits);
+		float expected = vf_curve_ref(table, table->fmin_mhz + i * table->step_mhz);
+
+		zassert_within(voltage, expected, 0.05F, "entry %u: %f mV, expected %f mV", i,
+			       (double)voltage, (double)expected);
+	}
+
+	/* Interpolated voltages truncate to the same mV as the curve, give or take rounding */
+	for (uint32_t freq = 200; freq <= 1400; freq++) {
+		int32_t expected = (int32_t)vf_curve_ref(table, freq);
+
+		zassert_within((int32_t)VFCurve(freq), expected, 1, "%u MHz", freq);
+	}
+}
+
+ZTEST(vf_curve, test_vf_curve_max_freq)
+{
+	/* The curve rises monotonically from fmin with the margins in the test firmware table */
+	const uint32_t fmin = 800;
+	const uint32_t fmax = 1400;
+
+	init_vf_table();
+
+	for (uint32_t voltage = 500; voltage < 1300; voltage++) {
+		uint32_t expected = fmax;
+
+		while (expected >= fmin && VFCurve(expected) > voltage) {
+			expected--;
+		}
+
+		zassert_equal(VFCurveMaxFreq(voltage, fmin, fmax), expected, "%u mV", voltage);
+	}
+}
+
 ZTEST(vf_curve, test_get_freq_curve_from_voltage_handler)
 {
 	union request req = {0};
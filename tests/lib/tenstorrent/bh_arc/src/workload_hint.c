@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "aiclk_ppm.h"
+#include "telemetry_internal.h"
+#include "throttler.h"
+
+#define AICLK_FMAX 1400.0F
+
+/* The fw table is empty on native_sim, so the TDP and TDC limits are the lowest allowed */
+#define CHIP_LIMIT 50.0F
+
+/* A workload that the TDP throttler is predicted to limit to 1250 MHz, while its current stays
+ * far from the TDC limits
+ */
+#define WORKLOAD_AICLK   1000
+#define WORKLOAD_POWER   40.0F
+#define WORKLOAD_CURRENT 20.0F
+#define WORKLOAD_LIMIT   (CHIP_LIMIT * WORKLOAD_AICLK / WORKLOAD_POWER)
+
+/* Long enough for the model to converge on a workload that draws more than it predicts */
+#define LEARN_UPDATES 200
+
+extern void UpdateThrottlers(const TelemetryInternalData *data, float input_power,
+			     float gddr_temp);
+
+static uint32_t send_workload_hint(uint8_t intensity, uint32_t *limit)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.aiclk_workload_hint.command_code = TT_SMC_MSG_AICLK_WORKLOAD_HINT;
+	req.aiclk_workload_hint.intensity = intensity;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	*limit = rsp.data[1];
+
+	return rsp.data[0];
+}
+
+static void send_command(uint8_t command_code)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.command_code = command_code;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	zassert_equal(rsp.data[0], 0);
+}
+
+static void reset_arbiters(void)
+{
+	for (AiclkArbMax i = 0; i < kAiclkArbMaxCount; i++) {
+		SetAiclkArbMax(i, AICLK_FMAX);
+	}
+}
+
+static void set_aiclk(uint32_t freq)
+{
+	SetAiclkArbMin(kAiclkArbMinBusy, freq);
+	CalculateTargAiclk();
+	DecreaseAiclk();
+	IncreaseAiclk();
+}
+
+static void run_workload(float power, float current, int updates)
+{
+	const TelemetryInternalData data = {
+		.vcore_power = power,
+		.vcore_current = current,
+	};
+
+	for (int i = 0; i < updates; i++) {
+		UpdateThrottlers(&data, 0, 0);
+	}
+}
+
+ZTEST(workload_hint, test_workload_hint_without_model)
+{
+	uint32_t limit;
+
+	/* Nothing has been learned yet, so the throttlers are left at fmax */
+	zassert_equal(send_workload_hint(60, &limit), 0);
+	zassert_equal(limit, (uint32_t)GetThrottlerArbMax(kAiclkArbMaxFmax));
+
+	zassert_equal(send_workload_hint(0, &limit), 0);
+}
+
+ZTEST(workload_hint, test_workload_hint_learns_announced_workload)
+{
+	uint32_t limit;
+
+	/* Nothing is learned while no workload is announced */
+	run_workload(WORKLOAD_POWER, WORKLOAD_CURRENT, LEARN_UPDATES);
+	zassert_equal(send_workload_hint(100, &limit), 0);
+	zassert_equal(limit, AICLK_FMAX);
+
+	/* The model learns the power per MHz of the announced workload */
+	run_workload(WORKLOAD_POWER, WORKLOAD_CURRENT, LEARN_UPDATES);
+	zassert_equal(send_workload_hint(0, &limit), 0);
+	zassert_equal(send_workload_hint(100, &limit), 0);
+	zassert_within(limit, WORKLOAD_LIMIT, 1);
+
+	/* and only follows a lighter workload slowly, so that it keeps predicting the peak */
+	run_workload(WORKLOAD_POWER / 2, WORKLOAD_CURRENT / 2, LEARN_UPDATES);
+	reset_arbiters();
+	zassert_equal(send_workload_hint(100, &limit), 0);
+	zassert_between_inclusive(limit, WORKLOAD_LIMIT, AICLK_FMAX - 1);
+}
+
+ZTEST(workload_hint, test_workload_hint_pre_throttles)
+{
+	uint32_t limit;
+
+	zassert_equal(send_workload_hint(100, &limit), 0);
+	run_workload(WORKLOAD_POWER, WORKLOAD_CURRENT, LEARN_UPDATES);
+
+	/* Half the intensity is predicted to stay below the limit up to fmax */
+	zassert_equal(send_workload_hint(50, &limit), 0);
+	zassert_equal(limit, AICLK_FMAX);
+	zassert_equal(GetThrottlerArbMax(kAiclkArbMaxTDP), AICLK_FMAX);
+
+	/* The full intensity lowers the TDP arbiter in the next update, before AICLK goes busy. A
+	 * workload drawing exactly the limit leaves it there.
+	 */
+	zassert_equal(send_workload_hint(100, &limit), 0);
+	zassert_within(limit, WORKLOAD_LIMIT, 1);
+	zassert_equal(GetThrottlerArbMax(kAiclkArbMaxTDP), AICLK_FMAX);
+	run_workload(CHIP_LIMIT, WORKLOAD_CURRENT, 1);
+	zassert_within(GetThrottlerArbMax(kAiclkArbMaxTDP), WORKLOAD_LIMIT, 1);
+	zassert_equal(GetThrottlerArbMax(kAiclkArbMaxFastTDC), AICLK_FMAX);
+	zassert_equal(GetThrottlerArbMax(kAiclkArbMaxTDC), AICLK_FMAX);
+
+	/* The throttler continues in closed loop from there, and raises AICLK again when the
+	 * workload draws less than predicted
+	 */
+	run_workload(WORKLOAD_POWER / 2, WORKLOAD_CURRENT, 1);
+	zassert_true(GetThrottlerArbMax(kAiclkArbMaxTDP) > WORKLOAD_LIMIT + 1);
+}
+
+ZTEST(workload_hint, test_workload_hint_ended_by_busy_and_idle)
+{
+	static const uint8_t commands[] = {TT_SMC_MSG_AICLK_GO_BUSY, TT_SMC_MSG_AICLK_GO_LONG_IDLE};
+	uint32_t limit;
+
+	zassert_equal(send_workload_hint(100, &limit), 0);
+	run_workload(WORKLOAD_POWER, WORKLOAD_CURRENT, LEARN_UPDATES);
+
+	for (size_t i = 0; i < ARRAY_SIZE(commands); i++) {
+		zassert_equal(send_workload_hint(100, &limit), 0);
+		send_command(commands[i]);
+
+		/* The model would quickly learn a heavier workload that it took for the announced
+		 * one, and predict a lower limit
+		 */
+		run_workload(2 * WORKLOAD_POWER, 2 * WORKLOAD_CURRENT, LEARN_UPDATES);
+		reset_arbiters();
+		zassert_equal(send_workload_hint(100, &limit), 0);
+		zassert_within(limit, WORKLOAD_LIMIT, 1, "command 0x%x", commands[i]);
+	}
+}
+
+ZTEST(workload_hint, test_workload_hint_rejects_bad_intensity)
+{
+	uint32_t limit;
+
+	zassert_equal(send_workload_hint(101, &limit), 1);
+}
+
+static void workload_hint_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	reset_arbiters();
+	InitThrottlers();
+	set_aiclk(WORKLOAD_AICLK);
+}
+
+static void workload_hint_after(void *fixture)
+{
+	uint32_t limit;
+
+	ARG_UNUSED(fixture);
+
+	send_workload_hint(0, &limit);
+}
+
+ZTEST_SUITE(workload_hint, NULL, NULL, workload_hint_before, workload_hint_after, NULL);
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TESTS_TENSTORRENT_BENCH_TIME_H
+#define TESTS_TENSTORRENT_BENCH_TIME_H
+
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+
+#ifdef CONFIG_BOARD_NATIVE_SIM
+/* In native/host_clock.c */
+uint64_t bench_host_time_ns(void);
+
+/* Simulated time does not advance while a benchmark runs, so time it on the host */
+static inline uint64_t bench_time_ns(void)
+{
+	return bench_host_time_ns();
+}
+#else
+static inline uint64_t bench_time_ns(void)
+{
+	return k_cyc_to_ns_floor64(k_cycle_get_64());
+}
+#endif
+
+#endif
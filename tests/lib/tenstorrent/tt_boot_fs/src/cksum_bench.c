@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2025 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <tenstorrent/tt_boot_fs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/ztest.h>
+
+#include "bench_time.h"
+
+#define BENCH_IMAGE_SIZE 0x40000
+#define BENCH_ITERATIONS 32
+
+/* Room to start the image at every offset within a word */
+static uint8_t image[BENCH_IMAGE_SIZE + sizeof(uint32_t)] __aligned(sizeof(uint32_t));
+
+/* The word at a time loop that tt_boot_fs_cksum() used to be */
+static uint32_t reference_cksum(uint32_t cksum, const uint8_t *data, size_t num_bytes)
+{
+	const uint32_t *words = (const uint32_t *)data;
+
+	for (size_t i = 0; i < num_bytes / sizeof(uint32_t); i++) {
+		cksum += words[i];
+	}
+
+	return cksum;
+}
+
+static void *cksum_bench_setup(void)
+{
+	uint32_t x = 1;
+
+	/* Any pattern will do, as long as words do not repeat */
+	ARRAY_FOR_EACH(image, i) {
+		x = x * 1664525 + 1013904223;
+		image[i] = x >> 24;
+	}
+
+	return NULL;
+}
+
+ZTEST(tt_boot_fs_cksum_bench, test_cksum_unaligned)
+{
+	uint32_t aligned[8];
+
+	for (size_t offset = 1; offset < sizeof(uint32_t); offset++) {
+		memcpy(aligned, &image[offset], sizeof(aligned));
+		zassert_equal(tt_boot_fs_cksum(0, &image[offset], sizeof(aligned)),
+			      reference_cksum(0, (uint8_t *)aligned, sizeof(aligned)),
+			      "offset %zu", offset);
+	}
+}
+
+ZTEST(tt_boot_fs_cksum_bench, test_cksum_incremental)
+{
+	static const size_t chunk_sizes[] = {1, 3, 4, 7, 64, 4093};
+	uint32_t expect = reference_cksum(0, image, BENCH_IMAGE_SIZE);
+
+	ARRAY_FOR_EACH(chunk_sizes, i) {
+		struct tt_boot_fs_cksum_ctx ctx;
+
+		tt_boot_fs_cksum_init(&ctx);
+		for (size_t offset = 0; offset < BENCH_IMAGE_SIZE; offset += chunk_sizes[i]) {
+			tt_boot_fs_cksum_update(&ctx, &image[offset],
+						MIN(chunk_sizes[i], BENCH_IMAGE_SIZE - offset));
+		}
+
+		zassert_equal(tt_boot_fs_cksum_final(&ctx), expect, "chunk size %zu",
+			      chunk_sizes[i]);
+	}
+
+	/* A trailing partial word counts as zero padded, but less than a word counts as nothing */
+	struct tt_boot_fs_cksum_ctx ctx;
+	uint32_t padded = 0;
+
+	memcpy(&padded, &image[4], 3);
+	tt_boot_fs_cksum_init(&ctx);
+	tt_boot_fs_cksum_update(&ctx, image, 3);
+	zassert_equal(tt_boot_fs_cksum_final(&ctx), 0);
+	tt_boot_fs_cksum_update(&ctx, &image[3], 4);
+	zassert_equal(tt_boot_fs_cksum_final(&ctx), sys_get_le32(image) + padded);
+}
+
+ZTEST(tt_boot_fs_cksum_bench, test_cksum_throughput)
+{
+	uint32_t expect = 0;
+	uint32_t actual = 0;
+	uint64_t start;
+	uint64_t reference_ns;
+	uint64_t unrolled_ns;
+
+	start = bench_time_ns();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		expect += reference_cksum(i, image, BENCH_IMAGE_SIZE);
+	}
+	reference_ns = MAX(bench_time_ns() - start, 1);
+
+	start = bench_time_ns();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		actual += tt_boot_fs_cksum(i, image, BENCH_IMAGE_SIZE);
+	}
+	unrolled_ns = MAX(bench_time_ns() - start, 1);
+
+	zassert_equal(actual, expect);
+
+	uint64_t total_bytes = (uint64_t)BENCH_IMAGE_SIZE * BENCH_ITERATIONS;
+
+	TC_PRINT("cksum of %u KiB: word loop %llu MB/s, unrolled %llu MB/s\n",
+		 BENCH_IMAGE_SIZE / 1024, total_bytes * 1000 / reference_ns,
+		 total_bytes * 1000 / unrolled_ns);
+}
+
+ZTEST_SUITE(tt_boot_fs_cksum_bench, NULL, cksum_bench_setup, NULL, NULL, NULL);
@@ -99,31 +99,18 @@ static void *setup_bootfs(void)
 	return NULL;
 }
 
-/* all input must be aligned to a 4-byte boundary and be a multiple of 4 bytes */
 __aligned(sizeof(uint32_t)) static const uint8_t one_byte[] = {0x42};
-/*
- * __aligned(sizeof(uint32_t)) static const uint8_t two_bytes[] = {
- *   0x42,
- *   0x42,
- * };
- * __aligned(sizeof(uint32_t)) static const uint8_t three_bytes[] = {
- *   0x73,
- *   0x42,
- *   0x42,
- * };
- */
 static const uint32_t four_bytes = 0x42427373;
-/*
- * __aligned(sizeof(uint32_t)) static const uint8_t five_bytes[] = {
- *   0x73, 0x73, 0x42, 0x42, 0x37,
- * };
- * __aligned(sizeof(uint32_t)) static const uint8_t six_bytes[] = {
- *   0x73, 0x73, 0x42, 0x42, 0x37, 0x37,
- * };
- * __aligned(sizeof(uint32_t)) static const uint8_t seven_bytes[] = {
- *   0x73, 0x73, 0x42, 0x42, 0x37, 0x37, 0x24,
- * };
- */
+/* Trailing partial words count as zero padded */
+__aligned(sizeof(uint32_t)) static const uint8_t five_bytes[] = {
+	0x73, 0x73, 0x42, 0x42, 0x37,
+};
+__aligned(sizeof(uint32_t)) static const uint8_t six_bytes[] = {
+	0x73, 0x73, 0x42, 0x42, 0x37, 0x37,
+};
+__aligned(sizeof(uint32_t)) static const uint8_t seven_bytes[] = {
+	0x73, 0x73, 0x42, 0x42, 0x37, 0x37, 0x24,
+};
 static const uint64_t eight_bytes = 0x2424373742427373;
 
 ZTEST(tt_boot_fs, test_tt_boot_fs_cksum)
@@ -137,17 +124,12 @@ ZTEST(tt_boot_fs, test_tt_boot_fs_cksum)
 	} harness[] = {
 		{0, NULL, 0},
 		{0, one_byte, 0},
-		/*
-		 * {0x00000042, one_byte, 1},
-		 * {0x00004242, two_bytes, 2},
-		 * {0x00000073, three_bytes, 3},
-		 */
+		/* Less than a word is not counted, as in scripts/tt_boot_fs.py */
+		{0, one_byte, 1},
 		{0x42427373, (uint8_t *)&four_bytes, 4},
-		/*
-		 *{0x4284e6e6, five_bytes, 5},
-		 *{0x4242e6e6, six_bytes, 6},
-		 *{0x424273e6, seven_bytes, 7},
-		 */
+		{0x424273aa, five_bytes, 5},
+		{0x4242aaaa, six_bytes, 6},
+		{0x4266aaaa, seven_bytes, 7},
 		{0x6666aaaa, (uint8_t *)&eight_bytes, 8},
 	};
 
@@ -255,4 +237,108 @@ ZTEST(tt_boot_fs, test_find_fd_by_tag)
 	}
 }
 
+ZTEST(tt_boot_fs, test_find_fd_by_tag_matches_ls)
+{
+	tt_boot_fs_fd fds[MAX_FDS];
+	tt_boot_fs_fd result_fd;
+	int nfds = tt_boot_fs_ls(FLASH_DEVICE, fds, ARRAY_SIZE(fds), 0);
+
+	zassert_equal(nfds, 3);
+
+	/* Second pass looks up the directory again after it has been dropped */
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < nfds; i++) {
+			zassert_ok(tt_boot_fs_find_fd_by_tag(FLASH_DEVICE, fds[i].image_tag,
+							     &result_fd));
+			zassert_mem_equal(&result_fd, &fds[i], sizeof(result_fd),
+					  "Pass %d: FD %d does not match", pass, i);
+		}
+		tt_boot_fs_invalidate(FLASH_DEVICE);
+	}
+}
+
+static int hal_read(uint32_t addr, uint32_t size, uint8_t *dst)
+{
+	return flash_read(FLASH_DEVICE, addr, dst, size);
+}
+
+/* Flash can only be written once after an erase, so rewrite each page that is touched */
+static int hal_write(uint32_t addr, uint32_t size, const uint8_t *src)
+{
+	static uint8_t page[TEST_ALIGNMENT];
+
+	while (size > 0) {
+		uint32_t page_addr = ROUND_DOWN(addr, TEST_ALIGNMENT);
+		uint32_t len = MIN(size, page_addr + TEST_ALIGNMENT - addr);
+		int rc = flash_read(FLASH_DEVICE, page_addr, page, sizeof(page));
+
+		if (rc == 0) {
+			memcpy(&page[addr - page_addr], src, len);
+			rc = flash_erase(FLASH_DEVICE, page_addr, sizeof(page));
+		}
+		if (rc == 0) {
+			rc = flash_write(FLASH_DEVICE, page_addr, page, sizeof(page));
+		}
+		if (rc < 0) {
+			return rc;
+		}
+
+		addr += len;
+		src += len;
+		size -= len;
+	}
+
+	return 0;
+}
+
+static int hal_erase(uint32_t addr, uint32_t size)
+{
+	return flash_erase(FLASH_DEVICE, addr, size);
+}
+
+ZTEST(tt_boot_fs, test_get_file)
+{
+	static tt_boot_fs tt_boot_fs;
+	const uint8_t tag[8] = "imageB";
+	const uint8_t expect[] = {0x73, 0x73, 0x42, 0x42, 0x37, 0x37, 0x24, 0x24};
+	uint8_t buf[16];
+	size_t file_size;
+
+	zassert_ok(tt_boot_fs_mount(&tt_boot_fs, hal_read, hal_write, hal_erase));
+
+	zassert_equal(tt_boot_fs_get_file(&tt_boot_fs, tag, buf, sizeof(buf), &file_size),
+		      TT_BOOT_FS_OK);
+	zassert_equal(file_size, sizeof(expect));
+	zassert_mem_equal(buf, expect, sizeof(expect));
+
+	/* Too small a buffer */
+	zassert_equal(tt_boot_fs_get_file(&tt_boot_fs, tag, buf, 4, &file_size), TT_BOOT_FS_ERR);
+}
+
+ZTEST(tt_boot_fs, test_find_fd_by_tag_after_add_file)
+{
+	static tt_boot_fs tt_boot_fs;
+	tt_boot_fs_fd fd;
+	tt_boot_fs_fd result_fd;
+	const uint8_t tag[8] = "imageD";
+	uint8_t image_D[] = {0x24, 0x24, 0x37, 0x37};
+
+	zassert_ok(tt_boot_fs_mount(&tt_boot_fs, hal_read, hal_write, hal_erase));
+
+	/* Build the directory of the flash device before the file is added */
+	zassert_equal(tt_boot_fs_find_fd_by_tag(FLASH_DEVICE, tag, &result_fd), -ENOENT);
+
+	setup_fd(&fd, IMAGE_ADDR + 3 * TEST_ALIGNMENT, 0, sizeof(image_D), "imageD", image_D,
+		 sizeof(image_D));
+	fd.fd_crc = tt_boot_fs_cksum(0, (uint8_t *)&fd, sizeof(tt_boot_fs_fd) - sizeof(fd.fd_crc));
+	zassert_ok(tt_boot_fs_add_file(&tt_boot_fs, fd, image_D, false, false));
+
+	zassert_ok(tt_boot_fs_find_fd_by_tag(FLASH_DEVICE, tag, &result_fd));
+	zassert_mem_equal(&result_fd, &fd, sizeof(fd));
+
+	/* Restore the filesystem the other tests expect */
+	setup_bootfs();
+	tt_boot_fs_invalidate(FLASH_DEVICE);
+}
+
 ZTEST_SUITE(tt_boot_fs, NULL, setup_bootfs, NULL, NULL, NULL);